@@ -0,0 +1,207 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Datagram.hh>
+#include <EagleNetwork/Socket.hh>
+#include <benchmark/benchmark.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <poll.h>
+#include <span>
+#include <vector>
+
+using namespace Eagle::Core;
+
+namespace
+{
+    constexpr std::size_t DatagramSize = 64;
+    constexpr std::size_t BurstSize = 32;
+
+    using InputBuffer = Detail::IO::InputSocketOperationDep<char[DatagramSize]>;
+    using OutputBuffer = Detail::IO::OutputSocketOperationDep<char[DatagramSize]>;
+
+    // A datagram not received within this time is considered lost.
+    constexpr int ReceiveTimeoutMilliseconds = 1000;
+
+    /**
+     * A bound non-blocking receiver and a sender connected to it.
+     */
+    struct LoopbackPair
+    {
+        BasicSocket receiver;
+        BasicSocket sender;
+        bool ready = false;
+
+        LoopbackPair()
+        {
+            Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_DGRAM, .protocol = 0};
+            if(!receiver.OpenSocket(deps) || !sender.OpenSocket(deps) || !receiver.SetNonBlocking(true)) return;
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+            ready = ::bind(receiver.GetSocketResource(), reinterpret_cast<sockaddr*>(&address), length) == 0
+                && ::getsockname(receiver.GetSocketResource(), reinterpret_cast<sockaddr*>(&address), &length) == 0
+                && ::connect(sender.GetSocketResource(), reinterpret_cast<sockaddr*>(&address), length) == 0;
+        }
+
+        /**
+         * @return false if nothing arrived within ReceiveTimeoutMilliseconds.
+         */
+        bool WaitReadable()
+        {
+            pollfd descriptor{receiver.GetSocketResource(), POLLIN, 0};
+            return ::poll(&descriptor, 1, ReceiveTimeoutMilliseconds) > 0;
+        }
+
+        bool Read(std::span<std::byte> buffer)
+        {
+            while(true)
+            {
+                auto read = receiver.Read(buffer);
+                if(read) return true;
+                if(read.GetError() != EAGAIN || !WaitReadable()) return false;
+            }
+        }
+
+        /**
+         * @brief Receive count datagrams into the operation's buffers, false if one is lost.
+         */
+        template <typename BufferType>
+        bool ReceiveAll(DatagramBatch& batch,
+            Detail::IO::IOSocketMultiOperationDep<Detail::IO::InputSocketOperationDep, BufferType>& receive,
+            std::span<Detail::IO::InputSocketOperationDep<BufferType>> inputs, std::size_t count)
+        {
+            std::size_t received = 0;
+            while(received < count)
+            {
+                receive.operationBuffers = inputs.subspan(received);
+                auto result = batch.Receive(receive);
+                if(result)
+                {
+                    received += result.GetResult();
+                } else if(result.GetError() != EAGAIN || !WaitReadable()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    void BM_DatagramSingleMessage(benchmark::State& state)
+    {
+        LoopbackPair pair;
+        if(!pair.ready)
+        {
+            state.SkipWithError("socket setup failed");
+            return;
+        }
+        std::byte buffer[DatagramSize]{};
+
+        for(auto _ : state)
+        {
+            for(std::size_t i = 0; i < BurstSize; ++i)
+            {
+                pair.sender.Write(buffer);
+            }
+            for(std::size_t i = 0; i < BurstSize; ++i)
+            {
+                if(!pair.Read(buffer))
+                {
+                    state.SkipWithError("datagram lost");
+                    break;
+                }
+            }
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * BurstSize));
+    }
+    BENCHMARK(BM_DatagramSingleMessage);
+
+    void BM_DatagramBatch(benchmark::State& state)
+    {
+        LoopbackPair pair;
+        if(!pair.ready)
+        {
+            state.SkipWithError("socket setup failed");
+            return;
+        }
+        DatagramBatch batch(BurstSize);
+        std::vector<InputBuffer> inputs(BurstSize);
+        std::vector<OutputBuffer> outputs(BurstSize);
+        for(auto& output : outputs) output.outputNumberBytes = DatagramSize;
+
+        Detail::IO::IOSocketMultiOperationDep<Detail::IO::OutputSocketOperationDep, char[DatagramSize]> send{
+            pair.sender.GetSocketResource(), outputs, DatagramSize};
+        Detail::IO::IOSocketMultiOperationDep<Detail::IO::InputSocketOperationDep, char[DatagramSize]> receive{
+            pair.receiver.GetSocketResource(), inputs, DatagramSize};
+
+        for(auto _ : state)
+        {
+            batch.Send(send);
+            if(!pair.ReceiveAll(batch, receive, std::span(inputs), BurstSize))
+            {
+                state.SkipWithError("datagram lost");
+            }
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * BurstSize));
+    }
+    BENCHMARK(BM_DatagramBatch);
+
+    void BM_DatagramSegmented(benchmark::State& state)
+    {
+        LoopbackPair pair;
+        DatagramBatch batch(BurstSize);
+        std::vector<std::byte> payload(DatagramSize * BurstSize);
+        std::vector<InputBuffer> inputs(BurstSize);
+        Detail::IO::IOSocketMultiOperationDep<Detail::IO::InputSocketOperationDep, char[DatagramSize]> receive{
+            pair.receiver.GetSocketResource(), inputs, DatagramSize};
+
+        if(!pair.ready)
+        {
+            state.SkipWithError("socket setup failed");
+            return;
+        }
+        if(!DatagramBatch::SendSegmented(pair.sender, payload, DatagramSize).HasResult())
+        {
+            state.SkipWithError("UDP segmentation offload unavailable");
+            return;
+        }
+        if(!pair.ReceiveAll(batch, receive, std::span(inputs), BurstSize))
+        {
+            state.SkipWithError("datagram lost");
+            return;
+        }
+
+        for(auto _ : state)
+        {
+            DatagramBatch::SendSegmented(pair.sender, payload, DatagramSize);
+            if(!pair.ReceiveAll(batch, receive, std::span(inputs), BurstSize))
+            {
+                state.SkipWithError("datagram lost");
+            }
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * BurstSize));
+    }
+    BENCHMARK(BM_DatagramSegmented);
+}
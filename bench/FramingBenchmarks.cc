@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Framing.hh>
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+using namespace Eagle::Core;
+
+namespace
+{
+    constexpr std::size_t StreamSize = 256 * 1024;
+
+    /**
+     * StreamSize bytes of "\r\n" terminated lines of range(0) bytes each.
+     */
+    std::string MakeLines(std::size_t lineLength)
+    {
+        std::string stream;
+        while(stream.size() + lineLength + 2 <= StreamSize)
+        {
+            stream.append(lineLength, 'x');
+            stream += "\r\n";
+        }
+        return stream;
+    }
+
+    std::span<const std::byte> AsBytes(std::string_view text)
+    {
+        return std::as_bytes(std::span(text.data(), text.size()));
+    }
+
+    /**
+     * The byte-at-a-time loop the protocols used to carry, for comparison.
+     */
+    void BM_SplitLinesBytewise(benchmark::State& state)
+    {
+        auto stream = MakeLines(static_cast<std::size_t>(state.range(0)));
+        for(auto _ : state)
+        {
+            std::size_t lines = 0;
+            for(std::size_t i = 0; i + 1 < stream.size(); ++i)
+            {
+                if(stream[i] == '\r' && stream[i + 1] == '\n')
+                {
+                    ++lines;
+                    ++i;
+                }
+            }
+            benchmark::DoNotOptimize(lines);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * stream.size()));
+    }
+
+    void BM_SplitLinesFindDelimiter(benchmark::State& state)
+    {
+        auto stream = MakeLines(static_cast<std::size_t>(state.range(0)));
+        auto delimiter = AsBytes("\r\n");
+        for(auto _ : state)
+        {
+            std::size_t lines = 0;
+            for(auto bytes = AsBytes(stream); !bytes.empty(); ++lines)
+            {
+                auto offset = Detail::FindDelimiter(bytes, delimiter);
+                if(offset == bytes.size()) break;
+                bytes = bytes.subspan(offset + delimiter.size());
+            }
+            benchmark::DoNotOptimize(lines);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * stream.size()));
+    }
+
+    /**
+     * The whole read path: copy 16KiB chunks into a FrameReader and take every frame.
+     */
+    void BM_FrameReaderLines(benchmark::State& state)
+    {
+        auto stream = MakeLines(static_cast<std::size_t>(state.range(0)));
+        FrameReader reader(DelimiterFramer("\r\n"));
+        for(auto _ : state)
+        {
+            for(std::size_t offset = 0; offset < stream.size(); offset += 16 * 1024)
+            {
+                auto chunk = std::string_view(stream).substr(offset, 16 * 1024);
+                auto space = reader.PrepareWrite(chunk.size());
+                std::memcpy(space.data(), chunk.data(), chunk.size());
+                reader.Commit(chunk.size());
+                while(true)
+                {
+                    auto frame = reader.Next();
+                    if(frame.HasError()) break;
+                    benchmark::DoNotOptimize(frame.GetResult().data());
+                }
+            }
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * stream.size()));
+    }
+
+    void BM_FrameReaderVarint(benchmark::State& state)
+    {
+        auto payloadLength = static_cast<std::size_t>(state.range(0));
+        LengthPrefixFramer framer(LengthPrefix::Varint);
+        std::string stream;
+        while(stream.size() + payloadLength + LengthPrefixFramer::MaxPrefixLength <= StreamSize)
+        {
+            std::array<std::byte, LengthPrefixFramer::MaxPrefixLength> prefix;
+            auto prefixLength = framer.EncodePrefix(payloadLength, prefix);
+            stream.append(reinterpret_cast<const char*>(prefix.data()), prefixLength);
+            stream.append(payloadLength, 'x');
+        }
+
+        FrameReader reader(framer);
+        for(auto _ : state)
+        {
+            auto space = reader.PrepareWrite(stream.size());
+            std::memcpy(space.data(), stream.data(), stream.size());
+            reader.Commit(stream.size());
+            while(true)
+            {
+                auto frame = reader.Next();
+                if(frame.HasError()) break;
+                benchmark::DoNotOptimize(frame.GetResult().data());
+            }
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * stream.size()));
+    }
+}
+
+BENCHMARK(BM_SplitLinesBytewise)->ArgName("line")->Arg(16)->Arg(80)->Arg(1024);
+BENCHMARK(BM_SplitLinesFindDelimiter)->ArgName("line")->Arg(16)->Arg(80)->Arg(1024);
+BENCHMARK(BM_FrameReaderLines)->ArgName("line")->Arg(16)->Arg(80)->Arg(1024);
+BENCHMARK(BM_FrameReaderVarint)->ArgName("payload")->Arg(16)->Arg(1024);
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/HttpParser.hh>
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+using namespace Eagle::Core;
+
+namespace
+{
+    constexpr std::string_view BrowserRequest =
+        "GET /wp-content/uploads/2010/03/hello-kitty-darth-vader-pink.jpg HTTP/1.1\r\n"
+        "Host: www.kittyhell.com\r\n"
+        "User-Agent: Mozilla/5.0 (Macintosh; U; Intel Mac OS X 10.6; ja-JP-mac; rv:1.9.2.3) Gecko/20100401 "
+        "Firefox/3.6.3 Pathtraq/0.9\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+        "Accept-Language: ja,en-us;q=0.7,en;q=0.3\r\n"
+        "Accept-Encoding: gzip,deflate\r\n"
+        "Accept-Charset: Shift_JIS,utf-8;q=0.7,*;q=0.7\r\n"
+        "Keep-Alive: 115\r\n"
+        "Connection: keep-alive\r\n"
+        "Cookie: wp_ozh_wsa_visits=2; wp_ozh_wsa_visit_lasttime=xxxxxxxxxx; "
+        "__utma=xxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.x; "
+        "__utmz=xxxxxxxxx.xxxxxxxxxx.x.x.utmccn=(referral)|utmcsr=reader.livedoor.com|utmcct=/reader/|utmcmd=referral\r\n"
+        "\r\n";
+
+    void BM_HttpParseRequest(benchmark::State& state)
+    {
+        std::array<HttpHeader, 32> headers;
+        for(auto _ : state)
+        {
+            auto request = HttpParser::ParseRequest(BrowserRequest, headers);
+            benchmark::DoNotOptimize(request.HasResult());
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * BrowserRequest.size()));
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /**
+     * range(0) pipelined copies of the request parsed back to back from one buffer.
+     */
+    void BM_HttpParsePipelined(benchmark::State& state)
+    {
+        std::string buffer;
+        for(std::int64_t i = 0; i < state.range(0); ++i) buffer += BrowserRequest;
+
+        std::array<HttpHeader, 32> headers;
+        for(auto _ : state)
+        {
+            std::string_view remaining(buffer);
+            while(!remaining.empty())
+            {
+                auto request = HttpParser::ParseRequest(remaining, headers);
+                if(request.HasError()) break;
+                remaining.remove_prefix(request.GetResult().headLength);
+            }
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * buffer.size()));
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_HttpChunkedDecode(benchmark::State& state)
+    {
+        auto chunkSize = static_cast<std::size_t>(state.range(0));
+        char sizeLine[32];
+        auto sizeLength = std::snprintf(sizeLine, sizeof(sizeLine), "%zx\r\n", chunkSize);
+        std::string encoded;
+        while(encoded.size() < 256 * 1024)
+        {
+            encoded.append(sizeLine, static_cast<std::size_t>(sizeLength));
+            encoded.append(chunkSize, 'x');
+            encoded += "\r\n";
+        }
+        encoded += "0\r\n\r\n";
+
+        std::string buffer;
+        for(auto _ : state)
+        {
+            buffer = encoded;
+            HttpChunkedDecoder decoder;
+            auto progress = decoder.Decode(buffer);
+            benchmark::DoNotOptimize(progress.HasResult());
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * encoded.size()));
+    }
+}
+
+BENCHMARK(BM_HttpParseRequest);
+BENCHMARK(BM_HttpParsePipelined)->ArgName("requests")->Arg(16);
+BENCHMARK(BM_HttpChunkedDecode)->ArgName("chunk")->Arg(64)->Arg(4096);
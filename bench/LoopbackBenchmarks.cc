@@ -0,0 +1,388 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/SharedMemoryChannel.hh>
+#include <EagleNetwork/Socket.hh>
+#include <benchmark/benchmark.h>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <span>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <vector>
+
+using namespace Eagle::Core;
+
+namespace
+{
+    bool WriteAll(BasicSocket& socket, std::span<const std::byte> buffer)
+    {
+        while(!buffer.empty())
+        {
+            auto written = socket.Write(buffer);
+            if(!written.HasResult()) return false;
+            buffer = buffer.subspan(written.GetResult());
+        }
+        return true;
+    }
+
+    bool ReadAll(BasicSocket& socket, std::span<std::byte> buffer)
+    {
+        while(!buffer.empty())
+        {
+            auto read = socket.Read(buffer);
+            if(!read.HasResult() || read.GetResult() == 0) return false;
+            buffer = buffer.subspan(read.GetResult());
+        }
+        return true;
+    }
+
+    void StreamEchoLoop(BasicSocket socket)
+    {
+        std::vector<std::byte> buffer(64 * 1024);
+        while(true)
+        {
+            auto read = socket.Read(buffer);
+            if(!read.HasResult() || read.GetResult() == 0) return;
+            if(!WriteAll(socket, std::span(buffer).first(read.GetResult()))) return;
+        }
+    }
+
+    /**
+     * Client ends of stream connections, each echoed by a server thread.
+     */
+    struct StreamEchoConnections
+    {
+        std::vector<BasicSocket> clients;
+        std::vector<std::thread> servers;
+
+        ~StreamEchoConnections()
+        {
+            for(auto& client : clients) client.CloseSocket();
+            for(auto& server : servers) server.join();
+        }
+
+        void Add(BasicSocket client, BasicSocket server)
+        {
+            clients.push_back(std::move(client));
+            servers.emplace_back(StreamEchoLoop, std::move(server));
+        }
+    };
+
+    /**
+     * @return false when a step of the setup failed.
+     */
+    bool OpenTcpConnections(StreamEchoConnections& connections, std::size_t count)
+    {
+        Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0};
+        BasicSocket listener;
+        if(!listener.OpenSocket(deps)) return false;
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if(!listener.Bind(reinterpret_cast<sockaddr*>(&address), sizeof(address))) return false;
+        if(!listener.Listen()) return false;
+        sockaddr_storage local{};
+        socklen_t length = sizeof(local);
+        if(!listener.GetLocalAddress(local, length)) return false;
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            BasicSocket client;
+            if(!client.OpenSocket(deps)) return false;
+            if(!client.Connect(reinterpret_cast<sockaddr*>(&local), length)) return false;
+            auto server = listener.Accept(false);
+            if(!server) return false;
+            client.SetOption(IPPROTO_TCP, TCP_NODELAY, 1);
+            server.GetResult().SetOption(IPPROTO_TCP, TCP_NODELAY, 1);
+            connections.Add(std::move(client), std::move(server).GetResult());
+        }
+        return true;
+    }
+
+    bool OpenUnixConnections(StreamEchoConnections& connections, std::size_t count)
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            int pair[2];
+            if(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) == -1) return false;
+            connections.Add(BasicSocket(pair[0]), BasicSocket(pair[1]));
+        }
+        return true;
+    }
+
+    /**
+     * range(0) bytes per message, range(1) connections. Every iteration sends
+     * one message on each connection then reads all the echoes back.
+     */
+    template <bool (*Open)(StreamEchoConnections&, std::size_t)>
+    void BM_StreamEcho(benchmark::State& state)
+    {
+        auto messageSize = static_cast<std::size_t>(state.range(0));
+        auto connectionCount = static_cast<std::size_t>(state.range(1));
+
+        StreamEchoConnections connections;
+        if(!Open(connections, connectionCount))
+        {
+            state.SkipWithError("connection setup failed");
+            return;
+        }
+        std::vector<std::byte> message(messageSize, std::byte{0x5a});
+        std::vector<std::byte> echo(messageSize);
+
+        for(auto _ : state)
+        {
+            for(auto& client : connections.clients)
+            {
+                if(!WriteAll(client, message)) state.SkipWithError("write failed");
+            }
+            for(auto& client : connections.clients)
+            {
+                if(!ReadAll(client, echo)) state.SkipWithError("read failed");
+            }
+        }
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * messageSize * connectionCount * 2));
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * connectionCount));
+    }
+
+    void BM_UdpEcho(benchmark::State& state)
+    {
+        auto messageSize = static_cast<std::size_t>(state.range(0));
+        Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_DGRAM, .protocol = 0};
+        BasicSocket server;
+        BasicSocket client;
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        sockaddr_storage local{};
+        socklen_t length = sizeof(local);
+        if(!server.OpenSocket(deps) || !client.OpenSocket(deps)
+            || !server.Bind(reinterpret_cast<sockaddr*>(&address), sizeof(address))
+            || !server.GetLocalAddress(local, length)
+            || !client.Connect(reinterpret_cast<sockaddr*>(&local), length))
+        {
+            state.SkipWithError("socket setup failed");
+            return;
+        }
+
+        // A lost datagram must not hang the run.
+        timeval timeout{.tv_sec = 1, .tv_usec = 0};
+        ::setsockopt(client.GetSocketResource(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(server.GetSocketResource(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        std::thread echo([&server] {
+            std::vector<std::byte> buffer(64 * 1024);
+            while(true)
+            {
+                sockaddr_storage peer{};
+                socklen_t peerLength = sizeof(peer);
+                auto received = ::recvfrom(server.GetSocketResource(), buffer.data(), buffer.size(), 0,
+                    reinterpret_cast<sockaddr*>(&peer), &peerLength);
+                if(received <= 0) return;
+                ::sendto(server.GetSocketResource(), buffer.data(), static_cast<std::size_t>(received), 0,
+                    reinterpret_cast<sockaddr*>(&peer), peerLength);
+            }
+        });
+
+        std::vector<std::byte> message(messageSize, std::byte{0x5a});
+        std::vector<std::byte> reply(messageSize);
+        for(auto _ : state)
+        {
+            client.Write(message);
+            auto read = client.Read(reply);
+            if(!read.HasResult()) state.SkipWithError("datagram lost");
+        }
+
+        // An empty datagram stops the echo thread.
+        client.Write(std::span<const std::byte>());
+        echo.join();
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * messageSize * 2));
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+
+    bool WriteAll(SharedMemoryChannel& channel, std::span<const std::byte> buffer)
+    {
+        while(!buffer.empty())
+        {
+            auto written = channel.Write(buffer);
+            if(written.HasResult())
+            {
+                buffer = buffer.subspan(written.GetResult());
+            } else if(written.GetError() != EAGAIN || !channel.WaitWritable()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @return The bytes read, 0 once the peer is gone.
+     */
+    std::size_t ReadSome(SharedMemoryChannel& channel, std::span<std::byte> buffer)
+    {
+        while(true)
+        {
+            auto read = channel.Read(buffer);
+            if(read.HasResult()) return read.GetResult();
+            if(read.GetError() != EAGAIN || !channel.WaitReadable()) return 0;
+        }
+    }
+
+    /**
+     * range(0) bytes per message, range(1) busy-poll spins before sleeping.
+     * The same round trip as BM_UnixEcho with one connection, over a
+     * SharedMemoryChannel negotiated on a socketpair.
+     */
+    void BM_SharedMemoryEcho(benchmark::State& state)
+    {
+        auto messageSize = static_cast<std::size_t>(state.range(0));
+        SharedMemoryChannelOptions options{.busyPollSpins = static_cast<std::uint32_t>(state.range(1))};
+
+        auto control = BasicSocket::MakePair({.domain = AF_UNIX, .type = SOCK_STREAM, .protocol = 0});
+        auto client = SharedMemoryChannel::Create(control.GetResult().first, options);
+        auto server = SharedMemoryChannel::Attach(control.GetResult().second, options);
+        if(!client.HasResult() || !server.HasResult())
+        {
+            state.SkipWithError("channel setup failed");
+            return;
+        }
+
+        std::thread echo([&server] {
+            auto& channel = server.GetResult();
+            std::vector<std::byte> buffer(64 * 1024);
+            while(auto read = ReadSome(channel, buffer))
+            {
+                if(!WriteAll(channel, std::span(buffer).first(read))) return;
+            }
+        });
+
+        auto& channel = client.GetResult();
+        std::vector<std::byte> message(messageSize, std::byte{0x5a});
+        std::vector<std::byte> reply(messageSize);
+        for(auto _ : state)
+        {
+            if(!WriteAll(channel, message)) state.SkipWithError("write failed");
+            for(std::span<std::byte> pending(reply); !pending.empty();)
+            {
+                auto read = ReadSome(channel, pending);
+                if(read == 0)
+                {
+                    state.SkipWithError("read failed");
+                    break;
+                }
+                pending = pending.subspan(read);
+            }
+        }
+
+        channel.ShutdownWrite();
+        echo.join();
+
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * messageSize * 2));
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+
+    struct DrainingConnection final : IReactorHandler
+    {
+        BasicSocket socket;
+
+        void OnReadable(BasicSocket&) override
+        {
+            std::byte buffer[64];
+            while(socket.Read(buffer).HasResult()) {}
+        }
+    };
+
+    /**
+     * range(0) registered connections, 64 of them made readable per iteration.
+     * Measures the per-event cost of routing epoll events to their handlers as
+     * the registration table grows, without any network round trip.
+     */
+    void BM_ReactorDispatch(benchmark::State& state)
+    {
+        constexpr std::size_t ReadyPerIteration = 64;
+        auto count = static_cast<std::size_t>(state.range(0));
+        Reactor reactor;
+        std::vector<DrainingConnection> connections(count);
+        std::vector<BasicSocket> peers;
+        peers.reserve(count);
+        for(auto& connection : connections)
+        {
+            auto pair = BasicSocket::MakePair({.domain = AF_UNIX, .type = SOCK_STREAM, .protocol = 0,
+                .options = {.nonBlocking = true, .closeOnExec = true}});
+            if(!pair.HasResult())
+            {
+                state.SkipWithError("socketpair failed, raise the descriptor limit");
+                return;
+            }
+            connection.socket = std::move(pair.GetResult().first);
+            peers.push_back(std::move(pair.GetResult().second));
+            if(!reactor.Register(connection.socket, connection, ReactorEvent::Read))
+            {
+                state.SkipWithError("register failed");
+                return;
+            }
+        }
+
+        // A stride coprime with the count visits the connections in scattered order.
+        std::size_t next = 0;
+        const std::byte signal[1]{};
+        for(auto _ : state)
+        {
+            for(std::size_t i = 0; i < ReadyPerIteration; ++i)
+            {
+                next = (next + 7919) % count;
+                peers[next].Write(signal);
+            }
+            std::size_t dispatched = 0;
+            while(dispatched < ReadyPerIteration)
+            {
+                auto result = reactor.RunOnce(0);
+                if(!result.HasResult()) break;
+                dispatched += result.GetResult();
+            }
+        }
+
+        for(auto& connection : connections) reactor.Unregister(connection.socket);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ReadyPerIteration));
+    }
+}
+
+// Single connection runs measure round trip latency, wider ones throughput.
+BENCHMARK(BM_StreamEcho<OpenTcpConnections>)->Name("BM_TcpEcho")
+    ->ArgNames({"bytes", "connections"})
+    ->ArgsProduct({{64, 1024, 16384, 65536}, {1, 8, 32}})->UseRealTime();
+BENCHMARK(BM_StreamEcho<OpenUnixConnections>)->Name("BM_UnixEcho")
+    ->ArgNames({"bytes", "connections"})
+    ->ArgsProduct({{64, 1024, 16384, 65536}, {1, 8, 32}})->UseRealTime();
+BENCHMARK(BM_UdpEcho)->ArgName("bytes")->Arg(64)->Arg(1024)->Arg(8192)->UseRealTime();
+BENCHMARK(BM_SharedMemoryEcho)->ArgNames({"bytes", "spins"})
+    ->ArgsProduct({{64, 1024, 16384, 65536}, {0, 4096}})->UseRealTime();
+BENCHMARK(BM_ReactorDispatch)->ArgName("connections")->Arg(1024)->Arg(8192);
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/EventNotifier.hh>
+#include <EagleNetwork/MpscQueue.hh>
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using namespace Eagle::Core;
+
+namespace
+{
+    constexpr std::size_t QueueCapacity = 4096;
+    constexpr std::size_t ItemsPerProducer = 1 << 16;
+
+    void BM_MpscQueuePushPop(benchmark::State& state)
+    {
+        BoundedMpscQueue<std::size_t> queue(QueueCapacity);
+        std::size_t value = 0;
+        for(auto _ : state)
+        {
+            queue.TryPush(value);
+            queue.TryPop(value);
+            benchmark::DoNotOptimize(value);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    /**
+     * range(0) producers push into one queue drained in batches by the
+     * benchmark thread.
+     */
+    void BM_MpscQueueProducers(benchmark::State& state)
+    {
+        auto producers = static_cast<std::size_t>(state.range(0));
+        for(auto _ : state)
+        {
+            BoundedMpscQueue<std::size_t> queue(QueueCapacity);
+            std::atomic<bool> start{false};
+            std::vector<std::thread> threads;
+            for(std::size_t p = 0; p < producers; ++p)
+            {
+                threads.emplace_back([&queue, &start] {
+                    while(!start.load(std::memory_order_acquire)) {}
+                    for(std::size_t i = 0; i < ItemsPerProducer; ++i)
+                    {
+                        while(!queue.TryPush(i)) std::this_thread::yield();
+                    }
+                });
+            }
+
+            std::vector<std::size_t> batch(64);
+            std::size_t remaining = producers * ItemsPerProducer;
+            start.store(true, std::memory_order_release);
+            while(remaining > 0)
+            {
+                remaining -= queue.PopBatch(batch);
+            }
+            for(auto& thread : threads) thread.join();
+        }
+        state.SetItemsProcessed(state.iterations() * producers * ItemsPerProducer);
+    }
+
+    void BM_EventNotifierCoalesced(benchmark::State& state)
+    {
+        EventNotifier notifier;
+        std::size_t signalled = 0;
+        for(auto _ : state)
+        {
+            // One consumer wakeup per 64 notifications.
+            for(int i = 0; i < 64; ++i)
+            {
+                signalled += notifier.Notify();
+            }
+            notifier.Consume();
+        }
+        state.SetItemsProcessed(state.iterations() * 64);
+        state.counters["signals"] = benchmark::Counter(static_cast<double>(signalled), benchmark::Counter::kAvgIterations);
+    }
+}
+
+BENCHMARK(BM_MpscQueuePushPop);
+BENCHMARK(BM_MpscQueueProducers)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EventNotifierCoalesced);
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/ResourceInitializer.hh>
+#include <EagleNetwork/Result.hh>
+#include <benchmark/benchmark.h>
+
+using namespace Eagle::Core;
+
+namespace
+{
+    struct Dependencies
+    {
+        int value{1};
+    };
+
+    Utilities::Result<int, int> Initialize(const Dependencies& dependencies)
+    {
+        if(dependencies.value == 0) return Utilities::MakeError(-1);
+        return dependencies.value;
+    }
+
+    void BM_ResourceInitializer(benchmark::State& state)
+    {
+        Dependencies dependencies;
+        for(auto _ : state)
+        {
+            ResourceInitializer<int, int, Dependencies> initializer(Initialize, dependencies);
+            initializer.InitializeResource();
+            benchmark::DoNotOptimize(initializer.GetActualResrouce());
+        }
+    }
+
+    void BM_InlineResourceInitializer(benchmark::State& state)
+    {
+        Dependencies dependencies;
+        for(auto _ : state)
+        {
+            InlineResourceInitializer initializer(Initialize, dependencies);
+            initializer.InitializeResource();
+            benchmark::DoNotOptimize(initializer.GetActualResrouce());
+        }
+    }
+
+    void BM_InlineResourceInitializerLambda(benchmark::State& state)
+    {
+        for(auto _ : state)
+        {
+            InlineResourceInitializer initializer([]() -> Utilities::Result<int, int> { return 1; });
+            initializer.InitializeResource();
+            benchmark::DoNotOptimize(initializer.GetActualResrouce());
+        }
+    }
+}
+
+BENCHMARK(BM_ResourceInitializer);
+BENCHMARK(BM_InlineResourceInitializer);
+BENCHMARK(BM_InlineResourceInitializerLambda);
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Result.hh>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <utility>
+
+using namespace Eagle::Core;
+
+namespace
+{
+    using IntResult = Utilities::Result<int, int>;
+    using StringResult = Utilities::Result<std::string, int>;
+
+    [[gnu::noinline]] IntResult MakeIntResult(int value)
+    {
+        if(value < 0) return Utilities::MakeError(-value);
+        return value;
+    }
+
+    void BM_ResultConstructValue(benchmark::State& state)
+    {
+        int value = 1;
+        for(auto _ : state)
+        {
+            auto result = MakeIntResult(value);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+
+    void BM_ResultConstructError(benchmark::State& state)
+    {
+        int value = -1;
+        for(auto _ : state)
+        {
+            auto result = MakeIntResult(value);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+
+    void BM_ResultMove(benchmark::State& state)
+    {
+        StringResult source(std::string(static_cast<std::size_t>(state.range(0)), 'x'));
+        for(auto _ : state)
+        {
+            StringResult moved(std::move(source));
+            benchmark::DoNotOptimize(moved);
+            source = std::move(moved);
+        }
+    }
+
+    void BM_ResultAccess(benchmark::State& state)
+    {
+        auto result = MakeIntResult(42);
+        for(auto _ : state)
+        {
+            benchmark::DoNotOptimize(result);
+            int value = result.HasResult() ? result.GetResult() : 0;
+            benchmark::DoNotOptimize(value);
+        }
+    }
+
+    void BM_ResultMonadicChain(benchmark::State& state)
+    {
+        for(auto _ : state)
+        {
+            auto result = MakeIntResult(21)
+                .Transform([](int value) { return value * 2; })
+                .AndThen([](int value) -> IntResult { return value + 1; });
+            benchmark::DoNotOptimize(result);
+        }
+    }
+}
+
+BENCHMARK(BM_ResultConstructValue);
+BENCHMARK(BM_ResultConstructError);
+BENCHMARK(BM_ResultMove)->Arg(8)->Arg(256);
+BENCHMARK(BM_ResultAccess);
+BENCHMARK(BM_ResultMonadicChain);
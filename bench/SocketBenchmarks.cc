@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Socket.hh>
+#include <benchmark/benchmark.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+using namespace Eagle::Core;
+
+namespace
+{
+    void BM_SocketOpenClose(benchmark::State& state)
+    {
+        Detail::SocketResourceDependencies deps{.domain = static_cast<int>(state.range(0)), .type = SOCK_STREAM, .protocol = 0};
+        for(auto _ : state)
+        {
+            BasicSocket socket;
+            socket.OpenSocket(deps);
+            benchmark::DoNotOptimize(socket.GetSocketResource());
+            socket.CloseSocket();
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_SocketFromInitializer(benchmark::State& state)
+    {
+        for(auto _ : state)
+        {
+            BasicSocket socket(BasicSocket::MakeInitializer({.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0}));
+            benchmark::DoNotOptimize(socket.GetSocketResource());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_SocketOpenClose)->Arg(AF_INET)->Arg(AF_INET6)->Arg(AF_UNIX);
+BENCHMARK(BM_SocketFromInitializer);
@@ -0,0 +1,210 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_ASYNC_SOCKET_HH
+#define EAGLE_NETWORK_ASYNC_SOCKET_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/Socket.hh>
+#include <EagleNetwork/Task.hh>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <sys/socket.h>
+
+#if !defined (__linux__)
+#error "AsyncSocket requires the epoll Reactor and is only available on Linux."
+#endif
+
+namespace Eagle::Core
+{
+    class AsyncSocket;
+
+    class AsyncSocketRegistrationFailure : public std::runtime_error
+    {
+    public:
+        AsyncSocketRegistrationFailure()
+            : runtime_error("AsyncSocket: can't register the socket in the reactor.") {}
+    };
+
+    namespace Detail
+    {
+        /**
+         * Operation suspended until its socket is ready. The reactor handler
+         * retries it and resumes the awaiting coroutine once it stops reporting
+         * EAGAIN, so awaiting allocates nothing.
+         */
+        struct AsyncOperation
+        {
+        protected:
+            ~AsyncOperation() = default;
+
+        public:
+            std::coroutine_handle<> continuation{};
+
+            virtual bool TryComplete() = 0;
+            virtual void Fail(SocketPlatformErrorType::Type error) = 0;
+        };
+
+        template <typename TResult>
+        struct AsyncOperationBase : AsyncOperation
+        {
+            explicit AsyncOperationBase(AsyncSocket& socket) : socket(&socket) {}
+
+            void Fail(SocketPlatformErrorType::Type error) override
+            {
+                result.emplace(Utilities::MakeError(SocketPlatformErrorType::Type{error}));
+            }
+
+            TResult await_resume()
+            {
+                return std::move(*result);
+            }
+
+        protected:
+            AsyncSocket* socket;
+            std::optional<TResult> result;
+        };
+    }
+
+    /**
+     * BasicSocket registered in a Reactor exposing awaitable operations.
+     *
+     * Every operation is first attempted immediately and only suspends the
+     * coroutine on EAGAIN. At most one read-side operation (Read, Accept) and
+     * one write-side operation (Write, Connect) may be pending at a time. The
+     * socket must not be moved while registered.
+     */
+    class AsyncSocket final : private IReactorHandler
+    {
+    public:
+        struct ReadOperation : Detail::AsyncOperationBase<Detail::SocketIOResult>
+        {
+            ReadOperation(AsyncSocket& socket, std::span<std::byte> buffer)
+                : AsyncOperationBase(socket), buffer(buffer) {}
+
+            bool TryComplete() override;
+            bool await_ready() { return TryComplete(); }
+            void await_suspend(std::coroutine_handle<> handle);
+
+        private:
+            std::span<std::byte> buffer;
+        };
+
+        struct WriteOperation : Detail::AsyncOperationBase<Detail::SocketIOResult>
+        {
+            WriteOperation(AsyncSocket& socket, std::span<const std::byte> buffer)
+                : AsyncOperationBase(socket), buffer(buffer) {}
+
+            bool TryComplete() override;
+            bool await_ready() { return TryComplete(); }
+            void await_suspend(std::coroutine_handle<> handle);
+
+        private:
+            std::span<const std::byte> buffer;
+        };
+
+        using AcceptResult = Utilities::Result<BasicSocket, Detail::SocketPlatformErrorType::Type>;
+
+        struct AcceptOperation : Detail::AsyncOperationBase<AcceptResult>
+        {
+            explicit AcceptOperation(AsyncSocket& socket) : AsyncOperationBase(socket) {}
+
+            bool TryComplete() override;
+            bool await_ready() { return TryComplete(); }
+            void await_suspend(std::coroutine_handle<> handle);
+        };
+
+        struct ConnectOperation : Detail::AsyncOperationBase<Detail::SocketStatusResult>
+        {
+            ConnectOperation(AsyncSocket& socket, const sockaddr* address, socklen_t length)
+                : AsyncOperationBase(socket), address(address), length(length) {}
+
+            bool TryComplete() override;
+            void Fail(Detail::SocketPlatformErrorType::Type error) override;
+            bool await_ready();
+            void await_suspend(std::coroutine_handle<> handle);
+
+        private:
+            void RecordLatency();
+
+            const sockaddr* address;
+            socklen_t length;
+            std::chrono::steady_clock::time_point start{};
+        };
+
+        /**
+         * @brief Make the socket non-blocking and register it in the reactor.
+         * @throws AsyncSocketRegistrationFailure if the socket can't be registered.
+         */
+        AsyncSocket(Reactor& reactor, BasicSocket&& socket);
+        ~AsyncSocket() override;
+
+        AsyncSocket(const AsyncSocket&) = delete;
+        AsyncSocket& operator=(const AsyncSocket&) = delete;
+        AsyncSocket(AsyncSocket&&) = delete;
+        AsyncSocket& operator=(AsyncSocket&&) = delete;
+
+        /**
+         * @brief Read into buffer, 0 bytes read means the peer closed the stream.
+         */
+        ReadOperation Read(std::span<std::byte> buffer);
+
+        /**
+         * @brief Write part of buffer, the result is the number of bytes written.
+         */
+        WriteOperation Write(std::span<const std::byte> buffer);
+
+        /**
+         * @brief Write the whole buffer, resuming on writability as needed.
+         */
+        Task<Detail::SocketIOResult> WriteAll(std::span<const std::byte> buffer);
+
+        AcceptOperation Accept();
+
+        /**
+         * @brief Connect to address, which must stay valid until completion.
+         */
+        ConnectOperation Connect(const sockaddr* address, socklen_t length);
+
+        BasicSocket& GetSocket();
+        Reactor& GetReactor();
+
+    private:
+        void OnReadable(BasicSocket& socket) override;
+        void OnWritable(BasicSocket& socket) override;
+        void OnError(BasicSocket& socket, Detail::SocketPlatformErrorType::Type error) override;
+
+        static void Resume(Detail::AsyncOperation*& pending, bool failed, Detail::SocketPlatformErrorType::Type error);
+
+        Reactor& reactor;
+        BasicSocket socket;
+        Detail::AsyncOperation* reader{nullptr};
+        Detail::AsyncOperation* writer{nullptr};
+    };
+}
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_BUFFER_HH
+#define EAGLE_NETWORK_BUFFER_HH
+
+#include <EagleNetwork/PoolAllocator.hh>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <sys/uio.h>
+
+namespace Eagle::Core
+{
+    namespace Detail
+    {
+        /**
+         * Fixed capacity, reference counted block of memory shared by the
+         * segments of one or many ChainedBuffer.
+         */
+        struct BufferSlab
+        {
+            std::atomic<std::uint32_t> references;
+            std::size_t capacity;
+            /**
+             * Number of bytes written from the start of the slab.
+             */
+            std::size_t size;
+
+            std::byte* Data()
+            {
+                return reinterpret_cast<std::byte*>(this + 1);
+            }
+
+            static BufferSlab* Allocate(std::size_t capacity);
+            static void Acquire(BufferSlab* slab);
+            static void Release(BufferSlab* slab);
+        };
+
+        /**
+         * A view of [offset, offset + length) of a slab, holding one reference to it.
+         */
+        struct BufferSegment
+        {
+            BufferSlab* slab;
+            std::size_t offset;
+            std::size_t length;
+        };
+    }
+
+    /**
+     * Segmented byte buffer made of a chain of fixed-size slabs.
+     *
+     * Appending never moves stored bytes, and copying, slicing or splitting a
+     * buffer shares the underlying slabs instead of copying them, so one payload
+     * can be queued on many sockets. Bytes of a shared slab are never modified:
+     * appends only write in place into a slab referenced by this buffer alone.
+     */
+    class ChainedBuffer
+    {
+    public:
+        /**
+         * Default slab capacity, so that a slab and its header fill a pool size class.
+         */
+        static constexpr std::size_t DefaultSlabCapacity = 16 * 1024 - sizeof(Detail::BufferSlab);
+
+        /**
+         * @param slabCapacity Capacity of the slabs allocated by this buffer.
+         */
+        explicit ChainedBuffer(std::size_t slabCapacity = DefaultSlabCapacity);
+        ~ChainedBuffer();
+
+        ChainedBuffer(const ChainedBuffer& other);
+        ChainedBuffer& operator=(const ChainedBuffer& other);
+        ChainedBuffer(ChainedBuffer&& other) noexcept;
+        ChainedBuffer& operator=(ChainedBuffer&& other) noexcept;
+
+        /**
+         * @return The number of readable bytes.
+         */
+        std::size_t Size() const;
+        bool IsEmpty() const;
+
+        /**
+         * @return The number of slab segments the bytes are spread over.
+         */
+        std::size_t GetSegmentCount() const;
+
+        /**
+         * @brief Copy bytes at the end of the buffer.
+         */
+        void Append(std::span<const std::byte> bytes);
+
+        /**
+         * @brief Share the bytes of another buffer at the end of this one.
+         */
+        void Append(const ChainedBuffer& other);
+
+        /**
+         * @brief Get at least minimum writable bytes at the end of the buffer, which
+         * become readable once Commit is called.
+         */
+        std::span<std::byte> PrepareWrite(std::size_t minimum = 1);
+
+        /**
+         * @brief Make count bytes of the last PrepareWrite span readable.
+         */
+        void Commit(std::size_t count);
+
+        /**
+         * @brief Drop count bytes from the front of the buffer.
+         */
+        void Consume(std::size_t count);
+
+        /**
+         * @brief Share count bytes starting at offset without copying them.
+         */
+        ChainedBuffer Slice(std::size_t offset, std::size_t count) const;
+
+        /**
+         * @brief Remove the first count bytes and return them as a new buffer.
+         */
+        ChainedBuffer Split(std::size_t count);
+
+        /**
+         * @brief Fill vectors with the readable segments, for writev or sendmsg.
+         *
+         * @return The number of vectors filled.
+         */
+        std::size_t ExportVectors(std::span<iovec> vectors) const;
+
+        /**
+         * @brief Copy up to destination.size() bytes from the front of the buffer.
+         *
+         * @return The number of bytes copied.
+         */
+        std::size_t CopyTo(std::span<std::byte> destination) const;
+
+        void Clear();
+
+    private:
+        std::deque<Detail::BufferSegment, PoolAllocatorAdapter<Detail::BufferSegment>> segments;
+        std::size_t size{0};
+        std::size_t slabCapacity;
+    };
+}
+
+#endif
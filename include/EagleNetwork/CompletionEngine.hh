@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_COMPLETION_ENGINE_HH
+#define EAGLE_NETWORK_COMPLETION_ENGINE_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+
+#if !defined (__linux__)
+#error "CompletionEngine requires io_uring or epoll and is only available on Linux."
+#endif
+
+namespace Eagle::Core
+{
+    class CompletionEngineCreationFailure : public std::runtime_error
+    {
+    public:
+        CompletionEngineCreationFailure()
+            : runtime_error("CompletionEngine: can't create the completion backend.") {}
+    };
+
+    /**
+     * The backend used by a CompletionEngine.
+     */
+    enum class CompletionEngineBackend
+    {
+        /**
+         * Use io_uring when the kernel supports it, the readiness backend otherwise.
+         */
+        Automatic,
+        /**
+         * Batched submissions through a single io_uring_enter call.
+         */
+        IoUring,
+        /**
+         * Non-blocking operations retried on epoll readiness.
+         */
+        Readiness
+    };
+
+    /**
+     * Completion of an operation submitted to a CompletionEngine.
+     */
+    struct IOCompletion
+    {
+        /**
+         * The tag given when the operation was prepared.
+         */
+        std::uint64_t tag;
+        /**
+         * The number of bytes transferred, or the negated platform error.
+         */
+        Detail::IO::IOSocketOperationResult::Type result;
+    };
+
+    /**
+     * Proactor executing Detail::IO::IOSocketOperationDep descriptors.
+     *
+     * Operations are prepared into a batch which Submit hands to the kernel at once.
+     * The descriptor's size is the number of bytes requested and is clamped to the
+     * buffer storage; on completion the number of bytes transferred is stored in the
+     * descriptor's inputNumberBytes or outputNumberBytes. Descriptors are referenced,
+     * not copied, and must stay alive until their completion has been reaped.
+     */
+    class CompletionEngine
+    {
+    public:
+        /**
+         * @param entries Maximum number of operations in flight.
+         * @param backend The backend to use.
+         */
+        explicit CompletionEngine(unsigned entries = 256,
+            CompletionEngineBackend backend = CompletionEngineBackend::Automatic);
+        ~CompletionEngine();
+
+        CompletionEngine(const CompletionEngine&) = delete;
+        CompletionEngine& operator=(const CompletionEngine&) = delete;
+        CompletionEngine(CompletionEngine&&) = delete;
+        CompletionEngine& operator=(CompletionEngine&&) = delete;
+
+        /**
+         * @return The backend selected at construction, never Automatic.
+         */
+        CompletionEngineBackend GetBackend() const;
+
+        /**
+         * @brief Add a receive operation to the pending batch.
+         *
+         * @return false if the engine has no free operation slot.
+         */
+        template <typename BufferType>
+        bool Prepare(Detail::IO::IOSocketOperationDep<Detail::IO::InputSocketOperationDep, BufferType>& operation,
+            std::uint64_t tag)
+        {
+            operation.operationBuffer.inputNumberBytes = 0;
+            return PrepareOperation(false, operation.resource, &operation.operationBuffer.buffer,
+                std::min(operation.size, sizeof(operation.operationBuffer.buffer)),
+                &operation.operationBuffer.inputNumberBytes, tag);
+        }
+
+        /**
+         * @brief Add a send operation to the pending batch.
+         *
+         * @return false if the engine has no free operation slot.
+         */
+        template <typename BufferType>
+        bool Prepare(Detail::IO::IOSocketOperationDep<Detail::IO::OutputSocketOperationDep, BufferType>& operation,
+            std::uint64_t tag)
+        {
+            operation.operationBuffer.outputNumberBytes = 0;
+            return PrepareOperation(true, operation.resource, &operation.operationBuffer.buffer,
+                std::min(operation.size, sizeof(operation.operationBuffer.buffer)),
+                &operation.operationBuffer.outputNumberBytes, tag);
+        }
+
+        /**
+         * @brief Add a batch of operations, tagged firstTag, firstTag + 1, ...
+         *
+         * @return The number of operations prepared, less than the batch size when
+         * the engine ran out of slots.
+         */
+        template <typename Operation, std::size_t Extent>
+        std::size_t Prepare(std::span<Operation, Extent> operations, std::uint64_t firstTag)
+        {
+            std::size_t prepared = 0;
+            for(auto& operation : operations)
+            {
+                if(!Prepare(operation, firstTag + prepared)) break;
+                ++prepared;
+            }
+            return prepared;
+        }
+
+        /**
+         * @brief Submit every prepared operation with a single system call.
+         *
+         * @return The number of operations submitted or the platform error.
+         */
+        Detail::SocketIOResult Submit();
+
+        /**
+         * @brief Collect finished operations.
+         *
+         * @param completions Storage for the completions.
+         * @param wait Block until at least one operation completes.
+         * @return The number of completions stored or the platform error.
+         */
+        Detail::SocketIOResult Reap(std::span<IOCompletion> completions, bool wait);
+
+        /**
+         * @return The number of operations submitted and not reaped yet.
+         */
+        std::size_t GetInFlightCount() const;
+
+    private:
+        bool PrepareOperation(bool output, Detail::SocketResourceType::ResourceType resource,
+            void* buffer, std::size_t size, std::size_t* transferred, std::uint64_t tag);
+
+        struct CompletionEngineImpl;
+        std::unique_ptr<CompletionEngineImpl> impl;
+    };
+}
+
+#endif
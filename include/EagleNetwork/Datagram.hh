@@ -0,0 +1,191 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_DATAGRAM_HH
+#define EAGLE_NETWORK_DATAGRAM_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Socket.hh>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+#if !defined (__linux__)
+#error "DatagramBatch requires recvmmsg/sendmmsg and is only available on Linux."
+#endif
+
+namespace Eagle::Core
+{
+    /**
+     * Datagrams received in one coalesced buffer when UDP_GRO is enabled.
+     */
+    struct CoalescedDatagrams
+    {
+        /**
+         * Total number of bytes received.
+         */
+        std::size_t size{0};
+        /**
+         * Size of every datagram but the last one, equal to size when the
+         * kernel did not coalesce anything.
+         */
+        std::size_t segmentSize{0};
+    };
+
+    /**
+     * Moves many datagrams per system call on bound or connected datagram sockets.
+     *
+     * Message headers are allocated once for the batch capacity and reused by every
+     * call, larger IOSocketMultiOperationDep batches are truncated to the capacity.
+     * Receive records the source address of every datagram so that Reply can
+     * answer them from an unconnected socket.
+     */
+    class DatagramBatch
+    {
+    public:
+        /**
+         * @param capacity Maximum number of datagrams moved by one call.
+         */
+        explicit DatagramBatch(std::size_t capacity = 64);
+
+        std::size_t GetCapacity() const;
+
+        /**
+         * @brief Receive up to one datagram per operation buffer with recvmmsg.
+         *
+         * A blocking socket only waits for the first datagram. The size of each datagram is stored in its inputNumberBytes.
+         *
+         * @return The number of datagrams received or the platform error.
+         */
+        template <typename BufferType>
+        Detail::SocketIOResult Receive(
+            Detail::IO::IOSocketMultiOperationDep<Detail::IO::InputSocketOperationDep, BufferType>& operation)
+        {
+            auto count = std::min(operation.operationBuffers.size(), headers.size());
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                auto& buffer = operation.operationBuffers[i];
+                SetMessage(i, &buffer.buffer, std::min(operation.size, sizeof(buffer.buffer)));
+                SetAddress(i, sizeof(sockaddr_storage));
+            }
+
+            auto result = ReceiveMessages(operation.resource, count);
+            if(result.HasResult())
+            {
+                for(std::size_t i = 0; i < result.GetResult(); ++i)
+                {
+                    operation.operationBuffers[i].inputNumberBytes = headers[i].msg_len;
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @brief Send one datagram per operation buffer with sendmmsg.
+         *
+         * The size of each datagram is its outputNumberBytes, clamped to size.
+         *
+         * @return The number of datagrams sent or the platform error.
+         */
+        template <typename BufferType>
+        Detail::SocketIOResult Send(
+            Detail::IO::IOSocketMultiOperationDep<Detail::IO::OutputSocketOperationDep, BufferType>& operation)
+        {
+            auto count = std::min(operation.operationBuffers.size(), headers.size());
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                auto& buffer = operation.operationBuffers[i];
+                SetMessage(i, &buffer.buffer,
+                    std::min({buffer.outputNumberBytes, operation.size, sizeof(buffer.buffer)}));
+            }
+
+            return SendMessages(operation.resource, count);
+        }
+
+        /**
+         * @brief Send operation buffer i back to the source of datagram i of the
+         * last Receive, with one sendmmsg.
+         *
+         * At most as many buffers as that Receive returned are sent.
+         *
+         * @return The number of datagrams sent or the platform error.
+         */
+        template <typename BufferType>
+        Detail::SocketIOResult Reply(
+            Detail::IO::IOSocketMultiOperationDep<Detail::IO::OutputSocketOperationDep, BufferType>& operation)
+        {
+            auto count = std::min(operation.operationBuffers.size(), receivedCount);
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                auto& buffer = operation.operationBuffers[i];
+                SetMessage(i, &buffer.buffer,
+                    std::min({buffer.outputNumberBytes, operation.size, sizeof(buffer.buffer)}));
+                SetAddress(i, addressLengths[i]);
+            }
+            return SendMessages(operation.resource, count);
+        }
+
+        /**
+         * @brief Send a burst of datagrams of segmentSize bytes, the last one possibly
+         * shorter, with a single sendmsg using UDP generic segmentation offload.
+         *
+         * @return The number of bytes sent or the platform error.
+         */
+        static Detail::SocketIOResult SendSegmented(BasicSocket& socket, std::span<const std::byte> payload,
+            std::uint16_t segmentSize);
+
+        /**
+         * @brief Receive a burst coalesced by UDP generic receive offload, which must
+         * have been enabled with EnableReceiveOffload.
+         */
+        static Utilities::Result<CoalescedDatagrams, Detail::SocketPlatformErrorType::Type>
+            ReceiveCoalesced(BasicSocket& socket, std::span<std::byte> buffer);
+
+        /**
+         * @brief Segment every send on this socket in datagrams of segmentSize bytes.
+         */
+        static bool EnableSegmentation(BasicSocket& socket, std::uint16_t segmentSize);
+
+        /**
+         * @brief Let the kernel coalesce received datagrams of a flow in one buffer.
+         */
+        static bool EnableReceiveOffload(BasicSocket& socket);
+
+    private:
+        void SetMessage(std::size_t index, void* buffer, std::size_t size);
+        void SetAddress(std::size_t index, socklen_t length);
+        Detail::SocketIOResult ReceiveMessages(Detail::SocketResourceType::ResourceType resource, std::size_t count);
+        Detail::SocketIOResult SendMessages(Detail::SocketResourceType::ResourceType resource, std::size_t count);
+
+        std::vector<mmsghdr> headers;
+        std::vector<iovec> vectors;
+        std::vector<sockaddr_storage> addresses;
+        std::vector<socklen_t> addressLengths;
+        std::size_t receivedCount{0};
+    };
+}
+
+#endif
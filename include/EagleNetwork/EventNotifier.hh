@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_EVENT_NOTIFIER_HH
+#define EAGLE_NETWORK_EVENT_NOTIFIER_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Socket.hh>
+#include <atomic>
+#include <stdexcept>
+
+#if !defined (__linux__)
+#error "EventNotifier requires eventfd and is only available on Linux."
+#endif
+
+namespace Eagle::Core
+{
+    class EventNotifierCreationFailure : public std::runtime_error
+    {
+    public:
+        EventNotifierCreationFailure()
+            : runtime_error("EventNotifier: can't create the event resource.") {}
+    };
+
+    /**
+     * Cross-thread wakeup of an event loop backed by a non-blocking eventfd.
+     *
+     * Notifications coalesce: only the first Notify after the consumer called
+     * Consume writes to the eventfd, later ones are a single atomic exchange. The
+     * resource is held by a BasicSocket so it can be registered in a Reactor.
+     */
+    class EventNotifier
+    {
+    public:
+        EventNotifier();
+
+        EventNotifier(const EventNotifier&) = delete;
+        EventNotifier& operator=(const EventNotifier&) = delete;
+
+        /**
+         * @brief Wake the consumer, callable from any thread.
+         * @return true if this call signalled the eventfd.
+         */
+        bool Notify();
+
+        /**
+         * @brief Acknowledge the pending notification, consumer thread only.
+         *
+         * Must be called before draining the state the notification announces,
+         * so producers publishing during the drain signal again.
+         * @return true if a notification was pending.
+         */
+        bool Consume();
+
+        /**
+         * @return The socket holding the eventfd, readable while a notification is pending.
+         */
+        BasicSocket& GetSocket();
+
+    private:
+        BasicSocket resource;
+        alignas(Detail::CacheLineSize) std::atomic<bool> pending{false};
+    };
+}
+
+#endif
@@ -0,0 +1,431 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_EXECUTOR_HH
+#define EAGLE_NETWORK_EXECUTOR_HH
+
+#include <EagleNetwork/Result.hh>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Eagle::Core
+{
+    /**
+     * Reason a task submitted to an Executor produced no value.
+     */
+    struct ExecutorError
+    {
+        enum class Code
+        {
+            /**
+             * The executor was destroyed before running the task.
+             */
+            Cancelled,
+            /**
+             * The task exited with an exception, stored in exception.
+             */
+            Exception
+        };
+
+        Code code{Code::Cancelled};
+        std::exception_ptr exception{};
+    };
+
+    struct ExecutorStatistics
+    {
+        std::size_t queued{0};
+        std::size_t executed{0};
+        std::size_t steals{0};
+    };
+
+    namespace Detail
+    {
+        /**
+         * Chase-Lev work-stealing deque of pointers.
+         *
+         * The owner thread pushes and takes at the bottom, any other thread steals
+         * at the top. The ring grows on demand, retired rings are kept alive until
+         * the deque is destroyed since a thief may still be reading them.
+         */
+        template <typename T>
+        class WorkStealingDeque
+        {
+            static_assert(std::is_pointer_v<T>, "WorkStealingDeque stores pointers.");
+
+            struct Ring
+            {
+                std::int64_t mask;
+                std::unique_ptr<std::atomic<T>[]> slots;
+
+                explicit Ring(std::int64_t capacity)
+                    : mask(capacity - 1), slots(std::make_unique<std::atomic<T>[]>(capacity)) {}
+
+                std::int64_t Capacity() const { return mask + 1; }
+                T Load(std::int64_t index) const { return slots[index & mask].load(std::memory_order_relaxed); }
+                void Store(std::int64_t index, T value) { slots[index & mask].store(value, std::memory_order_relaxed); }
+            };
+
+        public:
+            explicit WorkStealingDeque(std::int64_t capacity = 256)
+            {
+                auto initial = std::make_unique<Ring>(std::bit_ceil(static_cast<std::uint64_t>(capacity)));
+                ring.store(initial.get(), std::memory_order_relaxed);
+                rings.push_back(std::move(initial));
+            }
+
+            WorkStealingDeque(const WorkStealingDeque&) = delete;
+            WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+            /**
+             * @brief Push a value at the bottom, owner thread only.
+             */
+            void Push(T value)
+            {
+                auto b = bottom.load(std::memory_order_relaxed);
+                auto t = top.load(std::memory_order_acquire);
+                auto* current = ring.load(std::memory_order_relaxed);
+                if(b - t > current->Capacity() - 1)
+                {
+                    current = Grow(current, t, b);
+                }
+                current->Store(b, value);
+                std::atomic_thread_fence(std::memory_order_release);
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Pop the most recently pushed value, owner thread only.
+             * @return The value, or nullptr when the deque is empty.
+             */
+            T Take()
+            {
+                auto b = bottom.load(std::memory_order_relaxed) - 1;
+                auto* current = ring.load(std::memory_order_relaxed);
+                bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto t = top.load(std::memory_order_relaxed);
+
+                if(t > b)
+                {
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+
+                T value = current->Load(b);
+                if(t == b)
+                {
+                    // Last element, race the thieves for it.
+                    if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    {
+                        value = nullptr;
+                    }
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                return value;
+            }
+
+            /**
+             * @brief Take the oldest value, callable from any thread.
+             * @return The value, or nullptr when the deque is empty or another
+             * thread won the race for it.
+             */
+            T Steal()
+            {
+                auto t = top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto b = bottom.load(std::memory_order_acquire);
+                if(t >= b)
+                {
+                    return nullptr;
+                }
+
+                T value = ring.load(std::memory_order_acquire)->Load(t);
+                if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    return nullptr;
+                }
+                return value;
+            }
+
+            std::size_t Size() const
+            {
+                auto b = bottom.load(std::memory_order_relaxed);
+                auto t = top.load(std::memory_order_relaxed);
+                return b > t ? static_cast<std::size_t>(b - t) : 0;
+            }
+
+        private:
+            Ring* Grow(Ring* current, std::int64_t t, std::int64_t b)
+            {
+                auto grown = std::make_unique<Ring>(current->Capacity() * 2);
+                for(auto i = t; i < b; ++i)
+                {
+                    grown->Store(i, current->Load(i));
+                }
+                auto* raw = grown.get();
+                rings.push_back(std::move(grown));
+                ring.store(raw, std::memory_order_release);
+                return raw;
+            }
+
+            alignas(64) std::atomic<std::int64_t> top{0};
+            alignas(64) std::atomic<std::int64_t> bottom{0};
+            std::atomic<Ring*> ring{nullptr};
+            std::vector<std::unique_ptr<Ring>> rings;
+        };
+
+        struct ExecutorTask
+        {
+            virtual ~ExecutorTask() = default;
+            virtual void Run() = 0;
+        };
+
+        template <typename F>
+        struct PostedTask final : ExecutorTask
+        {
+            F function;
+
+            template <typename G>
+            explicit PostedTask(G&& function) : function(std::forward<G>(function)) {}
+
+            void Run() override
+            {
+                function();
+            }
+        };
+
+        template <typename T>
+        struct ExecutorFutureState
+        {
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::optional<Utilities::Result<T, ExecutorError>> value;
+
+            template <typename U>
+            void Set(U&& result)
+            {
+                {
+                    std::lock_guard lock(mutex);
+                    if(value.has_value()) return;
+                    value.emplace(std::forward<U>(result));
+                }
+                ready.notify_all();
+            }
+        };
+    }
+
+    /**
+     * Handle to the Result of a task submitted to an Executor.
+     */
+    template <typename T>
+    class ExecutorFuture
+    {
+    public:
+        using ResultType = Utilities::Result<T, ExecutorError>;
+
+        ExecutorFuture() = default;
+        explicit ExecutorFuture(std::shared_ptr<Detail::ExecutorFutureState<T>> state) : state(std::move(state)) {}
+
+        bool IsValid() const
+        {
+            return state != nullptr;
+        }
+
+        bool IsReady() const
+        {
+            std::lock_guard lock(state->mutex);
+            return state->value.has_value();
+        }
+
+        void Wait() const
+        {
+            std::unique_lock lock(state->mutex);
+            state->ready.wait(lock, [this] { return state->value.has_value(); });
+        }
+
+        template <typename Rep, typename Period>
+        bool WaitFor(std::chrono::duration<Rep, Period> timeout) const
+        {
+            std::unique_lock lock(state->mutex);
+            return state->ready.wait_for(lock, timeout, [this] { return state->value.has_value(); });
+        }
+
+        /**
+         * @brief Wait for the task and take its result, the future becomes invalid.
+         */
+        ResultType Get()
+        {
+            Wait();
+            auto current = std::move(state);
+            return std::move(*current->value);
+        }
+
+    private:
+        std::shared_ptr<Detail::ExecutorFutureState<T>> state;
+    };
+
+    namespace Detail
+    {
+        template <typename F, typename T>
+        struct SubmittedTask final : ExecutorTask
+        {
+            F function;
+            std::shared_ptr<ExecutorFutureState<T>> state;
+
+            template <typename G>
+            SubmittedTask(G&& function, std::shared_ptr<ExecutorFutureState<T>> state)
+                : function(std::forward<G>(function)), state(std::move(state)) {}
+
+            ~SubmittedTask() override
+            {
+                // No-op once Run stored a value.
+                state->Set(Utilities::MakeError(ExecutorError{ExecutorError::Code::Cancelled, nullptr}));
+            }
+
+            void Run() override
+            {
+#if defined (__cpp_exceptions)
+                try
+                {
+#endif
+                    if constexpr(std::is_void_v<T>)
+                    {
+                        function();
+                        state->Set(Utilities::Result<void, ExecutorError>());
+                    } else {
+                        state->Set(Utilities::Result<T, ExecutorError>(function()));
+                    }
+#if defined (__cpp_exceptions)
+                } catch(...) {
+                    state->Set(Utilities::MakeError(ExecutorError{ExecutorError::Code::Exception, std::current_exception()}));
+                }
+#endif
+            }
+        };
+    }
+
+    /**
+     * Thread pool running tasks off the I/O threads.
+     *
+     * Every worker owns a Chase-Lev deque. Tasks posted from a worker go to its
+     * own deque and are run most recent first, tasks posted from other threads,
+     * e.g. a reactor loop, go to a shared injection queue. A worker that runs out
+     * of work steals the oldest task of another worker, so a handler blocking one
+     * worker doesn't hold back the tasks queued behind it.
+     */
+    class Executor
+    {
+    public:
+        /**
+         * @param workers Number of worker threads, 0 for one per hardware thread.
+         */
+        explicit Executor(std::size_t workers = 0);
+
+        /**
+         * Runs every queued task, then joins the workers.
+         */
+        ~Executor();
+
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        /**
+         * @brief Queue a fire-and-forget task.
+         * @return false when the executor is shutting down and dropped the task.
+         */
+        template <typename F>
+        bool Post(F&& function)
+        {
+            return Enqueue(new Detail::PostedTask<std::decay_t<F>>(std::forward<F>(function)));
+        }
+
+        /**
+         * @brief Queue a task and get a future to its return value.
+         *
+         * The future holds ExecutorError::Code::Exception if the task threw, and
+         * ExecutorError::Code::Cancelled if it never ran.
+         */
+        template <typename F>
+        auto Submit(F&& function) -> ExecutorFuture<std::invoke_result_t<std::decay_t<F>&>>
+        {
+            using ValueType = std::invoke_result_t<std::decay_t<F>&>;
+
+            auto state = std::make_shared<Detail::ExecutorFutureState<ValueType>>();
+            ExecutorFuture<ValueType> future(state);
+            Enqueue(new Detail::SubmittedTask<std::decay_t<F>, ValueType>(std::forward<F>(function), std::move(state)));
+            return future;
+        }
+
+        /**
+         * @brief Stop accepting tasks, run the queued ones and join the workers.
+         *
+         * Called from a task, the calling worker is not joined: it stops once the
+         * task returns and the destructor joins it. The destructor itself must not
+         * run on a worker.
+         */
+        void Shutdown();
+
+        std::size_t GetWorkerCount() const;
+
+        /**
+         * @return The number of tasks queued and not started yet.
+         */
+        std::size_t GetQueueDepth() const;
+
+        /**
+         * @return The number of tasks taken from another worker's deque.
+         */
+        std::size_t GetStealCount() const;
+
+        ExecutorStatistics GetStatistics() const;
+
+    private:
+        struct Worker;
+
+        bool Enqueue(Detail::ExecutorTask* task);
+        Detail::ExecutorTask* FindTask(Worker& worker);
+        void WorkerLoop(Worker& worker);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::mutex mutex;
+        std::condition_variable available;
+        std::deque<Detail::ExecutorTask*> injected;
+        std::atomic<std::size_t> queued{0};
+        std::atomic<std::size_t> sleeping{0};
+        std::atomic<bool> injectedPending{false};
+        bool stopping{false};
+    };
+}
+
+#endif
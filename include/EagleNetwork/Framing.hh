@@ -0,0 +1,267 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_FRAMING_HH
+#define EAGLE_NETWORK_FRAMING_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Result.hh>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace Eagle::Core
+{
+    namespace Detail
+    {
+        /**
+         * @brief Find the first occurrence of delimiter in bytes, comparing a
+         * vector of candidate first and last bytes at a time (AVX2 when the CPU
+         * has it, SSE2, or memchr).
+         * @return The offset of the match, bytes.size() when there is none.
+         */
+        std::size_t FindDelimiter(std::span<const std::byte> bytes, std::span<const std::byte> delimiter);
+
+        /**
+         * The part of a buffered frame holding its payload.
+         */
+        struct FrameBoundary
+        {
+            std::size_t payloadOffset;
+            std::size_t payloadLength;
+            std::size_t frameLength;
+        };
+
+        /**
+         * Contiguous receive storage of a FrameReader. Bytes are appended at the
+         * end and consumed from the front; the unconsumed tail is only moved
+         * back to the start by PrepareWrite.
+         */
+        class FrameStorage
+        {
+        public:
+            explicit FrameStorage(std::size_t maximumSize);
+
+            /**
+             * @brief Get writable space after the stored bytes, compacting or
+             * growing the storage, which invalidates views of consumed bytes.
+             * @return An empty span when the storage is at its maximum size and full.
+             */
+            std::span<std::byte> PrepareWrite(std::size_t minimum);
+            void Commit(std::size_t count);
+            void Consume(std::size_t count);
+
+            std::span<const std::byte> GetReadable() const;
+
+        private:
+            std::unique_ptr<std::byte[]> data;
+            std::size_t capacity = 0;
+            std::size_t maximumSize;
+            std::size_t readOffset = 0;
+            std::size_t writeOffset = 0;
+        };
+    }
+
+    enum class FrameError
+    {
+        /**
+         * The buffered bytes end inside a frame, fill the reader and try again.
+         */
+        Incomplete,
+        /**
+         * The frame is larger than the reader's maximum frame size.
+         */
+        TooLarge,
+        /**
+         * The length prefix can't be decoded.
+         */
+        Malformed
+    };
+
+    using FrameBoundaryResult = Utilities::Result<Detail::FrameBoundary, FrameError>;
+
+    enum class LengthPrefix
+    {
+        /**
+         * Unsigned LEB128, as in protobuf, up to 10 bytes.
+         */
+        Varint,
+        /**
+         * Big-endian 16-bit length.
+         */
+        Fixed16,
+        /**
+         * Big-endian 32-bit length.
+         */
+        Fixed32
+    };
+
+    /**
+     * Frames made of a length prefix followed by that many payload bytes.
+     */
+    class LengthPrefixFramer
+    {
+    public:
+        static constexpr std::size_t MaxPrefixLength = 10;
+
+        explicit LengthPrefixFramer(LengthPrefix prefix);
+
+        FrameBoundaryResult Find(std::span<const std::byte> bytes, std::size_t maximumFrameSize);
+
+        /**
+         * @brief Encode the prefix of a payloadLength bytes frame.
+         * @return The number of bytes written to prefix, 0 when the length doesn't fit the format.
+         */
+        std::size_t EncodePrefix(std::uint64_t payloadLength, std::span<std::byte, MaxPrefixLength> prefix) const;
+
+    private:
+        LengthPrefix prefix;
+    };
+
+    class DelimiterFramerCreationFailure : public std::runtime_error
+    {
+    public:
+        DelimiterFramerCreationFailure()
+            : runtime_error("DelimiterFramer: the delimiter must be between 1 and 16 bytes.") {}
+    };
+
+    /**
+     * Frames terminated by a delimiter such as "\r\n", which is excluded from
+     * the payload. Bytes already searched are not scanned again when a frame
+     * arrives over several reads.
+     */
+    class DelimiterFramer
+    {
+    public:
+        static constexpr std::size_t MaxDelimiterLength = 16;
+
+        /**
+         * @param delimiter Between 1 and MaxDelimiterLength bytes, otherwise
+         * DelimiterFramerCreationFailure is thrown.
+         */
+        explicit DelimiterFramer(std::string_view delimiter);
+
+        FrameBoundaryResult Find(std::span<const std::byte> bytes, std::size_t maximumFrameSize);
+
+    private:
+        std::byte delimiter[MaxDelimiterLength];
+        std::size_t delimiterLength;
+        std::size_t searched = 0;
+    };
+
+    /**
+     * Splits the byte stream read from a socket, or anything else with a
+     * Read(std::span<std::byte>) returning SocketIOResult, into frames.
+     *
+     * Frames are views into the reader's receive storage, valid until the next
+     * Fill or PrepareWrite: read once, take every complete frame with Next, then
+     * read again. A frame split across reads stays buffered until its last byte
+     * arrives.
+     *
+     * @tparam TFramer LengthPrefixFramer, DelimiterFramer or any type with the
+     * same Find.
+     */
+    template <typename TFramer>
+    class FrameReader
+    {
+    public:
+        static constexpr std::size_t DefaultMaximumFrameSize = 1024 * 1024;
+        static constexpr std::size_t MinimumReadSize = 4096;
+
+        explicit FrameReader(TFramer framer, std::size_t maximumFrameSize = DefaultMaximumFrameSize)
+            : framer(std::move(framer)), maximumFrameSize(maximumFrameSize),
+              storage(maximumFrameSize + FramingOverhead + MinimumReadSize)
+        {
+        }
+
+        /**
+         * @brief Read once from source into the receive storage.
+         * @return The source's result; ENOBUFS if a frame over the maximum size is buffered.
+         */
+        template <typename TSource>
+        Detail::SocketIOResult Fill(TSource& source)
+        {
+            auto space = storage.PrepareWrite(MinimumReadSize);
+            if(space.empty())
+            {
+                return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{ENOBUFS});
+            }
+
+            auto read = source.Read(space);
+            if(read.HasResult()) storage.Commit(read.GetResult());
+            return read;
+        }
+
+        /**
+         * @brief Writable space for bytes received some other way, see Commit.
+         */
+        std::span<std::byte> PrepareWrite(std::size_t minimum = MinimumReadSize)
+        {
+            return storage.PrepareWrite(minimum);
+        }
+
+        void Commit(std::size_t count)
+        {
+            storage.Commit(count);
+        }
+
+        /**
+         * @return The payload of the next complete frame, FrameError::Incomplete
+         * when more bytes are needed. TooLarge and Malformed leave the stream
+         * unusable.
+         */
+        Utilities::Result<std::span<const std::byte>, FrameError> Next()
+        {
+            auto readable = storage.GetReadable();
+            auto boundary = framer.Find(readable, maximumFrameSize);
+            if(boundary.HasError()) return Utilities::MakeError(boundary.GetError());
+
+            auto& frame = boundary.GetResult();
+            storage.Consume(frame.frameLength);
+            return readable.subspan(frame.payloadOffset, frame.payloadLength);
+        }
+
+        /**
+         * @return The bytes buffered past the last complete frame.
+         */
+        std::size_t GetBufferedSize() const
+        {
+            return storage.GetReadable().size();
+        }
+
+    private:
+        static constexpr std::size_t FramingOverhead =
+            std::max(LengthPrefixFramer::MaxPrefixLength, DelimiterFramer::MaxDelimiterLength);
+
+        TFramer framer;
+        std::size_t maximumFrameSize;
+        Detail::FrameStorage storage;
+    };
+}
+
+#endif // EAGLE_NETWORK_FRAMING_HH
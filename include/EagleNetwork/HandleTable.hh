@@ -0,0 +1,166 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_HANDLE_TABLE_HH
+#define EAGLE_NETWORK_HANDLE_TABLE_HH
+
+#include <EagleNetwork/Result.hh>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Eagle::Core
+{
+    /**
+     * Reference to a slot of a HandleTable. The generation tells a handle to a
+     * closed connection apart from one to a later connection reusing its descriptor.
+     */
+    struct ConnectionHandle
+    {
+        static constexpr std::uint32_t InvalidIndex = UINT32_MAX;
+
+        std::uint32_t index{InvalidIndex};
+        std::uint32_t generation{0};
+
+        bool IsValid() const
+        {
+            return index != InvalidIndex;
+        }
+
+        /**
+         * @return The handle as a single word, e.g. for epoll_event::data.u64.
+         */
+        std::uint64_t Pack() const
+        {
+            return (static_cast<std::uint64_t>(generation) << 32) | index;
+        }
+
+        static ConnectionHandle Unpack(std::uint64_t value)
+        {
+            return {static_cast<std::uint32_t>(value), static_cast<std::uint32_t>(value >> 32)};
+        }
+
+        friend bool operator==(const ConnectionHandle&, const ConnectionHandle&) = default;
+    };
+
+    enum class HandleTableError
+    {
+        InvalidResource,
+        InUse
+    };
+
+    /**
+     * Per-connection state indexed by socket resource, stored as one array per field.
+     *
+     * A loop iteration touching only the interest mask or the queued byte count of
+     * many connections reads those fields back to back instead of loading one
+     * heap object per connection. Handles carry the slot's generation, which
+     * changes on every acquire and release, so Contains rejects a handle kept past
+     * the release of its slot.
+     *
+     * The field accessors don't check the handle, callers validate it once with
+     * Contains. Not thread safe.
+     */
+    class HandleTable
+    {
+    public:
+        /**
+         * @param resourceCapacity Resources below which no slot allocation happens.
+         */
+        explicit HandleTable(std::size_t resourceCapacity = 0);
+
+        /**
+         * @brief Take the slot of resource, with its fields reset.
+         *
+         * @return The handle or InUse when the slot wasn't released.
+         */
+        Utilities::Result<ConnectionHandle, HandleTableError> Acquire(int resource);
+
+        /**
+         * @return false if the handle is stale or invalid.
+         */
+        bool Release(ConnectionHandle handle);
+
+        /**
+         * @return true if the handle names a slot in use since it was acquired.
+         */
+        bool Contains(ConnectionHandle handle) const
+        {
+            // An even generation is a free slot, e.g. a fabricated {index, 0}.
+            return (handle.generation & 1) != 0 && handle.index < generations.size() &&
+                generations[handle.index] == handle.generation;
+        }
+
+        /**
+         * @return The current handle of resource, an invalid handle when it has none.
+         */
+        ConnectionHandle Find(int resource) const;
+
+        std::uint8_t& GetState(ConnectionHandle handle)
+        {
+            return states[handle.index];
+        }
+
+        std::uint32_t& GetInterest(ConnectionHandle handle)
+        {
+            return interests[handle.index];
+        }
+
+        /**
+         * Bytes queued for the connection, kept up to date by its OutboundQueue.
+         */
+        std::size_t& GetOutboundBytes(ConnectionHandle handle)
+        {
+            return outboundBytes[handle.index];
+        }
+
+        /**
+         * Cold per-connection pointer, e.g. the owning connection object.
+         */
+        void*& GetContext(ConnectionHandle handle)
+        {
+            return contexts[handle.index];
+        }
+
+        std::size_t GetCount() const;
+
+        /**
+         * @return The number of slots, one past the largest resource acquired so far.
+         */
+        std::size_t GetCapacity() const;
+
+    private:
+        void Grow(std::size_t size);
+
+        /**
+         * Odd while the slot is in use, even while it is free.
+         */
+        std::vector<std::uint32_t> generations;
+        std::vector<std::uint8_t> states;
+        std::vector<std::uint32_t> interests;
+        std::vector<std::size_t> outboundBytes;
+        std::vector<void*> contexts;
+        std::size_t count{0};
+    };
+}
+
+#endif
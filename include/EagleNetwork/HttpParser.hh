@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_HTTP_PARSER_HH
+#define EAGLE_NETWORK_HTTP_PARSER_HH
+
+#include <EagleNetwork/Result.hh>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace Eagle::Core
+{
+    enum class HttpParseError
+    {
+        /**
+         * The buffer ends before the end of the header block or chunk, read more and parse again.
+         */
+        Incomplete,
+        Malformed,
+        /**
+         * The message has more header fields than the span given to the parser.
+         */
+        TooManyHeaders,
+        /**
+         * A length doesn't fit in 64 bits.
+         */
+        TooLarge
+    };
+
+    struct HttpHeader
+    {
+        std::string_view name;
+        /**
+         * The field value without surrounding whitespace.
+         */
+        std::string_view value;
+
+        /**
+         * @return true if the field name is name, ignoring ASCII case.
+         */
+        bool NameEquals(std::string_view name) const noexcept;
+    };
+
+    /**
+     * A parsed request head; the views point into the parsed buffer.
+     */
+    struct HttpRequest
+    {
+        std::string_view method;
+        std::string_view target;
+        int minorVersion;
+        std::span<HttpHeader> headers;
+        /**
+         * Bytes of the request line and header fields including the empty line,
+         * the body or the next pipelined request starts there.
+         */
+        std::size_t headLength;
+    };
+
+    struct HttpResponse
+    {
+        int minorVersion;
+        int status;
+        std::string_view reason;
+        std::span<HttpHeader> headers;
+        std::size_t headLength;
+    };
+
+    /**
+     * How the body following a message head is delimited.
+     */
+    struct HttpBody
+    {
+        enum class Kind
+        {
+            None,
+            ContentLength,
+            Chunked,
+            /**
+             * A response without length, the body runs until the connection closes.
+             */
+            UntilClose
+        };
+
+        Kind kind;
+        std::uint64_t length;
+    };
+
+    /**
+     * Incremental, allocation-free HTTP/1.1 message head parser working in
+     * place on receive buffers.
+     *
+     * A head is only parsed once the whole header block is buffered, found with
+     * the vectorised Detail::FindDelimiter; passing back the length already
+     * searched keeps repeated attempts on a growing buffer linear. Field values
+     * and request targets are scanned 32 (AVX2) or 16 (SSE4.2) bytes at a time
+     * when the CPU supports it. Pipelined requests are parsed one after the
+     * other from headLength plus the body length.
+     */
+    class HttpParser
+    {
+    public:
+        /**
+         * @param headers Storage for the header fields, the result's headers is a prefix of it.
+         * @param searchedLength Length of buffer on a previous Incomplete attempt, 0 otherwise.
+         */
+        static Utilities::Result<HttpRequest, HttpParseError> ParseRequest(std::string_view buffer,
+            std::span<HttpHeader> headers, std::size_t searchedLength = 0);
+
+        static Utilities::Result<HttpResponse, HttpParseError> ParseResponse(std::string_view buffer,
+            std::span<HttpHeader> headers, std::size_t searchedLength = 0);
+
+        /**
+         * @brief Determine the request body framing from Transfer-Encoding and Content-Length.
+         *
+         * Messages with both, or with conflicting lengths, are Malformed so a
+         * proxy and its backend can't disagree on where a request ends.
+         */
+        static Utilities::Result<HttpBody, HttpParseError> GetRequestBody(const HttpRequest& request);
+
+        /**
+         * @param requestMethod Method of the request answered, HEAD responses have no body.
+         */
+        static Utilities::Result<HttpBody, HttpParseError> GetResponseBody(const HttpResponse& response,
+            std::string_view requestMethod = "GET");
+    };
+
+    /**
+     * In-place decoder of a chunked transfer coding.
+     *
+     * Decode moves the chunk data of buffer to its front and reports how much
+     * of buffer it used. Before the end the whole buffer is used: keep the
+     * decoded bytes and call again with the following ones. At the end,
+     * anything past the consumed bytes belongs to the next message.
+     */
+    class HttpChunkedDecoder
+    {
+    public:
+        struct Progress
+        {
+            std::size_t decoded;
+            std::size_t consumed;
+            bool complete;
+        };
+
+        Utilities::Result<Progress, HttpParseError> Decode(std::span<char> buffer);
+
+        bool IsComplete() const noexcept;
+
+    private:
+        enum class State : std::uint8_t
+        {
+            Size,
+            Extension,
+            SizeLineFeed,
+            Data,
+            DataCarriageReturn,
+            DataLineFeed,
+            TrailerLineStart,
+            TrailerLine,
+            TrailerLineEnd,
+            TrailerLineFeed,
+            Complete
+        };
+
+        State state = State::Size;
+        bool hasSizeDigit = false;
+        std::uint64_t remaining = 0;
+    };
+}
+
+#endif // EAGLE_NETWORK_HTTP_PARSER_HH
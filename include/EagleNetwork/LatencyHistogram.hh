@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_LATENCY_HISTOGRAM_HH
+#define EAGLE_NETWORK_LATENCY_HISTOGRAM_HH
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Eagle::Core
+{
+    /**
+     * Fixed size log-linear histogram of durations in nanoseconds.
+     *
+     * Each power of two range is split into 64 linear buckets, like HdrHistogram
+     * with two significant digits, so any recorded value is reported within
+     * 1.6%. Values up to about 18 minutes are tracked, larger ones land in the
+     * last bucket. Recording is a relaxed atomic increment, several threads may
+     * record into the same histogram, per-thread histograms avoid the contention
+     * and are combined with Merge.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr std::size_t SubBucketBits = 6;
+        static constexpr std::size_t SubBucketCount = std::size_t{1} << SubBucketBits;
+        static constexpr std::size_t MaxValueBits = 40;
+        static constexpr std::size_t BucketCount = SubBucketCount * (MaxValueBits - SubBucketBits + 1);
+
+        LatencyHistogram() = default;
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void Record(std::uint64_t nanoseconds) noexcept
+        {
+            buckets[GetBucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+            count.fetch_add(1, std::memory_order_relaxed);
+            sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+            auto currentMax = max.load(std::memory_order_relaxed);
+            while(nanoseconds > currentMax
+                && !max.compare_exchange_weak(currentMax, nanoseconds, std::memory_order_relaxed)) {}
+        }
+
+        void Record(std::chrono::nanoseconds duration) noexcept
+        {
+            Record(duration.count() > 0 ? static_cast<std::uint64_t>(duration.count()) : 0);
+        }
+
+        /**
+         * @brief Add the counts of other to this histogram.
+         */
+        void Merge(const LatencyHistogram& other);
+
+        /**
+         * @brief Move the counts recorded so far into interval and start over.
+         *
+         * Values recorded concurrently end up either in interval or in the next one.
+         */
+        void TakeInterval(LatencyHistogram& interval);
+
+        void Reset();
+
+        std::uint64_t GetCount() const;
+        std::uint64_t GetMax() const;
+        double GetMean() const;
+
+        /**
+         * @param percentile In [0, 100], e.g. 99.9.
+         * @return The value below which the given percentage of the recorded
+         * values fall, 0 when the histogram is empty.
+         */
+        std::uint64_t GetValueAtPercentile(double percentile) const;
+
+        static constexpr std::size_t GetBucketIndex(std::uint64_t value)
+        {
+            if(value < SubBucketCount)
+            {
+                return static_cast<std::size_t>(value);
+            }
+
+            auto exponent = static_cast<std::size_t>(std::bit_width(value)) - 1;
+            if(exponent >= MaxValueBits)
+            {
+                return BucketCount - 1;
+            }
+            auto shift = exponent - SubBucketBits;
+            return SubBucketCount * (shift + 1) + static_cast<std::size_t>((value >> shift) & (SubBucketCount - 1));
+        }
+
+        /**
+         * @return The highest value falling in the bucket.
+         */
+        static constexpr std::uint64_t GetBucketUpperBound(std::size_t index)
+        {
+            if(index < SubBucketCount)
+            {
+                return index;
+            }
+
+            auto shift = index / SubBucketCount - 1;
+            auto subBucket = SubBucketCount + index % SubBucketCount;
+            return ((static_cast<std::uint64_t>(subBucket) + 1) << shift) - 1;
+        }
+
+    private:
+        std::array<std::atomic<std::uint64_t>, BucketCount> buckets{};
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> sum{0};
+        std::atomic<std::uint64_t> max{0};
+    };
+
+    /**
+     * Latencies of the system calls of a class of sockets, e.g. every upstream
+     * connection. Attached with BasicSocket::SetLatencyHistograms.
+     */
+    struct IoLatencyHistograms
+    {
+        LatencyHistogram read;
+        LatencyHistogram write;
+        LatencyHistogram connect;
+        LatencyHistogram accept;
+    };
+}
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_MAILBOX_HH
+#define EAGLE_NETWORK_MAILBOX_HH
+
+#include <EagleNetwork/EventNotifier.hh>
+#include <EagleNetwork/MpscQueue.hh>
+#include <EagleNetwork/Reactor.hh>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if !defined (__linux__)
+#error "Mailbox requires the epoll Reactor and is only available on Linux."
+#endif
+
+namespace Eagle::Core
+{
+    class MailboxRegistrationFailure : public std::runtime_error
+    {
+    public:
+        MailboxRegistrationFailure()
+            : runtime_error("Mailbox: can't register the notifier in the reactor.") {}
+    };
+
+    /**
+     * Queue of values handed to an event loop by other threads, e.g. accepted
+     * sockets from an acceptor thread or writes posted by another loop.
+     *
+     * Producers push into a BoundedMpscQueue and signal an EventNotifier without
+     * taking any lock, the loop wakes once per burst and hands the values to the
+     * handler in batches.
+     */
+    template <typename T>
+    class Mailbox final : private IReactorHandler
+    {
+    public:
+        using BatchHandler = std::function<void(std::span<T> batch)>;
+
+        /**
+         * @throws MailboxRegistrationFailure if the notifier can't be registered.
+         */
+        Mailbox(Reactor& reactor, std::size_t capacity, BatchHandler handler, std::size_t batchSize = 64)
+            : reactor(reactor), queue(capacity), handler(std::move(handler)), batch(batchSize ? batchSize : 1)
+        {
+            if(!reactor.Register(notifier.GetSocket(), *this, ReactorEvent::Read))
+            {
+                throw MailboxRegistrationFailure();
+            }
+        }
+
+        ~Mailbox() override
+        {
+            reactor.Unregister(notifier.GetSocket());
+        }
+
+        Mailbox(const Mailbox&) = delete;
+        Mailbox& operator=(const Mailbox&) = delete;
+
+        /**
+         * @brief Hand a value to the loop, callable from any thread.
+         * @return false if the mailbox is full.
+         */
+        template <typename U = T>
+        bool Post(U&& value)
+        {
+            if(!queue.TryPush(std::forward<U>(value)))
+            {
+                return false;
+            }
+            notifier.Notify();
+            return true;
+        }
+
+        /**
+         * @brief Deliver the queued values now, loop thread only.
+         * @return The number of delivered values.
+         */
+        std::size_t Drain()
+        {
+            notifier.Consume();
+
+            std::size_t total = 0;
+            while(auto count = queue.PopBatch(batch))
+            {
+                handler(std::span<T>(batch.data(), count));
+                total += count;
+            }
+            return total;
+        }
+
+    private:
+        void OnReadable(BasicSocket&) override
+        {
+            Drain();
+        }
+
+        Reactor& reactor;
+        EventNotifier notifier;
+        BoundedMpscQueue<T> queue;
+        BatchHandler handler;
+        std::vector<T> batch;
+    };
+}
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_METRICS_HH
+#define EAGLE_NETWORK_METRICS_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+namespace Eagle::Core
+{
+    /**
+     * Library wide counters. Gauges such as SocketQueuedWriteBytes go up and down
+     * and may be updated from different threads, their sum is still exact.
+     */
+    enum class Metric : std::size_t
+    {
+        SocketBytesRead,
+        SocketBytesWritten,
+        SocketSyscalls,
+        SocketWouldBlock,
+        SocketPartialWrites,
+        SocketQueuedWriteBytes,
+        LoopIterations,
+        LoopEventsDispatched,
+        LoopBusyNanoseconds,
+        Count
+    };
+
+    inline constexpr std::size_t MetricCount = static_cast<std::size_t>(Metric::Count);
+
+    struct MetricsSnapshot
+    {
+        std::array<std::uint64_t, MetricCount> values{};
+
+        std::uint64_t Get(Metric metric) const
+        {
+            return values[static_cast<std::size_t>(metric)];
+        }
+    };
+
+    namespace Detail
+    {
+        /**
+         * Counters written by a single thread, read by snapshots.
+         */
+        struct alignas(CacheLineSize) MetricsSlot
+        {
+            std::array<std::atomic<std::uint64_t>, MetricCount> values{};
+        };
+
+        MetricsSlot* RegisterMetricsSlot();
+
+        inline thread_local MetricsSlot* threadMetricsSlot = nullptr;
+    }
+
+    /**
+     * Process wide metrics stored in per-thread slots.
+     *
+     * Updating a counter is a relaxed load and store on the calling thread's own
+     * cache line, no atomic read-modify-write nor sharing happens until a
+     * snapshot sums the slots. Building with EAGLE_NET_DISABLE_METRICS turns
+     * every update into a no-op.
+     */
+    class Metrics
+    {
+    public:
+        static void Add(Metric metric, std::uint64_t value = 1) noexcept
+        {
+#if !defined (EAGLE_NET_DISABLE_METRICS)
+            auto* slot = Detail::threadMetricsSlot;
+            if(!slot) [[unlikely]]
+            {
+                slot = Detail::threadMetricsSlot = Detail::RegisterMetricsSlot();
+            }
+            auto& counter = slot->values[static_cast<std::size_t>(metric)];
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+#else
+            (void)metric;
+            (void)value;
+#endif
+        }
+
+        static void Subtract(Metric metric, std::uint64_t value) noexcept
+        {
+            // Wraps around, summing the slots wraps back.
+            Add(metric, ~value + 1);
+        }
+
+        /**
+         * @brief Count a failed system call that would have blocked, reads errno.
+         */
+        static void RecordFailure() noexcept
+        {
+            if(errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                Add(Metric::SocketWouldBlock);
+            }
+        }
+
+        /**
+         * @brief Count a receiving system call and the bytes it returned, -1 on failure.
+         */
+        static void RecordRead(ssize_t received) noexcept
+        {
+            Add(Metric::SocketSyscalls);
+            if(received > 0)
+            {
+                Add(Metric::SocketBytesRead, static_cast<std::uint64_t>(received));
+            } else if(received == -1) {
+                RecordFailure();
+            }
+        }
+
+        /**
+         * @brief Count a sending system call, a short transfer counts as a partial write.
+         */
+        static void RecordWrite(ssize_t sent, std::size_t requested) noexcept
+        {
+            Add(Metric::SocketSyscalls);
+            if(sent == -1)
+            {
+                RecordFailure();
+                return;
+            }
+
+            Add(Metric::SocketBytesWritten, static_cast<std::uint64_t>(sent));
+            if(static_cast<std::size_t>(sent) < requested)
+            {
+                Add(Metric::SocketPartialWrites);
+            }
+        }
+
+        /**
+         * @return The sum of every thread's counters, including exited threads.
+         */
+        static MetricsSnapshot Snapshot();
+
+        static std::string_view GetName(Metric metric);
+
+        /**
+         * @brief Format a snapshot in the Prometheus text exposition format.
+         */
+        static std::string FormatPrometheus(const MetricsSnapshot& snapshot);
+    };
+}
+
+#endif
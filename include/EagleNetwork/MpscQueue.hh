@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_MPSC_QUEUE_HH
+#define EAGLE_NETWORK_MPSC_QUEUE_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace Eagle::Core
+{
+    /**
+     * Bounded lock-free multi-producer single-consumer queue.
+     *
+     * Every cell carries a sequence number telling producers and the consumer
+     * whose turn it is (Vyukov's bounded queue), producers only contend on the
+     * enqueue counter and never block. The counters and cells sit on their own
+     * cache lines so producers and the consumer don't invalidate each other.
+     */
+    template <typename T>
+    class BoundedMpscQueue
+    {
+        static_assert(std::is_nothrow_move_constructible_v<T>, "BoundedMpscQueue moves values in and out of its cells.");
+
+        struct alignas(Detail::CacheLineSize) Cell
+        {
+            std::atomic<std::size_t> sequence;
+            alignas(T) std::byte storage[sizeof(T)];
+
+            T* GetValue()
+            {
+                return std::launder(reinterpret_cast<T*>(storage));
+            }
+        };
+
+    public:
+        /**
+         * @param capacity Rounded up to a power of two.
+         */
+        explicit BoundedMpscQueue(std::size_t capacity)
+            : mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+              cells(std::make_unique<Cell[]>(mask + 1))
+        {
+            for(std::size_t i = 0; i <= mask; ++i)
+            {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~BoundedMpscQueue()
+        {
+            while(true)
+            {
+                auto& cell = cells[dequeuePosition & mask];
+                if(cell.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) break;
+                cell.GetValue()->~T();
+                ++dequeuePosition;
+            }
+        }
+
+        BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+        BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+        /**
+         * @brief Enqueue a value, callable from any thread.
+         * @return false if the queue is full, value is then left untouched.
+         */
+        template <typename U = T>
+        bool TryPush(U&& value)
+        {
+            auto position = enqueuePosition.load(std::memory_order_relaxed);
+            Cell* cell;
+            while(true)
+            {
+                cell = &cells[position & mask];
+                auto sequence = cell->sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+                if(difference == 0)
+                {
+                    if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                } else if(difference < 0) {
+                    return false;
+                } else {
+                    position = enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            ::new(cell->storage) T(std::forward<U>(value));
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Dequeue the oldest value, consumer thread only.
+         */
+        bool TryPop(T& value)
+        {
+            auto& cell = cells[dequeuePosition & mask];
+            if(cell.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+            {
+                return false;
+            }
+
+            value = std::move(*cell.GetValue());
+            cell.GetValue()->~T();
+            cell.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+            ++dequeuePosition;
+            return true;
+        }
+
+        /**
+         * @brief Dequeue up to batch.size() values, consumer thread only.
+         * @return The number of values stored at the front of batch.
+         */
+        std::size_t PopBatch(std::span<T> batch)
+        {
+            std::size_t count = 0;
+            while(count < batch.size() && TryPop(batch[count]))
+            {
+                ++count;
+            }
+            return count;
+        }
+
+        /**
+         * @return The number of queued values, consumer thread only and
+         * approximate while producers are pushing.
+         */
+        std::size_t Size() const
+        {
+            auto enqueued = enqueuePosition.load(std::memory_order_relaxed);
+            return enqueued > dequeuePosition ? enqueued - dequeuePosition : 0;
+        }
+
+        std::size_t Capacity() const
+        {
+            return mask + 1;
+        }
+
+    private:
+        const std::size_t mask;
+        std::unique_ptr<Cell[]> cells;
+        alignas(Detail::CacheLineSize) std::atomic<std::size_t> enqueuePosition{0};
+        alignas(Detail::CacheLineSize) std::size_t dequeuePosition{0};
+    };
+}
+
+#endif
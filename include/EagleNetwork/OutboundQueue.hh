@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_OUTBOUND_QUEUE_HH
+#define EAGLE_NETWORK_OUTBOUND_QUEUE_HH
+
+#include <EagleNetwork/Buffer.hh>
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/Socket.hh>
+#include <cstddef>
+#include <span>
+
+namespace Eagle::Core
+{
+    class OutboundQueue;
+
+    /**
+     * Backpressure notifications of an OutboundQueue.
+     */
+    struct IOutboundQueueHandler
+    {
+    protected:
+        virtual ~IOutboundQueueHandler() = default;
+
+    public:
+        IOutboundQueueHandler() = default;
+
+        /**
+         * @brief The unsent bytes reached the high watermark, producers should pause.
+         */
+        virtual void OnHighWatermark(OutboundQueue&) {}
+
+        /**
+         * @brief The unsent bytes drained to the low watermark after a high one.
+         */
+        virtual void OnLowWatermark(OutboundQueue&) {}
+
+        /**
+         * @brief Writing failed, the queued bytes were dropped and the queue refuses new ones.
+         */
+        virtual void OnWriteError(OutboundQueue&, Detail::SocketPlatformErrorType::Type) {}
+    };
+
+    struct OutboundQueueOptions
+    {
+        std::size_t highWatermark = 1024 * 1024;
+        std::size_t lowWatermark = 256 * 1024;
+    };
+
+    /**
+     * Per-socket queue of outgoing bytes flushed once per Reactor iteration.
+     *
+     * Enqueue only appends to a ChainedBuffer, so small writes issued while
+     * handling one iteration's events share slabs and leave in a single
+     * gathered sendmsg at the end of the iteration instead of one syscall and
+     * one packet each. A flush needing several sendmsg calls passes MSG_MORE on
+     * all but the last so they still fill whole segments.
+     *
+     * Whatever the socket doesn't take stays queued until it is writable: the
+     * socket must be non-blocking, registered in the reactor with ReactorEvent::Write and its
+     * handler must forward OnWritable to the queue. Queued bytes are reported by
+     * the SocketQueuedWriteBytes gauge and, while the socket is registered, in
+     * the outbound bytes column of the reactor's HandleTable. Crossing the
+     * watermarks is reported to the IOutboundQueueHandler so producers pause
+     * instead of queueing without limit. Enqueueing past the high watermark
+     * still succeeds.
+     */
+    class OutboundQueue final : private IReactorDeferred
+    {
+    public:
+        /**
+         * Neither the reactor, the socket nor the handler are owned, they must
+         * outlive the queue.
+         */
+        OutboundQueue(Reactor& reactor, BasicSocket& socket, IOutboundQueueHandler* handler = nullptr,
+            const OutboundQueueOptions& options = {});
+        ~OutboundQueue();
+
+        OutboundQueue(const OutboundQueue&) = delete;
+        OutboundQueue& operator=(const OutboundQueue&) = delete;
+
+        /**
+         * @brief Queue a copy of bytes for the end of the iteration.
+         * @return false once a write failed.
+         */
+        bool Enqueue(std::span<const std::byte> bytes);
+
+        /**
+         * @brief Queue the bytes of buffer, sharing its slabs.
+         */
+        bool Enqueue(const ChainedBuffer& buffer);
+
+        /**
+         * @brief Write the queued bytes now rather than at the end of the iteration.
+         * @return The number of bytes written, or the platform error that closed the queue.
+         */
+        Detail::SocketIOResult Flush();
+
+        /**
+         * @brief Resume writing, to be called from the socket handler's OnWritable.
+         */
+        void OnWritable();
+
+        std::size_t GetQueuedBytes() const;
+        bool IsAboveHighWatermark() const;
+
+    private:
+        void OnDeferred(Reactor& reactor) override;
+        void ScheduleFlush();
+        void PublishQueued(std::size_t queued);
+        void UpdateQueued(std::size_t queued);
+
+        Reactor& reactor;
+        BasicSocket& socket;
+        IOutboundQueueHandler* handler;
+        OutboundQueueOptions options;
+        ChainedBuffer pending;
+        bool flushScheduled = false;
+        bool waitingWritable = false;
+        bool aboveHighWatermark = false;
+        bool failed = false;
+    };
+}
+
+#endif // EAGLE_NETWORK_OUTBOUND_QUEUE_HH
@@ -25,6 +25,8 @@
 
 #include <EagleNetwork/Utilities.hh>
 #include <EagleNetwork/Result.hh>
+#include <cstddef>
+#include <span>
 #include <type_traits>
 #include <vector>
 
@@ -58,17 +60,69 @@ namespace Eagle::Core {
         {};
         struct SocketResourceReleaserType : Utilities::ResourceReleaser<void(SocketResourceType::ResourceType)> {};
         using SocketInitResult = Utilities::Result<SocketResourceType::ResourceType, SocketPlatformErrorType::Type>;
+        using SocketIOResult = Utilities::Result<std::size_t, SocketPlatformErrorType::Type>;
+        using SocketStatusResult = Utilities::Result<void, SocketPlatformErrorType::Type>;
+        /**
+         * Options applied while the socket is created, before it is handed out.
+         * Zero values leave the system default. Accepted sockets inherit them from
+         * the listener except the non-blocking mode, which Accept sets.
+         */
+        struct SocketOptions
+        {
+            /**
+             * Passed as SOCK_NONBLOCK and SOCK_CLOEXEC to socket() where supported.
+             */
+            bool nonBlocking{false};
+            bool closeOnExec{false};
+            /**
+             * TCP_NODELAY, disable Nagle's algorithm.
+             */
+            bool noDelay{false};
+            /**
+             * TCP_QUICKACK, acknowledge immediately rather than delaying ACKs.
+             */
+            bool quickAck{false};
+            /**
+             * TCP_FASTOPEN queue length on a listener.
+             */
+            int fastOpenQueueLength{0};
+            /**
+             * TCP_FASTOPEN_CONNECT, send data with the SYN on the client side.
+             */
+            bool fastOpenConnect{false};
+            /**
+             * SO_BUSY_POLL, microseconds to busy poll the device queue on reads.
+             */
+            int busyPollMicroseconds{0};
+            int sendBufferSize{0};
+            int receiveBufferSize{0};
+            /**
+             * SO_INCOMING_CPU, CPU whose connections a SO_REUSEPORT listener prefers, -1 for none.
+             */
+            int incomingCpu{-1};
+            /**
+             * TCP_NOTSENT_LOWAT, unsent bytes above which the socket stops being writable.
+             */
+            int notSentLowWatermark{0};
+        };
+
         struct SocketResourceDependencies
         {
             int domain;
             int type;
             int protocol;
+            SocketOptions options{};
         };
 #elif defined (__WIN32__) || defined (__WIN64__)
         // TODO: Window platform definitions needed.
 #else
 #error "Current platform is not supported by EagleNetwork library."
 #endif
+        /**
+         * Alignment keeping data written by different threads on distinct cache lines.
+         */
+        inline constexpr std::size_t CacheLineSize = 64;
+
         namespace IO
         {
             template <typename OperationSigniture, typename OperationDependencies>
@@ -102,6 +156,19 @@ namespace Eagle::Core {
                 IOSocketOperation<BufferType> operationBuffer;
                 std::size_t size;
             };
+
+            /**
+             * Multi-message variant of IOSocketOperationDep, each operation buffer
+             * holds one datagram of at most size bytes.
+             */
+            template <template <typename> typename IOSocketOperation, typename BufferType>
+                requires(!std::is_class_v<BufferType>)
+            struct IOSocketMultiOperationDep
+            {
+                SocketResourceType::ResourceType resource;
+                std::span<IOSocketOperation<BufferType>> operationBuffers;
+                std::size_t size;
+            };
 #if defined (__unix__) || defined (__MACH__)
             struct IOSocketOperationResult : Utilities::TypeWrapper<int> {};
 #elif defined (__WIN32__) || defined (__WIN64__)
@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_POOL_ALLOCATOR_HH
+#define EAGLE_NETWORK_POOL_ALLOCATOR_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace Eagle::Core
+{
+    struct PoolAllocatorOptions
+    {
+        /**
+         * Size of the memory chunks blocks are carved from, rounded up to a
+         * multiple of the largest size class and at most ChunkAlignment.
+         */
+        std::size_t chunkSize{2 * 1024 * 1024};
+        /**
+         * Back the chunks with huge pages, falling back to regular pages when the
+         * system has none reserved.
+         */
+        bool useHugePages{false};
+    };
+
+    struct PoolAllocatorStatistics
+    {
+        /**
+         * Allocations served from a free list.
+         */
+        std::size_t hits{0};
+        /**
+         * Allocations that had to carve a new block or were too large for the pool.
+         */
+        std::size_t misses{0};
+        /**
+         * Bytes currently handed out by the pool.
+         */
+        std::size_t bytesInUse{0};
+        /**
+         * Maximum value reached by bytesInUse.
+         */
+        std::size_t highWaterMark{0};
+        /**
+         * Bytes of chunk memory reserved by the pool.
+         */
+        std::size_t chunkBytes{0};
+    };
+
+    /**
+     * Allocator of fixed size class blocks kept on per class free lists.
+     *
+     * A pool is not thread safe, each thread uses its own through ForCurrentThread.
+     * Blocks may be released on another thread than the one that allocated them:
+     * every chunk is aligned to ChunkAlignment and starts with its owner, so a
+     * foreign block is pushed on the owner's lock-free return list, which the
+     * owner drains when a free list runs dry.
+     *
+     * A per-thread pool is retired when its thread exits and freed with its
+     * chunks once the last outstanding block comes back.
+     */
+    class PoolAllocator
+    {
+    public:
+        static constexpr std::array<std::size_t, 11> SizeClasses{
+            64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536
+        };
+
+        static constexpr std::size_t ChunkAlignment = 2 * 1024 * 1024;
+
+        explicit PoolAllocator(const PoolAllocatorOptions& options = {});
+        ~PoolAllocator();
+
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+        PoolAllocator(PoolAllocator&&) = delete;
+        PoolAllocator& operator=(PoolAllocator&&) = delete;
+
+        /**
+         * @brief Allocate size bytes, aligned for any fundamental type.
+         *
+         * Sizes larger than the largest class are forwarded to operator new.
+         */
+        void* Allocate(std::size_t size);
+
+        /**
+         * @brief Release a block, size must be the one given to Allocate.
+         *
+         * The block may come from any pool, it is handed back to its owner.
+         */
+        void Deallocate(void* pointer, std::size_t size) noexcept;
+
+        PoolAllocatorStatistics GetStatistics() const;
+
+        /**
+         * @return The pool of the calling thread.
+         */
+        static PoolAllocator& ForCurrentThread();
+
+        /**
+         * @brief Set the options of the per-thread pools created afterwards.
+         */
+        static void SetThreadPoolOptions(const PoolAllocatorOptions& options);
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* next;
+            std::size_t sizeClass;
+        };
+
+        std::byte* CarveBlock(std::size_t blockSize);
+        void ReturnBlock(FreeBlock* block) noexcept;
+        bool DrainReturnedBlocks() noexcept;
+        void Retire() noexcept;
+
+        static FreeBlock* const RetiredMarker;
+        static std::size_t GetSizeClass(std::size_t size);
+
+        PoolAllocatorOptions options;
+        std::array<FreeBlock*, SizeClasses.size()> freeLists{};
+        std::vector<std::pair<void*, std::size_t>> chunks;
+        std::byte* chunkCursor{nullptr};
+        std::byte* chunkEnd{nullptr};
+        std::size_t blocksInUse{0};
+        PoolAllocatorStatistics statistics;
+
+        /**
+         * Blocks released by other threads, or RetiredMarker once the owning
+         * thread exited.
+         */
+        alignas(Detail::CacheLineSize) std::atomic<FreeBlock*> returnedBlocks{nullptr};
+        /**
+         * Blocks still out once retired, the thread bringing it to zero frees the pool.
+         */
+        std::atomic<std::ptrdiff_t> retiredBlocks{0};
+    };
+
+    /**
+     * Standard allocator drawing from the calling thread's PoolAllocator.
+     */
+    template <typename T>
+    struct PoolAllocatorAdapter
+    {
+        using value_type = T;
+
+        PoolAllocatorAdapter() noexcept = default;
+        template <typename U>
+        PoolAllocatorAdapter(const PoolAllocatorAdapter<U>&) noexcept {}
+
+        T* allocate(std::size_t count)
+        {
+            return static_cast<T*>(PoolAllocator::ForCurrentThread().Allocate(count * sizeof(T)));
+        }
+
+        void deallocate(T* pointer, std::size_t count) noexcept
+        {
+            PoolAllocator::ForCurrentThread().Deallocate(pointer, count * sizeof(T));
+        }
+
+        template <typename U>
+        bool operator==(const PoolAllocatorAdapter<U>&) const noexcept
+        {
+            return true;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_REACTOR_HH
+#define EAGLE_NETWORK_REACTOR_HH
+
+#include <EagleNetwork/HandleTable.hh>
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Socket.hh>
+#include <EagleNetwork/TimerWheel.hh>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#if !defined (__linux__)
+#error "Reactor requires epoll and is only available on Linux."
+#endif
+
+namespace Eagle::Core
+{
+    class ReactorCreationFailure : public std::runtime_error
+    {
+    public:
+        ReactorCreationFailure()
+            : runtime_error("Reactor: can't create the event polling resource.") {}
+    };
+
+    /**
+     * Readiness events a socket can be registered for, combined as a bit mask.
+     * Errors are always reported whatever the registered interest is.
+     */
+    struct ReactorEvent
+    {
+        using Type = std::uint32_t;
+
+        static constexpr Type None = 0;
+        static constexpr Type Read = 1 << 0;
+        static constexpr Type Write = 1 << 1;
+    };
+
+    /**
+     * Readiness callbacks of a socket registered in a Reactor.
+     *
+     * The reactor is edge-triggered: a callback is only invoked again once new
+     * readiness arrives, so handlers must read or write until the operation
+     * reports EAGAIN.
+     *
+     * A hang-up is reported to OnReadable with Read interest, otherwise to
+     * OnWritable with Write interest, and to OnError with EPIPE without either.
+     */
+    struct IReactorHandler
+    {
+    protected:
+        virtual ~IReactorHandler() = default;
+
+    public:
+        IReactorHandler() = default;
+        virtual void OnReadable(BasicSocket& socket) = 0;
+        virtual void OnWritable(BasicSocket&) {}
+        virtual void OnError(BasicSocket&, Detail::SocketPlatformErrorType::Type) {}
+    };
+
+    class Reactor;
+
+    /**
+     * Work run once at the end of a Reactor iteration, after the socket events
+     * and timers of that iteration were dispatched.
+     */
+    struct IReactorDeferred
+    {
+    protected:
+        virtual ~IReactorDeferred() = default;
+
+    public:
+        IReactorDeferred() = default;
+
+        virtual void OnDeferred(Reactor& reactor) = 0;
+    };
+
+    /**
+     * Single threaded, edge-triggered epoll event loop dispatching readiness of
+     * registered BasicSocket instances to their IReactorHandler.
+     *
+     * Registrations are stored in a HandleTable indexed by the socket resource and
+     * the event buffer is allocated once, so dispatching performs no allocation.
+     * Each event carries the handle of its registration, events still queued for
+     * a socket unregistered earlier in the same batch are dropped.
+     * Neither the socket nor the handler are owned by the reactor, both must stay
+     * alive until the socket is unregistered.
+     */
+    class Reactor
+    {
+    public:
+        /**
+         * @param maxEventsPerPoll Maximum number of events collected by one poll.
+         */
+        explicit Reactor(std::size_t maxEventsPerPoll = 1024);
+        ~Reactor();
+
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+        Reactor(Reactor&&) = delete;
+        Reactor& operator=(Reactor&&) = delete;
+
+        /**
+         * @brief Start watching the socket for the given readiness events.
+         *
+         * @return true on success, false if the socket is invalid or already registered.
+         */
+        bool Register(BasicSocket& socket, IReactorHandler& handler, ReactorEvent::Type interest);
+
+        /**
+         * @brief Change the readiness events a registered socket is watched for.
+         */
+        bool Modify(BasicSocket& socket, ReactorEvent::Type interest);
+
+        /**
+         * @brief Stop watching the socket, must be called before closing it.
+         */
+        bool Unregister(BasicSocket& socket);
+
+        /**
+         * @brief Wait for readiness and dispatch it to the handlers.
+         *
+         * @param timeoutMilliseconds Maximum time to wait, -1 to wait indefinitely.
+         * @return The number of dispatched socket events or the platform error.
+         */
+        Detail::SocketIOResult RunOnce(int timeoutMilliseconds);
+
+        /**
+         * @brief Dispatch events until Stop is called from a handler.
+         */
+        void Run();
+
+        /**
+         * @brief Make Run return after the current iteration.
+         */
+        void Stop();
+
+        /**
+         * @brief Drive a timer wheel from this loop, nullptr to detach it.
+         *
+         * RunOnce then never waits past the wheel's next expiry and advances the
+         * wheel after dispatching the socket events. The wheel is not owned.
+         */
+        void SetTimerWheel(TimerWheel* wheel);
+
+        /**
+         * @brief Run deferred at the end of the current iteration, or of the next
+         * one when called outside RunOnce, which then doesn't wait for events.
+         *
+         * Each call schedules one run, callers track whether they are pending.
+         * Work deferred from OnDeferred runs in the following iteration.
+         */
+        void Defer(IReactorDeferred& deferred);
+
+        /**
+         * @brief Drop the pending runs of deferred, e.g. before destroying it.
+         */
+        void CancelDeferred(IReactorDeferred& deferred);
+
+        std::size_t GetRegisteredCount() const;
+
+        /**
+         * @return The handle of a registered socket, an invalid handle otherwise.
+         */
+        ConnectionHandle GetHandle(BasicSocket& socket) const;
+
+        /**
+         * @brief Per-connection fields of the registered sockets.
+         *
+         * The reactor owns the interest column and an OutboundQueue keeps the
+         * outbound bytes of its socket, the state and context columns are free for
+         * the application. Slots are reset on Register and their handles go stale
+         * on Unregister.
+         */
+        HandleTable& GetHandles();
+
+    private:
+        struct ReactorImpl;
+        std::unique_ptr<ReactorImpl> impl;
+    };
+}
+
+#endif
@@ -27,8 +27,10 @@
 #include <EagleNetwork/Result.hh>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
 
 namespace Eagle::Core {
     class ResourceInitializerInvalidResource : std::runtime_error
@@ -245,6 +247,12 @@ namespace Eagle::Core {
 
         [[nodiscard]] TError GetActualError()
         {
+            if(this->IsValidResource())
+            {
+                throw ResourceInitializerNoErrorExists();
+            }
+
+            return resourceInitResult.GetError();
         }
 
         /**
@@ -323,6 +331,214 @@ namespace Eagle::Core {
         TDependencies& dependencies;
 
     };
+
+    /**
+     * Dependencies policy of InlineResourceInitializer storing a copy of the
+     * dependencies.
+     */
+    struct OwnedDependenciesPolicy {};
+
+    /**
+     * Dependencies policy of InlineResourceInitializer referencing dependencies
+     * owned by the caller, which must outlive the initializer.
+     */
+    struct ReferencedDependenciesPolicy {};
+
+    namespace Detail
+    {
+        template <typename TDependencies, typename TPolicy>
+        struct ResourceDependenciesStorage;
+
+        /**
+         * Stand-in dependencies type of initializers without dependencies.
+         */
+        struct NoResourceDependencies {};
+
+        template <>
+        struct ResourceDependenciesStorage<void, OwnedDependenciesPolicy>
+        {
+        };
+
+        template <typename TDependencies>
+        struct ResourceDependenciesStorage<TDependencies, OwnedDependenciesPolicy>
+        {
+            TDependencies dependencies;
+
+            const TDependencies& Get() const { return dependencies; }
+        };
+
+        template <typename TDependencies>
+        struct ResourceDependenciesStorage<TDependencies, ReferencedDependenciesPolicy>
+        {
+            // A pointer keeps the initializer movable and assignable.
+            const TDependencies* dependencies;
+
+            const TDependencies& Get() const { return *dependencies; }
+        };
+
+        template <typename TInitializer, typename TDependencies>
+        struct InitializerResult
+        {
+            using Type = std::invoke_result_t<TInitializer&, const TDependencies&>;
+        };
+
+        template <typename TInitializer>
+        struct InitializerResult<TInitializer, void>
+        {
+            using Type = std::invoke_result_t<TInitializer&>;
+        };
+    }
+
+    /**
+     * This class will initialize a resource with an initializer whose type is
+     * known at compile time, so it is stored inline and its call can be inlined,
+     * unlike the std::function of ResourceInitializer.
+     *
+     * The resource and error types are deduced from the Utilities::Result returned
+     * by the initializer, which is called with the dependencies, or without any
+     * argument when TDependencies is void.
+     *
+     * @tparam TInitializer The initializer callable type.
+     * @tparam TDependencies The dependencies type, void for none.
+     * @tparam TPolicy OwnedDependenciesPolicy or ReferencedDependenciesPolicy.
+     */
+    template <typename TInitializer, typename TDependencies = void, typename TPolicy = OwnedDependenciesPolicy>
+        requires(Utilities::IsResult<std::remove_cvref_t<
+            typename Detail::InitializerResult<TInitializer, TDependencies>::Type>>::value)
+    class InlineResourceInitializer final
+        : public Utilities::IResourceInitializer
+    {
+    public:
+        using ResultType = std::remove_cvref_t<typename Detail::InitializerResult<TInitializer, TDependencies>::Type>;
+        using ResourceType = typename ResultType::ValueType;
+        using ErrorType = typename ResultType::ErrorValueType;
+        using DependenciesType = std::conditional_t<std::is_void_v<TDependencies>,
+            Detail::NoResourceDependencies, TDependencies>;
+
+        explicit InlineResourceInitializer(TInitializer initializer)
+            requires(std::is_void_v<TDependencies>)
+            : initializer(std::move(initializer))
+        {}
+
+        InlineResourceInitializer(TInitializer initializer, DependenciesType dependencies)
+            requires(std::is_same_v<TPolicy, OwnedDependenciesPolicy> && !std::is_void_v<TDependencies>)
+            : initializer(std::move(initializer)), dependencies{std::move(dependencies)}
+        {}
+
+        InlineResourceInitializer(TInitializer initializer, std::reference_wrapper<const DependenciesType> dependencies)
+            requires(std::is_same_v<TPolicy, ReferencedDependenciesPolicy>)
+            : initializer(std::move(initializer)), dependencies{&dependencies.get()}
+        {}
+
+        InlineResourceInitializer(const InlineResourceInitializer&) = delete;
+        InlineResourceInitializer& operator=(const InlineResourceInitializer&) = delete;
+        InlineResourceInitializer(InlineResourceInitializer&&) = default;
+        InlineResourceInitializer& operator=(InlineResourceInitializer&&) = default;
+
+        /**
+         * This function will call the initializer to perform the initialization
+         * and keep its result.
+         */
+        void InitializeResource() override
+        {
+            if constexpr(std::is_void_v<TDependencies>) {
+                resourceInitResult.emplace(initializer());
+            } else {
+                resourceInitResult.emplace(initializer(dependencies.Get()));
+            }
+        }
+
+        /**
+         * This function will return the resource dependencies.
+         */
+        const DependenciesType& GetResourceDependencies() const
+            requires(!std::is_void_v<TDependencies>)
+        {
+            return dependencies.Get();
+        }
+
+        /**
+         * @brief Set the resource dependencies.
+         */
+        void SetResourceDependencies(DependenciesType deps)
+            requires(std::is_same_v<TPolicy, OwnedDependenciesPolicy> && !std::is_void_v<TDependencies>)
+        {
+            dependencies.dependencies = std::move(deps);
+        }
+
+        /**
+         * This function will check if the initializer successfully initalized
+         * the resource.
+         */
+        inline bool IsValidResource() const
+        {
+            return resourceInitResult.has_value() && resourceInitResult->HasResult();
+        }
+
+        /**
+         * @brief Get the Actual Resrouce object.
+         *
+         * @return A reference to the resource value.
+         */
+        [[nodiscard]] const ResourceType& GetActualResrouce() const
+        {
+            if(!this->IsValidResource())
+            {
+                throw ResourceInitializerInvalidResource();
+            }
+
+            return resourceInitResult->GetResult();
+        }
+
+        /**
+         * @brief Move the resource out of the initializer.
+         */
+        [[nodiscard]] ResourceType TakeResource()
+        {
+            if(!this->IsValidResource())
+            {
+                throw ResourceInitializerInvalidResource();
+            }
+
+            return std::move(*resourceInitResult).GetResult();
+        }
+
+        [[nodiscard]] const ErrorType& GetActualError() const
+        {
+            if(!resourceInitResult.has_value() || this->IsValidResource())
+            {
+                throw ResourceInitializerNoErrorExists();
+            }
+
+            return resourceInitResult->GetError();
+        }
+
+    private:
+        /**
+         * The initializer callable.
+         */
+        [[no_unique_address]] TInitializer initializer;
+        /**
+         * The resource dependencies, owned or referenced depending on TPolicy.
+         */
+        [[no_unique_address]] Detail::ResourceDependenciesStorage<TDependencies, TPolicy> dependencies;
+        /**
+         * The initializer resource result, empty until InitializeResource is called.
+         */
+        std::optional<ResultType> resourceInitResult;
+    };
+
+    template <typename TInitializer>
+    InlineResourceInitializer(TInitializer)
+        -> InlineResourceInitializer<TInitializer, void, OwnedDependenciesPolicy>;
+
+    template <typename TInitializer, typename TDependencies>
+    InlineResourceInitializer(TInitializer, std::reference_wrapper<TDependencies>)
+        -> InlineResourceInitializer<TInitializer, std::remove_const_t<TDependencies>, ReferencedDependenciesPolicy>;
+
+    template <typename TInitializer, typename TDependencies>
+    InlineResourceInitializer(TInitializer, TDependencies)
+        -> InlineResourceInitializer<TInitializer, TDependencies, OwnedDependenciesPolicy>;
 }
 
 #endif
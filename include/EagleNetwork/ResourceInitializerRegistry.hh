@@ -0,0 +1,170 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_RESOURCE_INITIALIZER_REGISTRY_HH
+#define EAGLE_NETWORK_RESOURCE_INITIALIZER_REGISTRY_HH
+
+#include <EagleNetwork/Executor.hh>
+#include <EagleNetwork/Result.hh>
+#include <EagleNetwork/Utilities.hh>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Eagle::Core
+{
+    class ResourceInitializerRegistryInvalidDependency : public std::runtime_error
+    {
+    public:
+        ResourceInitializerRegistryInvalidDependency()
+            : runtime_error("ResourceInitializerRegistry: a dependency must be added before its dependents.") {}
+    };
+
+    struct ResourceInitializationError
+    {
+        enum class Code
+        {
+            /**
+             * The initializer ran and reported an invalid resource.
+             */
+            Failed,
+            /**
+             * Not run because a dependency didn't initialize.
+             */
+            DependencyFailed,
+            /**
+             * The initializer threw.
+             */
+            Exception,
+            /**
+             * Not run because the executor was shut down.
+             */
+            Cancelled
+        };
+
+        Code code{Code::Failed};
+        std::exception_ptr exception{};
+    };
+
+    struct ResourceInitializationTiming
+    {
+        /**
+         * Time between the start of Run and the start of the initializer.
+         */
+        std::chrono::nanoseconds start{0};
+        std::chrono::nanoseconds duration{0};
+    };
+
+    struct ResourceInitializationSummary
+    {
+        std::size_t succeeded{0};
+        std::size_t failed{0};
+        std::chrono::nanoseconds elapsed{0};
+    };
+
+    /**
+     * Initializes a graph of resources, running each initializer on an Executor
+     * as soon as all of its dependencies initialized, so independent resources
+     * initialize concurrently.
+     *
+     * Dependencies are given as nodes already added to the registry, which keeps
+     * the graph acyclic. When a node fails, its dependents are not run and report
+     * DependencyFailed. The initializers are not owned and must outlive Run.
+     */
+    class ResourceInitializerRegistry
+    {
+    public:
+        using NodeId = std::size_t;
+
+        ResourceInitializerRegistry();
+        ~ResourceInitializerRegistry();
+
+        ResourceInitializerRegistry(const ResourceInitializerRegistry&) = delete;
+        ResourceInitializerRegistry& operator=(const ResourceInitializerRegistry&) = delete;
+
+        /**
+         * @brief Add an initializer whose success is InitializeResource returning.
+         *
+         * @throw ResourceInitializerRegistryInvalidDependency if a dependency isn't a node of the registry.
+         */
+        NodeId Add(std::string name, Utilities::IResourceInitializer& initializer,
+            const std::vector<NodeId>& dependencies = {});
+
+        /**
+         * @brief Add an initializer whose success is checked with IsValidResource
+         * after InitializeResource, as ResourceInitializer and InlineResourceInitializer do.
+         */
+        template <typename TInitializer>
+            requires(std::derived_from<TInitializer, Utilities::IResourceInitializer>
+                && requires(TInitializer& initializer) { { initializer.IsValidResource() } -> std::convertible_to<bool>; })
+        NodeId Add(std::string name, TInitializer& initializer, const std::vector<NodeId>& dependencies = {})
+        {
+            return AddNode(std::move(name), initializer, [&initializer] { return initializer.IsValidResource(); },
+                dependencies);
+        }
+
+        /**
+         * @brief Initialize every node and wait until all of them are done.
+         *
+         * Must not be called from a worker of executor, whose workers run the
+         * initializers. Running again initializes every node again.
+         */
+        ResourceInitializationSummary Run(Executor& executor);
+
+        std::size_t GetNodeCount() const;
+
+        const std::string& GetName(NodeId node) const;
+
+        /**
+         * @return The outcome of the node in the last Run.
+         */
+        const Utilities::Result<void, ResourceInitializationError>& GetResult(NodeId node) const;
+
+        const ResourceInitializationTiming& GetTiming(NodeId node) const;
+
+    private:
+        struct Node;
+
+        NodeId AddNode(std::string name, Utilities::IResourceInitializer& initializer, std::function<bool()> validate,
+            const std::vector<NodeId>& dependencies);
+        void Schedule(Executor& executor, Node& node);
+        void Execute(Executor& executor, Node& node);
+        void Complete(Executor& executor, Node& node, bool succeeded);
+
+        std::vector<std::unique_ptr<Node>> nodes;
+        std::chrono::steady_clock::time_point runStart;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::size_t remaining{0};
+    };
+}
+
+#endif
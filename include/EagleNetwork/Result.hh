@@ -23,9 +23,22 @@
 #ifndef EAGLENETWORK_RESULT_HH
 #define EAGLENETWORK_RESULT_HH
 
+#include <cstdlib>
 #include <exception>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+
+/**
+ * Raise a Result access error, builds without exceptions abort instead.
+ */
+#if defined (__cpp_exceptions)
+#define EAGLE_NETWORK_RESULT_THROW(exception) throw exception
+#else
+#define EAGLE_NETWORK_RESULT_THROW(exception) std::abort()
+#endif
 
 namespace Eagle::Core::Utilities {
     /**
@@ -40,17 +53,16 @@ namespace Eagle::Core::Utilities {
 
     /**
      * Exception thrown when trying to access uninitialized error value by the method
-     * Result::GetResult.
+     * Result::GetError.
      */
     class BadErrorAccess : public std::runtime_error
     {
     public:
-        BadErrorAccess() : runtime_error("BadErrorAccess: error can't access uninitialized result.") {}
+        BadErrorAccess() : runtime_error("BadErrorAccess: error can't access uninitialized error.") {}
     };
 
     template <typename T>
-    concept ResultValidErrorType = !(std::is_void_v<T> && std::is_reference_v<T>) && (std::is_default_constructible_v<T>
-            || (std::is_integral_v<T> || std::is_floating_point_v<T>));
+    concept ResultValidErrorType = std::is_object_v<T> && !std::is_array_v<T>;
 
     /**
      * A type wrapper that handles error values.
@@ -61,28 +73,20 @@ namespace Eagle::Core::Utilities {
     {
         T value;
 
-        Error() = default;
+        Error() requires(std::is_default_constructible_v<T>) = default;
         ~Error() = default;
 
-        template<typename U = T> requires(ResultValidErrorType<U> && std::is_convertible_v<U, T>)
+        template<typename U = T> requires(std::is_constructible_v<T, U&&>)
         explicit Error(U&& _value) : value(std::forward<U>(_value)) {}
 
         Error(const Error&) = delete;
         Error& operator=(const Error&) = delete;
         Error(Error&&) = default;
-        Error& operator=(Error&&) noexcept = default;
-
-        template <typename U = T>
-            requires(std::is_integral_v<U> || std::is_floating_point_v<U>)
-        Error(Error<U>&&) 
-        {
-        }
-
-        template <typename U = T>
-        Error& operator=(Error<U>&&)
-        {
+        Error& operator=(Error&&) = default;
 
-        }
+        template <typename U>
+            requires(!std::is_same_v<U, T> && std::is_constructible_v<T, U&&>)
+        Error(Error<U>&& other) : value(std::move(other.value)) {}
     };
 
     /**
@@ -92,94 +96,364 @@ namespace Eagle::Core::Utilities {
      * @return Returns a new Error structure of type U.
      */
     template <typename U>
-    Error<U> MakeError(U&& value) noexcept requires(std::is_nothrow_move_constructible_v<U>)
+    Error<std::remove_cvref_t<U>> MakeError(U&& value) noexcept
+        requires(std::is_nothrow_move_constructible_v<std::remove_cvref_t<U>>)
     {
-        return Error<U>(std::forward<U>(value));
+        return Error<std::remove_cvref_t<U>>(std::forward<U>(value));
     }
 
     template <typename T>
-    concept ResultValidResultType = !(std::is_reference_v<T> && std::is_void_v<T>) && (std::is_default_constructible_v<T>
-            || (std::is_integral_v<T> || std::is_floating_point_v<T>));
+    concept ResultValidResultType = std::is_void_v<T> || ResultValidErrorType<T>;
+
+    /**
+     * Value stored by a Result<void, E> holding a result.
+     */
+    struct VoidResultValue {};
 
+    template <ResultValidResultType ResultType, ResultValidErrorType ErrorType>
+    class Result;
+
+    template <typename T>
+    struct IsResult : std::false_type {};
+
+    template <typename T, typename E>
+    struct IsResult<Result<T, E>> : std::true_type {};
+
+    template <typename T>
+    struct IsError : std::false_type {};
+
+    template <typename T>
+    struct IsError<Error<T>> : std::true_type {};
+
+    /**
+     * The type returned by a continuation invoked with a result value, or without
+     * any argument for void results.
+     */
+    template <bool IsVoid, typename Function, typename Value>
+    struct ResultContinuation
+    {
+        using Type = std::invoke_result_t<Function, Value>;
+    };
+
+    template <typename Function, typename Value>
+    struct ResultContinuation<true, Function, Value>
+    {
+        using Type = std::invoke_result_t<Function>;
+    };
+
+    /**
+     * Holds either a result or an error value.
+     *
+     * Both values share the same storage, so the size of a Result is close to the
+     * size of the largest of them, and only the active one is ever constructed.
+     */
     template <ResultValidResultType ResultType, ResultValidErrorType ErrorType>
     class Result
     {
-        bool errorInitialized{false};
-        ResultType result;
-        Error<ErrorType> error;
+        template <ResultValidResultType, ResultValidErrorType>
+        friend class Result;
+
+        using StoredType = std::conditional_t<std::is_void_v<ResultType>, VoidResultValue, ResultType>;
+        static constexpr bool IsVoid = std::is_void_v<ResultType>;
+
+        union
+        {
+            StoredType result;
+            ErrorType error;
+        };
+        bool hasResult;
+
+        template <typename Other>
+        void ConstructFrom(Other&& other)
+        {
+            if(other.hasResult)
+            {
+                std::construct_at(&result, std::forward<Other>(other).result);
+            } else {
+                std::construct_at(&error, std::forward<Other>(other).error);
+            }
+            hasResult = other.hasResult;
+        }
+
+        void Destroy() noexcept
+        {
+            if(hasResult)
+            {
+                std::destroy_at(&result);
+            } else {
+                std::destroy_at(&error);
+            }
+        }
 
     public:
-        Result() = default;
-        ~Result() = default;
+        using ValueType = ResultType;
+        using ErrorValueType = ErrorType;
+
+        Result() requires(std::is_default_constructible_v<StoredType>) : result(), hasResult(true) {}
+
+        ~Result() requires(std::is_trivially_destructible_v<StoredType> && std::is_trivially_destructible_v<ErrorType>) = default;
+        ~Result()
+        {
+            Destroy();
+        }
 
         Result(const Result<ResultType, ErrorType>&) = delete;
         Result& operator=(const Result<ResultType, ErrorType>&) = delete;
-        Result(Result<ResultType, ErrorType>&& other) = default;
-        Result& operator=(Result<ResultType, ErrorType>&& other) = default;
 
-        template <typename T>
-        Result(Result<T, ErrorType>&& other)
-            requires(std::is_integral_v<T> || std::is_floating_point_v<T>)
+        Result(Result<ResultType, ErrorType>&& other)
+            noexcept(std::is_nothrow_move_constructible_v<StoredType> && std::is_nothrow_move_constructible_v<ErrorType>)
         {
-            if(other.HasResult())
+            ConstructFrom(std::move(other));
+        }
+
+        Result& operator=(Result<ResultType, ErrorType>&& other)
+            noexcept(std::is_nothrow_move_constructible_v<StoredType> && std::is_nothrow_move_constructible_v<ErrorType>)
+        {
+            if(this != &other)
             {
-                std::swap(this->result, other.result);
-                other.result = 0;
-            } else {
-                this->error = std::move(other.error);
+                Destroy();
+                ConstructFrom(std::move(other));
             }
+            return *this;
         }
 
-        template <typename T>
-        Result& operator=(Result<T, ErrorType>&& other)
-            requires(std::is_integral_v<T> || std::is_floating_point_v<T>)
+        template <typename T, typename E>
+            requires(!std::is_same_v<Result<T, E>, Result<ResultType, ErrorType>>
+                && std::is_void_v<T> == IsVoid
+                && (std::is_void_v<T> || std::is_constructible_v<StoredType, T&&>)
+                && std::is_constructible_v<ErrorType, E&&>)
+        Result(Result<T, E>&& other)
         {
-            if(other.HasResult())
+            if(other.hasResult)
             {
-                std::swap(this->result, other.result);
-                other.result = 0;
+                std::construct_at(&result, std::move(other.result));
             } else {
-                this->error = std::move(other.error);
+                std::construct_at(&error, std::move(other.error));
             }
-            return *this;
+            hasResult = other.hasResult;
         }
 
-        template<typename U> requires(ResultValidResultType<U> && std::is_convertible_v<U, ResultType>)
-        Result(U&& value) : result(std::forward<U>(value)) {}
+        template <typename T, typename E>
+            requires(!std::is_same_v<Result<T, E>, Result<ResultType, ErrorType>>
+                && std::is_constructible_v<Result<ResultType, ErrorType>, Result<T, E>&&>)
+        Result& operator=(Result<T, E>&& other)
+        {
+            return *this = Result<ResultType, ErrorType>(std::move(other));
+        }
+
+        template <typename U>
+            requires(!IsVoid && !IsResult<std::remove_cvref_t<U>>::value && !IsError<std::remove_cvref_t<U>>::value
+                && std::is_constructible_v<StoredType, U&&>)
+        Result(U&& value) : result(std::forward<U>(value)), hasResult(true) {}
+
+        template <typename U> requires(std::is_constructible_v<ErrorType, U&&>)
+        Result(Error<U>&& value) : error(std::move(value.value)), hasResult(false) {}
 
-        template <typename U> requires(ResultValidErrorType<U> && std::is_convertible_v<U, ErrorType>)
-        Result(Error<U>&& value) : errorInitialized{true}, error(std::move(value)) {}
         /**
          * This function returns the state of the value and error if initialized or not.
          * 
          * @return The state of error initialization.
          */
-        inline bool HasResult() const {
-            return !errorInitialized;
+        inline bool HasResult() const noexcept {
+            return hasResult;
+        }
+
+        inline bool HasError() const noexcept {
+            return !hasResult;
+        }
+
+        explicit operator bool() const noexcept {
+            return hasResult;
         }
 
         /**
          * This function returns the result value, in case trying to access uninitialized
          * result value an exception BadResultAccess will thrown.
          * 
-         * @return Returns a result value of type const ResultType.
+         * @return Returns a reference to the result value, nothing for void results.
          */
-        [[nodiscard]] ResultType GetResult() const
+        [[nodiscard]] std::add_lvalue_reference_t<ResultType> GetResult() &
+        {
+            if(!hasResult) EAGLE_NETWORK_RESULT_THROW(BadResultAccess());
+            if constexpr(!IsVoid) return result;
+        }
+
+        [[nodiscard]] std::add_lvalue_reference_t<std::add_const_t<ResultType>> GetResult() const&
         {
-            if(errorInitialized) throw BadResultAccess();
-            return this->result;
+            if(!hasResult) EAGLE_NETWORK_RESULT_THROW(BadResultAccess());
+            if constexpr(!IsVoid) return result;
+        }
+
+        [[nodiscard]] std::add_rvalue_reference_t<ResultType> GetResult() &&
+        {
+            if(!hasResult) EAGLE_NETWORK_RESULT_THROW(BadResultAccess());
+            if constexpr(!IsVoid) return std::move(result);
         }
 
         /**
          * This function returns the error value, in case trying to access uninitialized
-         * error value an exception BadResultAccess will thrown.
+         * error value an exception BadErrorAccess will thrown.
          * 
-         * @return Returns a result value of type const ErrorType.
+         * @return Returns a reference to the error value.
+         */
+        [[nodiscard]] ErrorType& GetError() &
+        {
+            if(hasResult) EAGLE_NETWORK_RESULT_THROW(BadErrorAccess());
+            return error;
+        }
+
+        [[nodiscard]] const ErrorType& GetError() const&
+        {
+            if(hasResult) EAGLE_NETWORK_RESULT_THROW(BadErrorAccess());
+            return error;
+        }
+
+        [[nodiscard]] ErrorType&& GetError() &&
+        {
+            if(hasResult) EAGLE_NETWORK_RESULT_THROW(BadErrorAccess());
+            return std::move(error);
+        }
+
+        /**
+         * @return A pointer to the result value, nullptr when holding an error.
          */
-        [[nodiscard]] ErrorType GetError() const
+        [[nodiscard]] StoredType* TryGetResult() noexcept requires(!IsVoid)
         {
-            if(!errorInitialized) throw BadResultAccess();
-            return this->error.value;
+            return hasResult ? &result : nullptr;
+        }
+
+        [[nodiscard]] const StoredType* TryGetResult() const noexcept requires(!IsVoid)
+        {
+            return hasResult ? &result : nullptr;
+        }
+
+        /**
+         * @return A pointer to the error value, nullptr when holding a result.
+         */
+        [[nodiscard]] ErrorType* TryGetError() noexcept
+        {
+            return hasResult ? nullptr : &error;
+        }
+
+        [[nodiscard]] const ErrorType* TryGetError() const noexcept
+        {
+            return hasResult ? nullptr : &error;
+        }
+
+        /**
+         * @return The result value, or fallback when holding an error.
+         */
+        template <typename U> requires(!IsVoid)
+        [[nodiscard]] StoredType ValueOr(U&& fallback) const&
+        {
+            return hasResult ? result : static_cast<StoredType>(std::forward<U>(fallback));
+        }
+
+        template <typename U> requires(!IsVoid)
+        [[nodiscard]] StoredType ValueOr(U&& fallback) &&
+        {
+            return hasResult ? std::move(result) : static_cast<StoredType>(std::forward<U>(fallback));
+        }
+
+        /**
+         * @brief Chain an operation returning a Result on the result value, the
+         * error is propagated without calling it.
+         */
+        template <typename F>
+        auto AndThen(F&& function) const&
+        {
+            using Next = std::remove_cvref_t<typename ResultContinuation<IsVoid, F, const StoredType&>::Type>;
+            static_assert(IsResult<Next>::value, "AndThen: the continuation must return a Result.");
+
+            if(!hasResult) return Next(Error<ErrorType>(error));
+            if constexpr(IsVoid) return std::invoke(std::forward<F>(function));
+            else return std::invoke(std::forward<F>(function), result);
+        }
+
+        template <typename F>
+        auto AndThen(F&& function) &&
+        {
+            using Next = std::remove_cvref_t<typename ResultContinuation<IsVoid, F, StoredType&&>::Type>;
+            static_assert(IsResult<Next>::value, "AndThen: the continuation must return a Result.");
+
+            if(!hasResult) return Next(Error<ErrorType>(std::move(error)));
+            if constexpr(IsVoid) return std::invoke(std::forward<F>(function));
+            else return std::invoke(std::forward<F>(function), std::move(result));
+        }
+
+        /**
+         * @brief Map the result value, the error is propagated without calling the function.
+         */
+        template <typename F>
+        auto Transform(F&& function) const&
+        {
+            using U = std::remove_cv_t<typename ResultContinuation<IsVoid, F, const StoredType&>::Type>;
+            using Next = Result<U, ErrorType>;
+
+            if(!hasResult) return Next(Error<ErrorType>(error));
+            if constexpr(IsVoid && std::is_void_v<U>) {
+                std::invoke(std::forward<F>(function));
+                return Next();
+            } else if constexpr(IsVoid) {
+                return Next(std::invoke(std::forward<F>(function)));
+            } else if constexpr(std::is_void_v<U>) {
+                std::invoke(std::forward<F>(function), result);
+                return Next();
+            } else {
+                return Next(std::invoke(std::forward<F>(function), result));
+            }
+        }
+
+        template <typename F>
+        auto Transform(F&& function) &&
+        {
+            using U = std::remove_cv_t<typename ResultContinuation<IsVoid, F, StoredType&&>::Type>;
+            using Next = Result<U, ErrorType>;
+
+            if(!hasResult) return Next(Error<ErrorType>(std::move(error)));
+            if constexpr(IsVoid && std::is_void_v<U>) {
+                std::invoke(std::forward<F>(function));
+                return Next();
+            } else if constexpr(IsVoid) {
+                return Next(std::invoke(std::forward<F>(function)));
+            } else if constexpr(std::is_void_v<U>) {
+                std::invoke(std::forward<F>(function), std::move(result));
+                return Next();
+            } else {
+                return Next(std::invoke(std::forward<F>(function), std::move(result)));
+            }
+        }
+
+        /**
+         * @brief Recover from an error with an operation returning a Result, the
+         * result value is propagated without calling it.
+         */
+        template <typename F>
+        auto OrElse(F&& function) const&
+        {
+            using Next = std::remove_cvref_t<std::invoke_result_t<F, const ErrorType&>>;
+            static_assert(IsResult<Next>::value, "OrElse: the continuation must return a Result.");
+
+            if(hasResult)
+            {
+                if constexpr(IsVoid) return Next();
+                else return Next(result);
+            }
+            return std::invoke(std::forward<F>(function), error);
+        }
+
+        template <typename F>
+        auto OrElse(F&& function) &&
+        {
+            using Next = std::remove_cvref_t<std::invoke_result_t<F, ErrorType&&>>;
+            static_assert(IsResult<Next>::value, "OrElse: the continuation must return a Result.");
+
+            if(hasResult)
+            {
+                if constexpr(IsVoid) return Next();
+                else return Next(std::move(result));
+            }
+            return std::invoke(std::forward<F>(function), std::move(error));
         }
     };
 }
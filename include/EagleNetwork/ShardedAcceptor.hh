@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_SHARDED_ACCEPTOR_HH
+#define EAGLE_NETWORK_SHARDED_ACCEPTOR_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/Socket.hh>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <sys/socket.h>
+#include <vector>
+
+#if !defined (__linux__)
+#error "ShardedAcceptor requires SO_REUSEPORT load balancing and is only available on Linux."
+#endif
+
+namespace Eagle::Core
+{
+    struct ShardedAcceptorOptions
+    {
+        /**
+         * Number of workers, 0 for one per hardware thread.
+         */
+        std::size_t workers{0};
+        int backlog{SOMAXCONN};
+        /**
+         * Pin worker i to CPU i modulo the number of hardware threads.
+         */
+        bool pinWorkers{true};
+        /**
+         * Attach a SO_ATTACH_REUSEPORT_CBPF program steering a connection to the
+         * worker of the CPU that received it. Requires pinWorkers and one worker
+         * per hardware thread, Start fails with EINVAL otherwise.
+         */
+        bool cpuSteering{false};
+        /**
+         * Options of the listening sockets, inherited by accepted connections.
+         * The listeners are always non-blocking and close-on-exec.
+         */
+        Detail::SocketOptions socketOptions{};
+    };
+
+    /**
+     * Multi-core server front-end running one worker thread per listening socket.
+     *
+     * Every worker owns a Reactor and a listening BasicSocket bound to the same
+     * address with SO_REUSEPORT, the kernel spreads new connections across them so
+     * there is no shared accept queue or lock between workers. A worker sleeps in
+     * its reactor until a connection arrives or Stop wakes it through an eventfd.
+     */
+    class ShardedAcceptor
+    {
+    public:
+        /**
+         * Called on the worker thread for every accepted connection, usually to
+         * register it in the worker's reactor, which it must then own.
+         */
+        using ConnectionHandler = std::function<void(std::size_t worker, Reactor& reactor, BasicSocket connection)>;
+
+        /**
+         * Called on the worker thread once Stop was requested and the listener is
+         * closed, to unregister and close the connections the worker still owns.
+         * Closes deferred to the reactor run before it is destroyed.
+         */
+        using ShutdownHandler = std::function<void(std::size_t worker, Reactor& reactor)>;
+
+        ShardedAcceptor(const ShardedAcceptorOptions& options, ConnectionHandler handler,
+            ShutdownHandler shutdownHandler = {});
+        ~ShardedAcceptor();
+
+        ShardedAcceptor(const ShardedAcceptor&) = delete;
+        ShardedAcceptor& operator=(const ShardedAcceptor&) = delete;
+        ShardedAcceptor(ShardedAcceptor&&) = delete;
+        ShardedAcceptor& operator=(ShardedAcceptor&&) = delete;
+
+        /**
+         * @brief Open the listening sockets and start the workers.
+         *
+         * A port 0 address is resolved once and shared by every worker.
+         */
+        Detail::SocketStatusResult Start(const sockaddr* address, socklen_t length);
+
+        /**
+         * @brief Stop the workers and close the listening sockets.
+         *
+         * Returns once every worker ran its shutdown handler and its reactor is
+         * destroyed.
+         */
+        void Stop();
+
+        std::size_t GetWorkerCount() const;
+
+        /**
+         * @return The port the listening sockets are bound to.
+         */
+        std::uint16_t GetPort() const;
+
+        /**
+         * @return The number of connections accepted by a worker.
+         */
+        std::size_t GetAcceptedCount(std::size_t worker) const;
+
+    private:
+        struct Worker;
+
+        ShardedAcceptorOptions options;
+        ConnectionHandler handler;
+        ShutdownHandler shutdownHandler;
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::uint16_t port{0};
+    };
+}
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_SHARED_MEMORY_CHANNEL_HH
+#define EAGLE_NETWORK_SHARED_MEMORY_CHANNEL_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Result.hh>
+#include <EagleNetwork/Socket.hh>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if !defined (__linux__)
+#error "SharedMemoryChannel requires memfd and eventfd and is only available on Linux."
+#endif
+
+namespace Eagle::Core
+{
+    namespace Detail
+    {
+        struct SharedMemoryHeader;
+        struct SharedMemoryRing;
+    }
+
+    struct SharedMemoryChannelOptions
+    {
+        /**
+         * Bytes buffered per direction, rounded up to a power of two.
+         */
+        std::size_t capacity = 256 * 1024;
+
+        /**
+         * Times WaitReadable/WaitWritable re-check the ring before sleeping on
+         * the eventfd, trading a core for wakeup latency.
+         */
+        std::uint32_t busyPollSpins = 0;
+    };
+
+    /**
+     * A byte stream between two processes on the same host over a pair of
+     * single-producer single-consumer rings in a sealed memfd.
+     *
+     * The creator sends the memfd and one eventfd per side over an AF_UNIX
+     * socket (see BasicSocket::WriteDescriptors), the peer attaches with the
+     * received descriptors. After that, data moves without syscalls: a side
+     * only writes its peer's eventfd when the peer announced in the shared
+     * header that it ran dry and is about to sleep.
+     *
+     * Read and Write behave like their BasicSocket counterparts on a
+     * non-blocking stream socket: partial transfers, EAGAIN when the ring is
+     * empty or full, 0 from Read once the peer closed and the ring drained,
+     * EPIPE from Write once the peer is gone. The ring indices are written by
+     * the peer, so they are checked on every load; a head and tail further
+     * apart than the capacity mark the channel broken and every later Read
+     * and Write fails with EPROTO. An EAGAIN arms the notification,
+     * so the eventfd held by GetNotifier becomes readable when it is worth
+     * retrying; the notifier is shared by both directions so a Reactor handler
+     * should retry its pending Read and Write.
+     *
+     * Each side is meant to be driven by one thread at a time. A peer that
+     * dies without closing its side leaves no trace in the rings; keep the
+     * control socket open and watch it for hangup to detect that.
+     */
+    class SharedMemoryChannel
+    {
+    public:
+        using ChannelResult = Utilities::Result<SharedMemoryChannel, Detail::SocketPlatformErrorType::Type>;
+
+        /**
+         * @brief Allocate the rings and offer them to the peer on control.
+         * @return The channel, or the platform error of the allocation or the send.
+         */
+        static ChannelResult Create(BasicSocket& control, const SharedMemoryChannelOptions& options = {});
+
+        /**
+         * @brief Attach to the rings offered by the peer on control.
+         *
+         * A non-blocking control socket without a pending offer yields EAGAIN,
+         * an offer that isn't well formed yields EPROTO.
+         */
+        static ChannelResult Attach(BasicSocket& control, const SharedMemoryChannelOptions& options = {});
+
+        SharedMemoryChannel(SharedMemoryChannel&& other) noexcept;
+        SharedMemoryChannel& operator=(SharedMemoryChannel&& other) noexcept;
+        SharedMemoryChannel(const SharedMemoryChannel&) = delete;
+        SharedMemoryChannel& operator=(const SharedMemoryChannel&) = delete;
+        ~SharedMemoryChannel();
+
+        Detail::SocketIOResult Read(std::span<std::byte> buffer);
+        Detail::SocketIOResult Write(std::span<const std::byte> buffer);
+
+        /**
+         * @brief Block until Read has something to report, spinning first when configured.
+         * @param timeoutMilliseconds As for poll(2), -1 waits indefinitely.
+         * @return true when readable, false on timeout.
+         */
+        bool WaitReadable(int timeoutMilliseconds = -1);
+
+        /**
+         * @brief Block until Write has room or the peer is gone.
+         * @return true when writable, false on timeout.
+         */
+        bool WaitWritable(int timeoutMilliseconds = -1);
+
+        /**
+         * @brief Stop writing; the peer reads the remaining bytes then 0.
+         */
+        void ShutdownWrite();
+
+        /**
+         * @return The eventfd the peer signals, for registering in a Reactor.
+         */
+        BasicSocket& GetNotifier();
+
+        std::size_t GetCapacity() const noexcept;
+
+    private:
+        /**
+         * @param capacity The validated ring size, the copy in the shared header
+         * is writable by the peer and never read back.
+         */
+        SharedMemoryChannel(void* mapping, std::size_t mappingLength, std::size_t capacity, bool creator,
+            BasicSocket&& notifier, BasicSocket&& peerNotifier, const SharedMemoryChannelOptions& options);
+
+        bool IsReadable() const noexcept;
+        bool IsWritable() const noexcept;
+        bool CheckIndices(std::uint64_t head, std::uint64_t tail);
+        bool Wait(bool writable, int timeoutMilliseconds);
+        void SignalPeer();
+        void ConsumeNotification();
+        void Release();
+
+        void* mapping = nullptr;
+        std::size_t mappingLength = 0;
+        Detail::SharedMemoryRing* incoming = nullptr;
+        Detail::SharedMemoryRing* outgoing = nullptr;
+        std::byte* incomingData = nullptr;
+        std::byte* outgoingData = nullptr;
+        std::size_t capacity = 0;
+        std::uint32_t busyPollSpins = 0;
+        bool broken = false;
+        BasicSocket notifier;
+        BasicSocket peerNotifier;
+    };
+}
+
+#endif // EAGLE_NETWORK_SHARED_MEMORY_CHANNEL_HH
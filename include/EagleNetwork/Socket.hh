@@ -24,16 +24,24 @@
 #define EAGLE_NETWORK_SOCKET_HH
 
 #include "EagleNetwork/Utilities.hh"
+#include <EagleNetwork/Buffer.hh>
 #include <EagleNetwork/Platform/PlatofrmDefs.hh>
 #include <EagleNetwork/ResourceInitializer.hh>
+#include <cerrno>
+#include <cstddef>
 #include <memory>
+#include <span>
 #include <exception>
 #include <stdexcept>
 #include <sys/socket.h>
+#include <sys/types.h>
 #include <type_traits>
+#include <utility>
 
 namespace Eagle::Core
 {
+    struct IoLatencyHistograms;
+
     class BasicSocketInvalidDependencies : std::runtime_error
     {
     public:
@@ -48,16 +56,68 @@ namespace Eagle::Core
             Detail::SocketPlatformErrorType::Type,
             Detail::SocketResourceDependencies>;
 
-        explicit BasicSocket(Detail::SocketResourceType resource);
-        BasicSocket& operator=(const Detail::SocketResourceType& resource);
+        /**
+         * Value of the socket resource when no socket is held.
+         */
+        static constexpr Detail::SocketResourceType::ResourceType InvalidResource = -1;
+
+        /**
+         * @brief Take ownership of an already opened socket resource.
+         *
+         * @param resource The socket resource, closed when the BasicSocket is destroyed.
+         */
+        explicit BasicSocket(Detail::SocketResourceType::ResourceType resource);
+        BasicSocket& operator=(Detail::SocketResourceType::ResourceType resource);
 
         explicit BasicSocket(ResourceInitializerType initializer);
         BasicSocket& operator=(ResourceInitializerType initializer);
 
+        /**
+         * @brief Take the socket resource created by an inline initializer.
+         */
+        template <typename TInitializer, typename TDependencies, typename TPolicy>
+            requires(std::is_same_v<typename InlineResourceInitializer<TInitializer, TDependencies, TPolicy>::ResourceType,
+                Detail::SocketResourceType::ResourceType>)
+        explicit BasicSocket(InlineResourceInitializer<TInitializer, TDependencies, TPolicy>&& initializer)
+            : BasicSocket()
+        {
+            initializer.InitializeResource();
+            if(!initializer.IsValidResource())
+            {
+                throw BasicSocketInvalidDependencies();
+            }
+
+            *this = initializer.TakeResource();
+        }
+
+        /**
+         * @brief Create an inline initializer opening a socket from the dependencies.
+         */
+        static auto MakeInitializer(const Detail::SocketResourceDependencies& dependencies)
+        {
+            return InlineResourceInitializer(
+                [](const Detail::SocketResourceDependencies& deps) -> Detail::SocketInitResult {
+                    return OpenResource(deps);
+                },
+                dependencies);
+        }
+
+        /**
+         * @brief Create a socket resource and apply the dependencies' options.
+         *
+         * @return The resource, or the error of the first call that failed, in
+         * which case no resource is left open.
+         */
+        static Detail::SocketInitResult OpenResource(const Detail::SocketResourceDependencies& dependencies);
+
         BasicSocket(const BasicSocket&) = delete;
         BasicSocket& operator=(const BasicSocket&) = delete;
-        BasicSocket(const BasicSocket&&) = default;
-        BasicSocket& operator=(const BasicSocket&&) = default;
+        /**
+         * Moving hands over the socket state without allocating. A moved-from
+         * socket is closed and may only be destroyed, assigned or opened again.
+         */
+        BasicSocket(BasicSocket&&) noexcept;
+        BasicSocket& operator=(BasicSocket&&) noexcept;
 
         BasicSocket();
         ~BasicSocket();
@@ -68,6 +128,180 @@ namespace Eagle::Core
 
         Detail::SocketResourceType::ResourceType GetSocketResource();
 
+        /**
+         * @brief Assign a local address to the socket.
+         */
+        Detail::SocketStatusResult Bind(const sockaddr* address, socklen_t length);
+
+        /**
+         * @brief Mark the socket as accepting connections.
+         */
+        Detail::SocketStatusResult Listen(int backlog = SOMAXCONN);
+
+        /**
+         * @brief Accept a pending connection.
+         *
+         * The connection is created close-on-exec and inherits the listener's
+         * socket options, its non-blocking mode is set by the same call.
+         * @param nonBlocking Make the accepted socket non-blocking.
+         * @return The connected socket, or the platform error; EAGAIN when a
+         * non-blocking listener has no pending connection.
+         */
+        Utilities::Result<BasicSocket, Detail::SocketPlatformErrorType::Type> Accept(bool nonBlocking = true);
+
+        /**
+         * @brief Connect the socket to a remote address.
+         *
+         * @return The platform error, EINPROGRESS when a non-blocking connection is
+         * being established.
+         */
+        Detail::SocketStatusResult Connect(const sockaddr* address, socklen_t length);
+
+        /**
+         * @brief Set an integer socket option.
+         */
+        Detail::SocketStatusResult SetOption(int level, int name, int value);
+
+        /**
+         * @brief Get the local address the socket is bound to.
+         */
+        Detail::SocketStatusResult GetLocalAddress(sockaddr_storage& address, socklen_t& length);
+
+        /**
+         * @brief Check if the socket holds an opened resource.
+         */
+        bool IsOpen() const;
+
+        /**
+         * @brief Switch the socket between blocking and non-blocking mode.
+         *
+         * @param enabled true to make the socket non-blocking.
+         * @return true on success.
+         */
+        bool SetNonBlocking(bool enabled);
+
+        /**
+         * @brief Time the read, write, connect and accept system calls of this
+         * socket into histograms shared by its socket class.
+         *
+         * Calls returning EAGAIN are not recorded. Sockets accepted from this one
+         * inherit the histograms, which must outlive them. nullptr disables timing.
+         */
+        void SetLatencyHistograms(IoLatencyHistograms* histograms);
+        IoLatencyHistograms* GetLatencyHistograms() const;
+
+        /**
+         * @brief Read at most buffer.size() bytes from the socket.
+         *
+         * @return The number of bytes read (0 on orderly shutdown) or the platform error,
+         * EAGAIN/EWOULDBLOCK when a non-blocking socket has nothing to read.
+         */
+        Detail::SocketIOResult Read(std::span<std::byte> buffer);
+
+        /**
+         * @brief Write at most buffer.size() bytes to the socket.
+         *
+         * @return The number of bytes written or the platform error.
+         */
+        Detail::SocketIOResult Write(std::span<const std::byte> buffer);
+
+        /**
+         * @brief Read at most maxBytes at the end of a chained buffer.
+         *
+         * @return The number of bytes appended or the platform error.
+         */
+        Detail::SocketIOResult Read(ChainedBuffer& buffer, std::size_t maxBytes);
+
+        /**
+         * Most buffer segments gathered by one Write of a ChainedBuffer.
+         */
+        static constexpr std::size_t MaxWriteVectors = 64;
+
+        /**
+         * @brief Gather-write the content of a chained buffer and consume the bytes
+         * that were written.
+         *
+         * @param more Tell the kernel more data follows right away (MSG_MORE), so a
+         * partial segment may be held back until the next write.
+         * @return The number of bytes written or the platform error.
+         */
+        Detail::SocketIOResult Write(ChainedBuffer& buffer, bool more = false);
+
+        /**
+         * Most descriptors a single message can carry (SCM_MAX_FD on Linux).
+         */
+        static constexpr std::size_t MaxPassedDescriptors = 253;
+
+        /**
+         * @brief Write buffer over an AF_UNIX socket along with descriptors.
+         *
+         * The receiving process gets duplicates of the descriptors, the caller
+         * keeps its own. They travel with the first byte, so buffer must not be empty.
+         * @return The number of bytes written or the platform error.
+         */
+        Detail::SocketIOResult WriteDescriptors(std::span<const std::byte> buffer, std::span<const int> descriptors);
+
+        /**
+         * @brief Read from an AF_UNIX socket, collecting the descriptors sent along.
+         *
+         * Received descriptors are close-on-exec and owned by the caller, those
+         * that don't fit in descriptors are closed. If the control message was
+         * truncated, e.g. by other ancillary data such as SO_PASSCRED credentials,
+         * every received descriptor is closed and EMSGSIZE is returned, the bytes
+         * read are lost.
+         * @param descriptorCount Set to the number of descriptors stored.
+         * @return The number of bytes read or the platform error.
+         */
+        Detail::SocketIOResult ReadDescriptors(std::span<std::byte> buffer, std::span<int> descriptors,
+            std::size_t& descriptorCount);
+
+        /**
+         * @brief Create a pair of connected sockets, e.g. AF_UNIX with SOCK_STREAM
+         * or SOCK_SEQPACKET, with the dependencies' options applied to both.
+         */
+        static Utilities::Result<std::pair<BasicSocket, BasicSocket>, Detail::SocketPlatformErrorType::Type>
+            MakePair(const Detail::SocketResourceDependencies& dependencies);
+
+#if defined (__linux__)
+        /**
+         * @brief Allow MSG_ZEROCOPY sends on this socket.
+         */
+        bool EnableZeroCopy();
+
+        /**
+         * @brief Write without copying the payload into the kernel.
+         *
+         * The kernel keeps referencing the pages after the call returns: owner is
+         * held by the socket until ProcessZeroCopyCompletions reports the send as
+         * finished, so the buffer must stay valid as long as owner is alive.
+         *
+         * @return The number of bytes queued or the platform error, EINVAL when
+         * EnableZeroCopy did not succeed on this socket.
+         */
+        Detail::SocketIOResult WriteZeroCopy(std::span<const std::byte> buffer, std::shared_ptr<const void> owner);
+
+        /**
+         * @brief Read the zero-copy notifications from the socket error queue and
+         * release the owners of the finished sends.
+         *
+         * @return The number of released owners or the platform error.
+         */
+        Detail::SocketIOResult ProcessZeroCopyCompletions();
+
+        /**
+         * @return The number of zero-copy sends the kernel did not release yet.
+         */
+        std::size_t GetPendingZeroCopyCount() const;
+
+        /**
+         * @brief Send count bytes of a file starting at offset, which is advanced by
+         * the number of bytes sent.
+         *
+         * @return The number of bytes sent or the platform error.
+         */
+        Detail::SocketIOResult SendFile(int fileResource, off_t& offset, std::size_t count);
+#endif
+
     private:
         struct BasicSocketImpl;
         std::unique_ptr<BasicSocketImpl> impl;
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_SPLICE_FORWARDER_HH
+#define EAGLE_NETWORK_SPLICE_FORWARDER_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Socket.hh>
+#include <cstddef>
+#include <stdexcept>
+
+#if !defined (__linux__)
+#error "SpliceForwarder requires splice and is only available on Linux."
+#endif
+
+namespace Eagle::Core
+{
+    class SpliceForwarderCreationFailure : public std::runtime_error
+    {
+    public:
+        SpliceForwarderCreationFailure()
+            : runtime_error("SpliceForwarder: can't create the forwarding pipe.") {}
+    };
+
+    /**
+     * Relays a byte stream from one socket to another through a kernel pipe with
+     * splice, so the payload never reaches userspace.
+     *
+     * Bytes that were moved into the pipe but could not be written to the
+     * destination yet are kept in the pipe and flushed first by the next call.
+     */
+    class SpliceForwarder
+    {
+    public:
+        /**
+         * @param pipeCapacity Requested pipe size, 0 keeps the system default.
+         */
+        explicit SpliceForwarder(std::size_t pipeCapacity = 0);
+        ~SpliceForwarder();
+
+        SpliceForwarder(const SpliceForwarder&) = delete;
+        SpliceForwarder& operator=(const SpliceForwarder&) = delete;
+        SpliceForwarder(SpliceForwarder&&) = delete;
+        SpliceForwarder& operator=(SpliceForwarder&&) = delete;
+
+        /**
+         * @brief Move at most maxBytes from source to destination.
+         *
+         * @return The number of bytes written to destination, or the platform error;
+         * EAGAIN when nothing could be moved without blocking.
+         */
+        Detail::SocketIOResult Forward(BasicSocket& source, BasicSocket& destination, std::size_t maxBytes);
+
+        /**
+         * @return The number of bytes waiting in the pipe for the destination.
+         */
+        std::size_t GetBufferedCount() const;
+
+        /**
+         * @return true once the source reported the end of the stream.
+         */
+        bool IsSourceClosed() const;
+
+    private:
+        int pipeResources[2]{-1, -1};
+        std::size_t buffered{0};
+        bool sourceClosed{false};
+    };
+}
+
+#endif
@@ -0,0 +1,267 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_TASK_HH
+#define EAGLE_NETWORK_TASK_HH
+
+#include <EagleNetwork/PoolAllocator.hh>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace Eagle::Core
+{
+    template <typename T = void>
+    class Task;
+
+    namespace Detail
+    {
+        /**
+         * Promise state shared by every Task, the coroutine frame is allocated
+         * from the calling thread's PoolAllocator instead of the global heap.
+         */
+        struct TaskPromiseBase
+        {
+            std::coroutine_handle<> continuation{};
+            std::exception_ptr exception{};
+            bool detached{false};
+
+            static void* operator new(std::size_t size)
+            {
+                return PoolAllocator::ForCurrentThread().Allocate(size);
+            }
+
+            static void operator delete(void* pointer, std::size_t size) noexcept
+            {
+                PoolAllocator::ForCurrentThread().Deallocate(pointer, size);
+            }
+
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            struct FinalAwaiter
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+                {
+                    auto& promise = handle.promise();
+                    if(promise.detached)
+                    {
+                        if(promise.exception)
+                        {
+                            std::terminate();
+                        }
+                        handle.destroy();
+                        return std::noop_coroutine();
+                    }
+                    if(promise.continuation)
+                    {
+                        return promise.continuation;
+                    }
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            FinalAwaiter final_suspend() noexcept
+            {
+                return {};
+            }
+
+            void unhandled_exception() noexcept
+            {
+                exception = std::current_exception();
+            }
+
+            void RethrowIfFailed()
+            {
+                if(exception)
+                {
+                    std::rethrow_exception(exception);
+                }
+            }
+        };
+
+        template <typename T>
+        struct TaskPromise : TaskPromiseBase
+        {
+            std::optional<T> value;
+
+            Task<T> get_return_object() noexcept;
+
+            template <typename U> requires(std::is_constructible_v<T, U&&>)
+            void return_value(U&& result)
+            {
+                value.emplace(std::forward<U>(result));
+            }
+
+            T TakeValue()
+            {
+                RethrowIfFailed();
+                return std::move(*value);
+            }
+        };
+
+        template <>
+        struct TaskPromise<void> : TaskPromiseBase
+        {
+            Task<void> get_return_object() noexcept;
+
+            void return_void() noexcept {}
+
+            void TakeValue()
+            {
+                RethrowIfFailed();
+            }
+        };
+    }
+
+    /**
+     * Lazily started coroutine producing a T.
+     *
+     * The coroutine runs when the task is awaited, the awaiting coroutine is
+     * resumed by symmetric transfer once it completes. A task that is never
+     * awaited is started with Spawn.
+     */
+    template <typename T>
+    class Task
+    {
+    public:
+        using promise_type = Detail::TaskPromise<T>;
+        using HandleType = std::coroutine_handle<promise_type>;
+
+        Task() = default;
+        explicit Task(HandleType handle) : handle(handle) {}
+
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+        Task& operator=(Task&& other) noexcept
+        {
+            if(this != &other)
+            {
+                Reset();
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        ~Task()
+        {
+            Reset();
+        }
+
+        bool IsValid() const noexcept
+        {
+            return handle != nullptr;
+        }
+
+        bool IsDone() const noexcept
+        {
+            return handle && handle.done();
+        }
+
+        auto operator co_await() && noexcept
+        {
+            struct Awaiter
+            {
+                HandleType handle;
+
+                bool await_ready() noexcept
+                {
+                    return !handle || handle.done();
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+                {
+                    handle.promise().continuation = awaiting;
+                    return handle;
+                }
+
+                T await_resume()
+                {
+                    return handle.promise().TakeValue();
+                }
+            };
+            return Awaiter{handle};
+        }
+
+        /**
+         * @brief Give up ownership of the coroutine and run it until its first
+         * suspension, its frame is released when it completes.
+         */
+        void Detach() &&
+        {
+            auto detachedHandle = std::exchange(handle, nullptr);
+            detachedHandle.promise().detached = true;
+            detachedHandle.resume();
+        }
+
+    private:
+        void Reset() noexcept
+        {
+            if(handle)
+            {
+                std::exchange(handle, nullptr).destroy();
+            }
+        }
+
+        HandleType handle{};
+    };
+
+    namespace Detail
+    {
+        template <typename T>
+        Task<T> TaskPromise<T>::get_return_object() noexcept
+        {
+            return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+        }
+
+        inline Task<void> TaskPromise<void>::get_return_object() noexcept
+        {
+            return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+        }
+    }
+
+    /**
+     * @brief Start a task nobody awaits, an exception escaping it terminates.
+     */
+    inline void Spawn(Task<void> task)
+    {
+        std::move(task).Detach();
+    }
+}
+
+#endif
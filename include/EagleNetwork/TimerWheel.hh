@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_TIMER_WHEEL_HH
+#define EAGLE_NETWORK_TIMER_WHEEL_HH
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Eagle::Core
+{
+    class Timer;
+    class TimerWheel;
+
+    struct ITimerHandler
+    {
+    protected:
+        virtual ~ITimerHandler() = default;
+
+    public:
+        ITimerHandler() = default;
+        virtual void OnTimerExpired(Timer& timer) = 0;
+    };
+
+    /**
+     * Intrusive timer armed in a TimerWheel, typically embedded in the state of a
+     * connection. It is not copyable nor movable since the wheel links to it, and
+     * it is cancelled when destroyed.
+     */
+    class Timer
+    {
+    public:
+        explicit Timer(ITimerHandler& handler) : handler(&handler) {}
+        ~Timer();
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+        Timer(Timer&&) = delete;
+        Timer& operator=(Timer&&) = delete;
+
+        bool IsArmed() const
+        {
+            return wheel != nullptr;
+        }
+
+    private:
+        friend class TimerWheel;
+
+        ITimerHandler* handler;
+        TimerWheel* wheel{nullptr};
+        Timer* next{nullptr};
+        Timer** previous{nullptr};
+        std::uint64_t expiry{0};
+    };
+
+    /**
+     * Hashed hierarchical timing wheel.
+     *
+     * The first level has one slot per tick, the upper levels cover 64 times the
+     * range of the level below and are cascaded down when the first level wraps.
+     * Arm and Cancel are O(1) and allocate nothing. Pushing an armed timer's
+     * deadline further, e.g. an idle timeout refreshed on every read, only stores
+     * the new deadline: the timer is moved when its old slot comes up.
+     */
+    class TimerWheel
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr std::size_t FirstLevelBits = 8;
+        static constexpr std::size_t UpperLevelBits = 6;
+        static constexpr std::size_t UpperLevels = 3;
+
+        explicit TimerWheel(std::chrono::milliseconds resolution = std::chrono::milliseconds(1),
+            Clock::time_point start = Clock::now());
+        ~TimerWheel();
+
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        /**
+         * @brief Arm or re-arm the timer to expire after timeout.
+         *
+         * Timeouts are rounded up to the wheel resolution, past the range of the
+         * wheel the timer is re-filed each time the last level turns.
+         */
+        void Arm(Timer& timer, std::chrono::milliseconds timeout);
+
+        void Cancel(Timer& timer);
+
+        /**
+         * @brief Move the wheel to now and run the handlers of the expired timers.
+         *
+         * Expired timers are collected first then dispatched, a handler may arm or
+         * cancel any timer including the one being dispatched.
+         * @return The number of expired timers.
+         */
+        std::size_t Advance(Clock::time_point now);
+
+        /**
+         * @return Milliseconds until Advance may have timers to expire, -1 when no
+         * timer is armed. It is never later than the next expiry but may be earlier.
+         */
+        int GetNextTimeout(Clock::time_point now) const;
+
+        std::size_t GetArmedCount() const;
+
+    private:
+        static constexpr std::size_t FirstLevelSlots = std::size_t{1} << FirstLevelBits;
+        static constexpr std::size_t UpperLevelSlots = std::size_t{1} << UpperLevelBits;
+
+        static void Link(Timer*& head, Timer& timer);
+        void Unlink(Timer& timer);
+
+        void Insert(Timer& timer);
+        void Cascade(std::size_t level);
+        void CollectExpired(Timer*& expired);
+        std::uint64_t GetTick(Clock::time_point now) const;
+        std::uint64_t GetNextFirstLevelTick() const;
+
+        std::chrono::milliseconds resolution;
+        Clock::time_point start;
+        std::uint64_t currentTick{0};
+        std::size_t armedCount{0};
+        std::array<Timer*, FirstLevelSlots> firstLevel{};
+        std::array<std::uint64_t, FirstLevelSlots / 64> firstLevelOccupancy{};
+        std::array<std::array<Timer*, UpperLevelSlots>, UpperLevels> upperLevels{};
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_UNIX_ADDRESS_HH
+#define EAGLE_NETWORK_UNIX_ADDRESS_HH
+
+#include <EagleNetwork/Platform/PlatofrmDefs.hh>
+#include <EagleNetwork/Result.hh>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace Eagle::Core
+{
+    /**
+     * An AF_UNIX socket address usable with BasicSocket::Bind and BasicSocket::Connect.
+     *
+     * Filesystem addresses name a socket inode, abstract addresses (Linux only)
+     * live in a per network-namespace table and vanish with the last socket
+     * bound to them, so there is nothing to unlink.
+     */
+    class UnixAddress
+    {
+    public:
+        using AddressResult = Utilities::Result<UnixAddress, Detail::SocketPlatformErrorType::Type>;
+
+        /**
+         * @return The address of path, ENAMETOOLONG when it doesn't fit in sun_path
+         * and EINVAL when it is empty or holds a null byte.
+         */
+        static AddressResult FromPath(std::string_view path);
+
+#if defined (__linux__)
+        /**
+         * @return The abstract-namespace address of name, which may hold any bytes.
+         * ENAMETOOLONG when it doesn't fit in sun_path after the leading null byte.
+         */
+        static AddressResult FromAbstractName(std::string_view name);
+#endif
+
+        /**
+         * @brief Decode an address filled in by the kernel, e.g. by getsockname.
+         */
+        static UnixAddress FromNative(const sockaddr_un& address, socklen_t length);
+
+        const sockaddr* GetAddress() const noexcept;
+        socklen_t GetLength() const noexcept;
+
+        /**
+         * @return The path, or the abstract name without its leading null byte.
+         */
+        std::string_view GetName() const noexcept;
+        bool IsAbstract() const noexcept;
+        bool IsUnnamed() const noexcept;
+
+    private:
+        UnixAddress() = default;
+
+        sockaddr_un address{};
+        socklen_t length{};
+    };
+}
+
+#endif // EAGLE_NETWORK_UNIX_ADDRESS_HH
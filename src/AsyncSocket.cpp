@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/AsyncSocket.hh>
+#include <EagleNetwork/LatencyHistogram.hh>
+#include <cerrno>
+#include <utility>
+
+namespace
+{
+    bool IsWouldBlock(Eagle::Core::Detail::SocketPlatformErrorType::Type error)
+    {
+        return error == EAGAIN || error == EWOULDBLOCK;
+    }
+}
+
+namespace Eagle::Core
+{
+    bool AsyncSocket::ReadOperation::TryComplete()
+    {
+        auto read = socket->socket.Read(buffer);
+        if(!read.HasResult() && IsWouldBlock(read.GetError()))
+        {
+            return false;
+        }
+        result.emplace(std::move(read));
+        return true;
+    }
+
+    void AsyncSocket::ReadOperation::await_suspend(std::coroutine_handle<> handle)
+    {
+        continuation = handle;
+        socket->reader = this;
+    }
+
+    bool AsyncSocket::WriteOperation::TryComplete()
+    {
+        auto written = socket->socket.Write(buffer);
+        if(!written.HasResult() && IsWouldBlock(written.GetError()))
+        {
+            return false;
+        }
+        result.emplace(std::move(written));
+        return true;
+    }
+
+    void AsyncSocket::WriteOperation::await_suspend(std::coroutine_handle<> handle)
+    {
+        continuation = handle;
+        socket->writer = this;
+    }
+
+    bool AsyncSocket::AcceptOperation::TryComplete()
+    {
+        auto accepted = socket->socket.Accept();
+        if(!accepted.HasResult() && IsWouldBlock(accepted.GetError()))
+        {
+            return false;
+        }
+        result.emplace(std::move(accepted));
+        return true;
+    }
+
+    void AsyncSocket::AcceptOperation::await_suspend(std::coroutine_handle<> handle)
+    {
+        continuation = handle;
+        socket->reader = this;
+    }
+
+    bool AsyncSocket::ConnectOperation::await_ready()
+    {
+        if(socket->socket.GetLatencyHistograms())
+        {
+            start = std::chrono::steady_clock::now();
+        }
+
+        auto connected = socket->socket.Connect(address, length);
+        if(!connected.HasResult() && connected.GetError() == EINPROGRESS)
+        {
+            return false;
+        }
+        result.emplace(std::move(connected));
+        return true;
+    }
+
+    bool AsyncSocket::ConnectOperation::TryComplete()
+    {
+        int error = 0;
+        socklen_t errorLength = sizeof(error);
+        auto resource = socket->socket.GetSocketResource();
+        if(::getsockopt(resource, SOL_SOCKET, SO_ERROR, &error, &errorLength) == -1)
+        {
+            error = errno;
+        }
+
+        if(error == 0)
+        {
+            // Writability may be reported before the handshake completes.
+            sockaddr_storage peer{};
+            socklen_t peerLength = sizeof(peer);
+            if(::getpeername(resource, reinterpret_cast<sockaddr*>(&peer), &peerLength) == -1)
+            {
+                if(errno == ENOTCONN) return false;
+                error = errno;
+            }
+        }
+
+        if(error != 0)
+        {
+            Fail(error);
+        } else {
+            RecordLatency();
+            result.emplace();
+        }
+        return true;
+    }
+
+    void AsyncSocket::ConnectOperation::Fail(Detail::SocketPlatformErrorType::Type error)
+    {
+        RecordLatency();
+        AsyncOperationBase::Fail(error);
+    }
+
+    void AsyncSocket::ConnectOperation::RecordLatency()
+    {
+        // Covers the whole handshake of connects that went through EINPROGRESS.
+        if(auto* histograms = socket->socket.GetLatencyHistograms())
+        {
+            histograms->connect.Record(std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    void AsyncSocket::ConnectOperation::await_suspend(std::coroutine_handle<> handle)
+    {
+        continuation = handle;
+        socket->writer = this;
+    }
+
+    AsyncSocket::AsyncSocket(Reactor& reactor, BasicSocket&& socket)
+        : reactor(reactor), socket(std::move(socket))
+    {
+        if(!this->socket.SetNonBlocking(true)
+            || !reactor.Register(this->socket, *this, ReactorEvent::Read | ReactorEvent::Write))
+        {
+            throw AsyncSocketRegistrationFailure();
+        }
+    }
+
+    AsyncSocket::~AsyncSocket()
+    {
+        reactor.Unregister(socket);
+    }
+
+    AsyncSocket::ReadOperation AsyncSocket::Read(std::span<std::byte> buffer)
+    {
+        return ReadOperation(*this, buffer);
+    }
+
+    AsyncSocket::WriteOperation AsyncSocket::Write(std::span<const std::byte> buffer)
+    {
+        return WriteOperation(*this, buffer);
+    }
+
+    Task<Detail::SocketIOResult> AsyncSocket::WriteAll(std::span<const std::byte> buffer)
+    {
+        std::size_t total = 0;
+        while(total < buffer.size())
+        {
+            auto written = co_await Write(buffer.subspan(total));
+            if(!written.HasResult())
+            {
+                co_return written;
+            }
+            total += written.GetResult();
+        }
+        co_return total;
+    }
+
+    AsyncSocket::AcceptOperation AsyncSocket::Accept()
+    {
+        return AcceptOperation(*this);
+    }
+
+    AsyncSocket::ConnectOperation AsyncSocket::Connect(const sockaddr* address, socklen_t length)
+    {
+        return ConnectOperation(*this, address, length);
+    }
+
+    BasicSocket& AsyncSocket::GetSocket()
+    {
+        return socket;
+    }
+
+    Reactor& AsyncSocket::GetReactor()
+    {
+        return reactor;
+    }
+
+    void AsyncSocket::Resume(Detail::AsyncOperation*& pending, bool failed, Detail::SocketPlatformErrorType::Type error)
+    {
+        auto* operation = pending;
+        if(!operation)
+        {
+            return;
+        }
+
+        if(failed)
+        {
+            operation->Fail(error);
+        } else if(!operation->TryComplete()) {
+            return;
+        }
+
+        // The resumed coroutine may destroy this socket, nothing is touched afterwards.
+        pending = nullptr;
+        operation->continuation.resume();
+    }
+
+    void AsyncSocket::OnReadable(BasicSocket&)
+    {
+        Resume(reader, false, 0);
+    }
+
+    void AsyncSocket::OnWritable(BasicSocket&)
+    {
+        Resume(writer, false, 0);
+    }
+
+    void AsyncSocket::OnError(BasicSocket&, Detail::SocketPlatformErrorType::Type error)
+    {
+        // SO_ERROR was consumed by the reactor, hand it to both sides before any
+        // resumed coroutine gets a chance to destroy this socket.
+        auto* pendingReader = std::exchange(reader, nullptr);
+        auto* pendingWriter = std::exchange(writer, nullptr);
+        Resume(pendingReader, true, error);
+        Resume(pendingWriter, true, error);
+    }
+}
@@ -0,0 +1,261 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Buffer.hh>
+#include <EagleNetwork/PoolAllocator.hh>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace Eagle::Core
+{
+    namespace Detail
+    {
+        BufferSlab* BufferSlab::Allocate(std::size_t capacity)
+        {
+            auto* memory = PoolAllocator::ForCurrentThread().Allocate(sizeof(BufferSlab) + capacity);
+            auto* slab = new(memory) BufferSlab{};
+            slab->references.store(1, std::memory_order_relaxed);
+            slab->capacity = capacity;
+            slab->size = 0;
+            return slab;
+        }
+
+        void BufferSlab::Acquire(BufferSlab* slab)
+        {
+            slab->references.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void BufferSlab::Release(BufferSlab* slab)
+        {
+            if(slab->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                auto capacity = slab->capacity;
+                slab->~BufferSlab();
+                PoolAllocator::ForCurrentThread().Deallocate(slab, sizeof(BufferSlab) + capacity);
+            }
+        }
+    }
+
+    ChainedBuffer::ChainedBuffer(std::size_t slabCapacity)
+        : slabCapacity(std::max<std::size_t>(slabCapacity, 1))
+    {}
+
+    ChainedBuffer::~ChainedBuffer()
+    {
+        Clear();
+    }
+
+    ChainedBuffer::ChainedBuffer(const ChainedBuffer& other)
+        : slabCapacity(other.slabCapacity)
+    {
+        Append(other);
+    }
+
+    ChainedBuffer& ChainedBuffer::operator=(const ChainedBuffer& other)
+    {
+        if(this != &other)
+        {
+            Clear();
+            slabCapacity = other.slabCapacity;
+            Append(other);
+        }
+        return *this;
+    }
+
+    ChainedBuffer::ChainedBuffer(ChainedBuffer&& other) noexcept
+        : segments(std::move(other.segments)), size(std::exchange(other.size, 0)), slabCapacity(other.slabCapacity)
+    {
+        other.segments.clear();
+    }
+
+    ChainedBuffer& ChainedBuffer::operator=(ChainedBuffer&& other) noexcept
+    {
+        if(this != &other)
+        {
+            Clear();
+            segments = std::move(other.segments);
+            other.segments.clear();
+            size = std::exchange(other.size, 0);
+            slabCapacity = other.slabCapacity;
+        }
+        return *this;
+    }
+
+    std::size_t ChainedBuffer::Size() const
+    {
+        return size;
+    }
+
+    bool ChainedBuffer::IsEmpty() const
+    {
+        return size == 0;
+    }
+
+    std::size_t ChainedBuffer::GetSegmentCount() const
+    {
+        return segments.size();
+    }
+
+    void ChainedBuffer::Append(std::span<const std::byte> bytes)
+    {
+        while(!bytes.empty())
+        {
+            auto writable = PrepareWrite();
+            auto count = std::min(writable.size(), bytes.size());
+            std::memcpy(writable.data(), bytes.data(), count);
+            Commit(count);
+            bytes = bytes.subspan(count);
+        }
+    }
+
+    void ChainedBuffer::Append(const ChainedBuffer& other)
+    {
+        for(const auto& segment : other.segments)
+        {
+            Detail::BufferSlab::Acquire(segment.slab);
+            segments.push_back(segment);
+        }
+        size += other.size;
+    }
+
+    std::span<std::byte> ChainedBuffer::PrepareWrite(std::size_t minimum)
+    {
+        if(!segments.empty())
+        {
+            auto& tail = segments.back();
+            auto* slab = tail.slab;
+            bool ownsTail = slab->references.load(std::memory_order_acquire) == 1
+                && tail.offset + tail.length == slab->size;
+            if(ownsTail && slab->capacity - slab->size >= minimum)
+            {
+                return {slab->Data() + slab->size, slab->capacity - slab->size};
+            }
+        }
+
+        auto* slab = Detail::BufferSlab::Allocate(std::max(slabCapacity, minimum));
+        segments.push_back({slab, 0, 0});
+        return {slab->Data(), slab->capacity};
+    }
+
+    void ChainedBuffer::Commit(std::size_t count)
+    {
+        if(count == 0 || segments.empty()) return;
+
+        auto& tail = segments.back();
+        tail.length += count;
+        tail.slab->size += count;
+        size += count;
+    }
+
+    void ChainedBuffer::Consume(std::size_t count)
+    {
+        count = std::min(count, size);
+        size -= count;
+        while(count > 0)
+        {
+            auto& head = segments.front();
+            if(head.length > count)
+            {
+                head.offset += count;
+                head.length -= count;
+                return;
+            }
+
+            count -= head.length;
+            Detail::BufferSlab::Release(head.slab);
+            segments.pop_front();
+        }
+
+        // Drop the empty segments PrepareWrite may have left behind.
+        while(!segments.empty() && segments.front().length == 0 && size == 0)
+        {
+            Detail::BufferSlab::Release(segments.front().slab);
+            segments.pop_front();
+        }
+    }
+
+    ChainedBuffer ChainedBuffer::Slice(std::size_t offset, std::size_t count) const
+    {
+        ChainedBuffer slice(slabCapacity);
+        for(const auto& segment : segments)
+        {
+            if(count == 0) break;
+            if(offset >= segment.length)
+            {
+                offset -= segment.length;
+                continue;
+            }
+
+            auto length = std::min(segment.length - offset, count);
+            Detail::BufferSlab::Acquire(segment.slab);
+            slice.segments.push_back({segment.slab, segment.offset + offset, length});
+            slice.size += length;
+            count -= length;
+            offset = 0;
+        }
+        return slice;
+    }
+
+    ChainedBuffer ChainedBuffer::Split(std::size_t count)
+    {
+        auto head = Slice(0, count);
+        Consume(head.Size());
+        return head;
+    }
+
+    std::size_t ChainedBuffer::ExportVectors(std::span<iovec> vectors) const
+    {
+        std::size_t exported = 0;
+        for(const auto& segment : segments)
+        {
+            if(exported == vectors.size()) break;
+            if(segment.length == 0) continue;
+            vectors[exported++] = {segment.slab->Data() + segment.offset, segment.length};
+        }
+        return exported;
+    }
+
+    std::size_t ChainedBuffer::CopyTo(std::span<std::byte> destination) const
+    {
+        std::size_t copied = 0;
+        for(const auto& segment : segments)
+        {
+            if(copied == destination.size()) break;
+            auto count = std::min(segment.length, destination.size() - copied);
+            std::memcpy(destination.data() + copied, segment.slab->Data() + segment.offset, count);
+            copied += count;
+        }
+        return copied;
+    }
+
+    void ChainedBuffer::Clear()
+    {
+        for(const auto& segment : segments)
+        {
+            Detail::BufferSlab::Release(segment.slab);
+        }
+        segments.clear();
+        size = 0;
+    }
+}
@@ -0,0 +1,503 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/CompletionEngine.hh>
+#include <EagleNetwork/Metrics.hh>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    int IoUringSetup(unsigned entries, io_uring_params* params)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int IoUringEnter(int resource, unsigned toSubmit, unsigned minComplete, unsigned flags)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, resource, toSubmit, minComplete, flags, nullptr, 0));
+    }
+
+    template <typename T>
+    T LoadAcquire(T* value)
+    {
+        return std::atomic_ref<T>(*value).load(std::memory_order_acquire);
+    }
+
+    template <typename T>
+    void StoreRelease(T* value, T newValue)
+    {
+        std::atomic_ref<T>(*value).store(newValue, std::memory_order_release);
+    }
+
+    /**
+     * Memory mapped submission and completion queues of an io_uring instance.
+     */
+    struct IoUringQueues
+    {
+        int resource{-1};
+        void* sqRing{MAP_FAILED};
+        std::size_t sqRingSize{0};
+        void* cqRing{MAP_FAILED};
+        std::size_t cqRingSize{0};
+        io_uring_sqe* sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+        std::size_t sqesSize{0};
+
+        unsigned* sqHead{nullptr};
+        unsigned* sqTail{nullptr};
+        unsigned* sqArray{nullptr};
+        unsigned sqMask{0};
+        unsigned sqEntries{0};
+
+        unsigned* cqHead{nullptr};
+        unsigned* cqTail{nullptr};
+        io_uring_cqe* cqes{nullptr};
+        unsigned cqMask{0};
+        unsigned cqEntries{0};
+
+        bool Setup(unsigned entries)
+        {
+            io_uring_params params{};
+            resource = IoUringSetup(entries, &params);
+            if(resource < 0)
+            {
+                resource = -1;
+                return false;
+            }
+
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+            if(singleMap)
+            {
+                sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+            }
+
+            sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                resource, IORING_OFF_SQ_RING);
+            if(sqRing == MAP_FAILED)
+            {
+                Release();
+                return false;
+            }
+
+            cqRing = singleMap ? sqRing : ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, resource, IORING_OFF_CQ_RING);
+            if(cqRing == MAP_FAILED)
+            {
+                Release();
+                return false;
+            }
+
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, resource, IORING_OFF_SQES));
+            if(sqes == MAP_FAILED)
+            {
+                Release();
+                return false;
+            }
+
+            auto* sq = static_cast<char*>(sqRing);
+            sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqEntries = params.sq_entries;
+
+            auto* cq = static_cast<char*>(cqRing);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqEntries = params.cq_entries;
+            return true;
+        }
+
+        /**
+         * Unmap the rings and close the ring resource, also after a partial Setup
+         * so a fallback to the readiness backend doesn't keep them.
+         */
+        void Release()
+        {
+            if(sqes != MAP_FAILED) ::munmap(sqes, sqesSize);
+            if(cqRing != MAP_FAILED && cqRing != sqRing) ::munmap(cqRing, cqRingSize);
+            if(sqRing != MAP_FAILED) ::munmap(sqRing, sqRingSize);
+            if(resource != -1) ::close(resource);
+            sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+            cqRing = sqRing = MAP_FAILED;
+            resource = -1;
+        }
+
+        ~IoUringQueues()
+        {
+            Release();
+        }
+    };
+
+#if defined (MSG_NOSIGNAL)
+    constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+    constexpr int SendFlags = 0;
+#endif
+
+    constexpr std::uint32_t EpollRegistered = 1u << 31;
+}
+
+namespace Eagle::Core
+{
+    struct CompletionEngine::CompletionEngineImpl
+    {
+        struct OperationSlot
+        {
+            bool output{false};
+            Detail::SocketResourceType::ResourceType resource{-1};
+            void* buffer{nullptr};
+            std::size_t size{0};
+            std::size_t* transferred{nullptr};
+            std::uint64_t tag{0};
+        };
+
+        CompletionEngineBackend backend{CompletionEngineBackend::Readiness};
+        std::vector<OperationSlot> slots;
+        std::vector<std::uint32_t> freeSlots;
+        std::size_t inFlight{0};
+
+        // io_uring backend.
+        IoUringQueues queues;
+        unsigned sqLocalTail{0};
+        unsigned unsubmitted{0};
+
+        // Readiness backend.
+        int epollResource{-1};
+        std::vector<std::uint32_t> prepared;
+        std::vector<std::uint32_t> pending;
+        std::vector<IOCompletion> ready;
+        std::vector<std::uint32_t> armed;
+        std::vector<epoll_event> events;
+
+        ~CompletionEngineImpl()
+        {
+            if(epollResource != -1) ::close(epollResource);
+        }
+
+        void InitializeSlots(std::size_t count)
+        {
+            slots.resize(count);
+            freeSlots.reserve(count);
+            for(std::size_t i = count; i > 0; --i)
+            {
+                freeSlots.push_back(static_cast<std::uint32_t>(i - 1));
+            }
+        }
+
+        IOCompletion Complete(std::uint32_t index, int result)
+        {
+            auto& slot = slots[index];
+            if(result >= 0) *slot.transferred = static_cast<std::size_t>(result);
+            freeSlots.push_back(index);
+            --inFlight;
+            return {slot.tag, result};
+        }
+
+        // Perform a non-blocking attempt, false if the operation would block.
+        bool Attempt(std::uint32_t index)
+        {
+            auto& slot = slots[index];
+            ssize_t result;
+            do {
+                result = slot.output
+                    ? ::send(slot.resource, slot.buffer, slot.size, SendFlags | MSG_DONTWAIT)
+                    : ::recv(slot.resource, slot.buffer, slot.size, MSG_DONTWAIT);
+            } while(result == -1 && errno == EINTR);
+
+            if(slot.output)
+            {
+                Metrics::RecordWrite(result, slot.size);
+            } else {
+                Metrics::RecordRead(result);
+            }
+
+            if(result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                return false;
+            }
+
+            ready.push_back(Complete(index, result == -1 ? -errno : static_cast<int>(result)));
+            return true;
+        }
+
+        void AttemptPending()
+        {
+            std::size_t kept = 0;
+            for(auto index : pending)
+            {
+                if(!Attempt(index)) pending[kept++] = index;
+            }
+            pending.resize(kept);
+        }
+
+        bool ArmPending()
+        {
+            for(auto index : pending)
+            {
+                auto resource = slots[index].resource;
+                std::uint32_t wanted = slots[index].output ? EPOLLOUT : EPOLLIN;
+                if(static_cast<std::size_t>(resource) >= armed.size())
+                {
+                    armed.resize(static_cast<std::size_t>(resource) + 1, 0);
+                }
+
+                auto& state = armed[resource];
+                if((state & wanted) == wanted) continue;
+
+                epoll_event event{};
+                event.events = (state & ~EpollRegistered) | wanted | EPOLLONESHOT;
+                event.data.fd = resource;
+                int result = -1;
+                if(state & EpollRegistered)
+                {
+                    result = ::epoll_ctl(epollResource, EPOLL_CTL_MOD, resource, &event);
+                }
+                if(result == -1)
+                {
+                    // The resource may have been closed and removed from the set meanwhile.
+                    result = ::epoll_ctl(epollResource, EPOLL_CTL_ADD, resource, &event);
+                }
+                if(result == -1) return false;
+                state = EpollRegistered | (event.events & (EPOLLIN | EPOLLOUT));
+            }
+            return true;
+        }
+
+        std::size_t DrainReady(std::span<IOCompletion> completions)
+        {
+            auto count = std::min(completions.size(), ready.size());
+            std::copy_n(ready.begin(), count, completions.begin());
+            ready.erase(ready.begin(), ready.begin() + static_cast<std::ptrdiff_t>(count));
+            return count;
+        }
+
+        // The kernel transferred the bytes, the io_uring_enter calls are counted separately.
+        static void RecordCompletion(const OperationSlot& slot, int result)
+        {
+            if(result < 0) return;
+            if(!slot.output)
+            {
+                Metrics::Add(Metric::SocketBytesRead, static_cast<std::uint64_t>(result));
+                return;
+            }
+
+            Metrics::Add(Metric::SocketBytesWritten, static_cast<std::uint64_t>(result));
+            if(static_cast<std::size_t>(result) < slot.size)
+            {
+                Metrics::Add(Metric::SocketPartialWrites);
+            }
+        }
+
+        std::size_t ReapQueues(std::span<IOCompletion> completions)
+        {
+            unsigned head = *queues.cqHead;
+            unsigned tail = LoadAcquire(queues.cqTail);
+            std::size_t count = 0;
+            while(head != tail && count < completions.size())
+            {
+                auto& cqe = queues.cqes[head & queues.cqMask];
+                RecordCompletion(slots[static_cast<std::uint32_t>(cqe.user_data)], cqe.res);
+                completions[count++] = Complete(static_cast<std::uint32_t>(cqe.user_data), cqe.res);
+                ++head;
+            }
+            StoreRelease(queues.cqHead, head);
+            return count;
+        }
+    };
+
+    CompletionEngine::CompletionEngine(unsigned entries, CompletionEngineBackend backend)
+        : impl(std::make_unique<CompletionEngineImpl>())
+    {
+        entries = std::max(entries, 1u);
+        if(backend != CompletionEngineBackend::Readiness && impl->queues.Setup(entries))
+        {
+            impl->backend = CompletionEngineBackend::IoUring;
+            impl->sqLocalTail = *impl->queues.sqTail;
+            // Never keep more operations than the completion queue can hold.
+            impl->InitializeSlots(impl->queues.cqEntries);
+            return;
+        }
+
+        if(backend == CompletionEngineBackend::IoUring)
+        {
+            throw CompletionEngineCreationFailure();
+        }
+
+        impl->epollResource = ::epoll_create1(EPOLL_CLOEXEC);
+        if(impl->epollResource == -1)
+        {
+            throw CompletionEngineCreationFailure();
+        }
+        impl->backend = CompletionEngineBackend::Readiness;
+        impl->InitializeSlots(entries);
+        impl->prepared.reserve(entries);
+        impl->pending.reserve(entries);
+        impl->ready.reserve(entries);
+        impl->events.resize(std::min(entries, 1024u));
+    }
+
+    CompletionEngine::~CompletionEngine() = default;
+
+    CompletionEngineBackend CompletionEngine::GetBackend() const
+    {
+        return impl->backend;
+    }
+
+    bool CompletionEngine::PrepareOperation(bool output, Detail::SocketResourceType::ResourceType resource,
+        void* buffer, std::size_t size, std::size_t* transferred, std::uint64_t tag)
+    {
+        if(impl->freeSlots.empty())
+        {
+            return false;
+        }
+
+        auto index = impl->freeSlots.back();
+        if(impl->backend == CompletionEngineBackend::IoUring)
+        {
+            auto& queues = impl->queues;
+            if(impl->sqLocalTail - LoadAcquire(queues.sqHead) >= queues.sqEntries)
+            {
+                return false;
+            }
+
+            auto position = impl->sqLocalTail & queues.sqMask;
+            auto& sqe = queues.sqes[position];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = output ? IORING_OP_SEND : IORING_OP_RECV;
+            sqe.fd = resource;
+            sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+            sqe.len = static_cast<std::uint32_t>(size);
+            sqe.msg_flags = output ? SendFlags : 0;
+            sqe.user_data = index;
+            queues.sqArray[position] = position;
+            StoreRelease(queues.sqTail, ++impl->sqLocalTail);
+            ++impl->unsubmitted;
+        } else {
+            impl->prepared.push_back(index);
+        }
+
+        impl->freeSlots.pop_back();
+        impl->slots[index] = {output, resource, buffer, size, transferred, tag};
+        return true;
+    }
+
+    Detail::SocketIOResult CompletionEngine::Submit()
+    {
+        if(impl->backend == CompletionEngineBackend::IoUring)
+        {
+            if(impl->unsubmitted == 0) return std::size_t{0};
+
+            int submitted = IoUringEnter(impl->queues.resource, impl->unsubmitted, 0, 0);
+            Metrics::Add(Metric::SocketSyscalls);
+            if(submitted < 0)
+            {
+                return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+            }
+            impl->unsubmitted -= static_cast<unsigned>(submitted);
+            impl->inFlight += static_cast<std::size_t>(submitted);
+            return static_cast<std::size_t>(submitted);
+        }
+
+        auto submitted = impl->prepared.size();
+        impl->inFlight += submitted;
+        for(auto index : impl->prepared)
+        {
+            if(!impl->Attempt(index)) impl->pending.push_back(index);
+        }
+        impl->prepared.clear();
+        return submitted;
+    }
+
+    Detail::SocketIOResult CompletionEngine::Reap(std::span<IOCompletion> completions, bool wait)
+    {
+        if(completions.empty()) return std::size_t{0};
+
+        if(impl->backend == CompletionEngineBackend::IoUring)
+        {
+            auto count = impl->ReapQueues(completions);
+            while(count == 0 && wait && impl->inFlight > 0)
+            {
+                auto entered = IoUringEnter(impl->queues.resource, 0, 1, IORING_ENTER_GETEVENTS);
+                Metrics::Add(Metric::SocketSyscalls);
+                if(entered < 0 && errno != EINTR)
+                {
+                    return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+                }
+                count = impl->ReapQueues(completions);
+            }
+            return count;
+        }
+
+        auto count = impl->DrainReady(completions);
+        if(count == 0 && !impl->pending.empty())
+        {
+            impl->AttemptPending();
+            count = impl->DrainReady(completions);
+        }
+
+        while(count == 0 && wait && !impl->pending.empty())
+        {
+            if(!impl->ArmPending())
+            {
+                return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+            }
+
+            int events = ::epoll_wait(impl->epollResource, impl->events.data(),
+                static_cast<int>(impl->events.size()), -1);
+            Metrics::Add(Metric::SocketSyscalls);
+            if(events == -1 && errno != EINTR)
+            {
+                return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+            }
+
+            for(int i = 0; i < events; ++i)
+            {
+                // One-shot registrations are disabled once reported.
+                impl->armed[impl->events[i].data.fd] &= EpollRegistered;
+            }
+
+            impl->AttemptPending();
+            count = impl->DrainReady(completions);
+        }
+        return count;
+    }
+
+    std::size_t CompletionEngine::GetInFlightCount() const
+    {
+        return impl->inFlight;
+    }
+}
@@ -0,0 +1,197 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Datagram.hh>
+#include <EagleNetwork/Metrics.hh>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+namespace Eagle::Core
+{
+    DatagramBatch::DatagramBatch(std::size_t capacity)
+        : headers(std::max<std::size_t>(capacity, 1)), vectors(headers.size()), addresses(headers.size()),
+          addressLengths(headers.size())
+    {
+        for(std::size_t i = 0; i < headers.size(); ++i)
+        {
+            headers[i].msg_hdr.msg_iov = &vectors[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    std::size_t DatagramBatch::GetCapacity() const
+    {
+        return headers.size();
+    }
+
+    void DatagramBatch::SetMessage(std::size_t index, void* buffer, std::size_t size)
+    {
+        vectors[index].iov_base = buffer;
+        vectors[index].iov_len = size;
+        headers[index].msg_len = 0;
+        headers[index].msg_hdr.msg_flags = 0;
+        headers[index].msg_hdr.msg_name = nullptr;
+        headers[index].msg_hdr.msg_namelen = 0;
+    }
+
+    void DatagramBatch::SetAddress(std::size_t index, socklen_t length)
+    {
+        headers[index].msg_hdr.msg_name = &addresses[index];
+        headers[index].msg_hdr.msg_namelen = length;
+    }
+
+    Detail::SocketIOResult DatagramBatch::ReceiveMessages(Detail::SocketResourceType::ResourceType resource,
+        std::size_t count)
+    {
+        int received;
+        do {
+            received = ::recvmmsg(resource, headers.data(), static_cast<unsigned>(count), MSG_WAITFORONE, nullptr);
+        } while(received == -1 && errno == EINTR);
+
+        if(received == -1)
+        {
+            Metrics::RecordRead(-1);
+            receivedCount = 0;
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+
+        receivedCount = static_cast<std::size_t>(received);
+        ssize_t bytes = 0;
+        for(std::size_t i = 0; i < receivedCount; ++i)
+        {
+            addressLengths[i] = headers[i].msg_hdr.msg_namelen;
+            bytes += static_cast<ssize_t>(headers[i].msg_len);
+        }
+        Metrics::RecordRead(bytes);
+        return receivedCount;
+    }
+
+    Detail::SocketIOResult DatagramBatch::SendMessages(Detail::SocketResourceType::ResourceType resource,
+        std::size_t count)
+    {
+        int sent;
+        do {
+            sent = ::sendmmsg(resource, headers.data(), static_cast<unsigned>(count), MSG_NOSIGNAL);
+        } while(sent == -1 && errno == EINTR);
+
+        std::size_t requested = 0;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            requested += vectors[i].iov_len;
+        }
+
+        if(sent == -1)
+        {
+            Metrics::RecordWrite(-1, requested);
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+
+        ssize_t bytes = 0;
+        for(int i = 0; i < sent; ++i)
+        {
+            bytes += static_cast<ssize_t>(headers[i].msg_len);
+        }
+        Metrics::RecordWrite(bytes, requested);
+        return static_cast<std::size_t>(sent);
+    }
+
+    Detail::SocketIOResult DatagramBatch::SendSegmented(BasicSocket& socket, std::span<const std::byte> payload,
+        std::uint16_t segmentSize)
+    {
+        iovec vector{const_cast<std::byte*>(payload.data()), payload.size()};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(std::uint16_t))]{};
+
+        msghdr message{};
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        auto* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_UDP;
+        header->cmsg_type = UDP_SEGMENT;
+        header->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+        std::memcpy(CMSG_DATA(header), &segmentSize, sizeof(segmentSize));
+
+        ssize_t sent;
+        do {
+            sent = ::sendmsg(socket.GetSocketResource(), &message, MSG_NOSIGNAL);
+        } while(sent == -1 && errno == EINTR);
+        Metrics::RecordWrite(sent, payload.size());
+
+        if(sent == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return static_cast<std::size_t>(sent);
+    }
+
+    Utilities::Result<CoalescedDatagrams, Detail::SocketPlatformErrorType::Type>
+        DatagramBatch::ReceiveCoalesced(BasicSocket& socket, std::span<std::byte> buffer)
+    {
+        iovec vector{buffer.data(), buffer.size()};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))]{};
+
+        msghdr message{};
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t received;
+        do {
+            received = ::recvmsg(socket.GetSocketResource(), &message, 0);
+        } while(received == -1 && errno == EINTR);
+        Metrics::RecordRead(received);
+
+        if(received == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+
+        CoalescedDatagrams datagrams{static_cast<std::size_t>(received), static_cast<std::size_t>(received)};
+        for(auto* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header))
+        {
+            if(header->cmsg_level == SOL_UDP && header->cmsg_type == UDP_GRO)
+            {
+                int segmentSize = 0;
+                std::memcpy(&segmentSize, CMSG_DATA(header), sizeof(segmentSize));
+                datagrams.segmentSize = static_cast<std::size_t>(segmentSize);
+            }
+        }
+        return datagrams;
+    }
+
+    bool DatagramBatch::EnableSegmentation(BasicSocket& socket, std::uint16_t segmentSize)
+    {
+        int value = segmentSize;
+        return ::setsockopt(socket.GetSocketResource(), SOL_UDP, UDP_SEGMENT, &value, sizeof(value)) == 0;
+    }
+
+    bool DatagramBatch::EnableReceiveOffload(BasicSocket& socket)
+    {
+        int enabled = 1;
+        return ::setsockopt(socket.GetSocketResource(), SOL_UDP, UDP_GRO, &enabled, sizeof(enabled)) == 0;
+    }
+}
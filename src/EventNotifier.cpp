@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/EventNotifier.hh>
+#include <cerrno>
+#include <cstdint>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Eagle::Core
+{
+    EventNotifier::EventNotifier()
+    {
+        auto eventResource = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(eventResource == -1)
+        {
+            throw EventNotifierCreationFailure();
+        }
+        resource = eventResource;
+    }
+
+    bool EventNotifier::Notify()
+    {
+        if(pending.exchange(true, std::memory_order_acq_rel))
+        {
+            return false;
+        }
+
+        std::uint64_t increment = 1;
+        ssize_t written;
+        do {
+            written = ::write(resource.GetSocketResource(), &increment, sizeof(increment));
+        } while(written == -1 && errno == EINTR);
+        return true;
+    }
+
+    bool EventNotifier::Consume()
+    {
+        // acq_rel pairs with the producers' exchange so everything they published
+        // before notifying is visible to the drain that follows.
+        if(!pending.exchange(false, std::memory_order_acq_rel))
+        {
+            return false;
+        }
+
+        std::uint64_t counter;
+        ssize_t received;
+        do {
+            received = ::read(resource.GetSocketResource(), &counter, sizeof(counter));
+        } while(received == -1 && errno == EINTR);
+        return true;
+    }
+
+    BasicSocket& EventNotifier::GetSocket()
+    {
+        return resource;
+    }
+}
@@ -0,0 +1,233 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Executor.hh>
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+    thread_local const void* currentExecutor = nullptr;
+    thread_local void* currentWorker = nullptr;
+}
+
+namespace Eagle::Core
+{
+    struct Executor::Worker
+    {
+        std::size_t index{0};
+        Detail::WorkStealingDeque<Detail::ExecutorTask*> deque;
+        std::uint64_t victimSeed{0};
+        alignas(64) std::atomic<std::size_t> executed{0};
+        std::atomic<std::size_t> steals{0};
+        std::thread thread;
+    };
+
+    Executor::Executor(std::size_t workerCount)
+    {
+        if(workerCount == 0)
+        {
+            workerCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        workers.reserve(workerCount);
+        for(std::size_t i = 0; i < workerCount; ++i)
+        {
+            auto worker = std::make_unique<Worker>();
+            worker->index = i;
+            worker->victimSeed = 0x9E3779B97F4A7C15ull * (i + 1);
+            workers.push_back(std::move(worker));
+        }
+
+        // Start once every deque exists since workers steal from each other.
+        for(auto& worker : workers)
+        {
+            worker->thread = std::thread([this, worker = worker.get()] { WorkerLoop(*worker); });
+        }
+    }
+
+    Executor::~Executor()
+    {
+        Shutdown();
+
+        // A worker that called Shutdown itself is left to be joined here.
+        for(auto& worker : workers)
+        {
+            if(worker->thread.joinable()) worker->thread.join();
+        }
+    }
+
+    bool Executor::Enqueue(Detail::ExecutorTask* task)
+    {
+        if(currentExecutor == this)
+        {
+            // Posted by a task: keep it on this worker, it stays hot in its cache
+            // and can't be lost to shutdown since the worker is still running.
+            queued.fetch_add(1, std::memory_order_seq_cst);
+            static_cast<Worker*>(currentWorker)->deque.Push(task);
+        } else {
+            std::lock_guard lock(mutex);
+            if(stopping)
+            {
+                delete task;
+                return false;
+            }
+            injected.push_back(task);
+            injectedPending.store(true, std::memory_order_relaxed);
+            queued.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        if(sleeping.load(std::memory_order_seq_cst) > 0)
+        {
+            std::lock_guard lock(mutex);
+            available.notify_one();
+        }
+        return true;
+    }
+
+    Detail::ExecutorTask* Executor::FindTask(Worker& worker)
+    {
+        if(auto* task = worker.deque.Take())
+        {
+            return task;
+        }
+
+        if(injectedPending.load(std::memory_order_relaxed))
+        {
+            std::lock_guard lock(mutex);
+            if(!injected.empty())
+            {
+                auto* task = injected.front();
+                injected.pop_front();
+                injectedPending.store(!injected.empty(), std::memory_order_relaxed);
+                return task;
+            }
+        }
+
+        // xorshift picks where to start so thieves don't all hit the same victim.
+        auto& seed = worker.victimSeed;
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        auto count = workers.size();
+        auto start = static_cast<std::size_t>(seed % count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            auto& victim = *workers[(start + i) % count];
+            if(&victim == &worker) continue;
+
+            if(auto* task = victim.deque.Steal())
+            {
+                worker.steals.fetch_add(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void Executor::WorkerLoop(Worker& worker)
+    {
+        currentExecutor = this;
+        currentWorker = &worker;
+
+        while(true)
+        {
+            if(auto* task = FindTask(worker))
+            {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                task->Run();
+                delete task;
+                worker.executed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            std::unique_lock lock(mutex);
+            if(queued.load(std::memory_order_seq_cst) > 0)
+            {
+                // Another thread holds the task right now, e.g. a thief between
+                // its Steal and the counter update, look again.
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            if(stopping)
+            {
+                break;
+            }
+
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            available.wait(lock, [this] { return stopping || queued.load(std::memory_order_seq_cst) > 0; });
+            sleeping.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        currentExecutor = nullptr;
+        currentWorker = nullptr;
+    }
+
+    void Executor::Shutdown()
+    {
+        {
+            std::lock_guard lock(mutex);
+            if(stopping) return;
+            stopping = true;
+        }
+        available.notify_all();
+
+        // A worker can't join itself, it stops once its current task returns.
+        auto* caller = currentExecutor == this ? static_cast<Worker*>(currentWorker) : nullptr;
+        for(auto& worker : workers)
+        {
+            if(worker.get() != caller && worker->thread.joinable()) worker->thread.join();
+        }
+    }
+
+    std::size_t Executor::GetWorkerCount() const
+    {
+        return workers.size();
+    }
+
+    std::size_t Executor::GetQueueDepth() const
+    {
+        return queued.load(std::memory_order_relaxed);
+    }
+
+    std::size_t Executor::GetStealCount() const
+    {
+        std::size_t steals = 0;
+        for(const auto& worker : workers)
+        {
+            steals += worker->steals.load(std::memory_order_relaxed);
+        }
+        return steals;
+    }
+
+    ExecutorStatistics Executor::GetStatistics() const
+    {
+        ExecutorStatistics statistics{.queued = GetQueueDepth()};
+        for(const auto& worker : workers)
+        {
+            statistics.executed += worker->executed.load(std::memory_order_relaxed);
+            statistics.steals += worker->steals.load(std::memory_order_relaxed);
+        }
+        return statistics;
+    }
+}
@@ -0,0 +1,308 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Framing.hh>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <immintrin.h>
+#endif
+
+namespace Eagle::Core
+{
+    namespace
+    {
+        constexpr std::size_t InitialStorageSize = 16 * 1024;
+
+        const std::byte* AsBytes(const void* data)
+        {
+            return static_cast<const std::byte*>(data);
+        }
+
+        /**
+         * Check the candidates of a vector: each set bit of mask marks an offset
+         * whose first and last bytes match the delimiter's.
+         */
+        template <typename TMask>
+        std::size_t MatchCandidates(TMask mask, const std::byte* position, std::span<const std::byte> delimiter)
+        {
+            while(mask != 0)
+            {
+                auto bit = static_cast<std::size_t>(std::countr_zero(mask));
+                if(delimiter.size() <= 2 ||
+                    std::memcmp(position + bit + 1, delimiter.data() + 1, delimiter.size() - 2) == 0)
+                {
+                    return bit;
+                }
+                mask &= mask - 1;
+            }
+            return SIZE_MAX;
+        }
+
+        std::size_t FindDelimiterScalar(std::span<const std::byte> bytes, std::span<const std::byte> delimiter,
+            std::size_t offset)
+        {
+            auto length = delimiter.size();
+            while(offset + length <= bytes.size())
+            {
+                auto* candidate = ::memchr(bytes.data() + offset, std::to_integer<int>(delimiter[0]),
+                    bytes.size() - length + 1 - offset);
+                if(!candidate) break;
+
+                offset = static_cast<std::size_t>(AsBytes(candidate) - bytes.data());
+                if(std::memcmp(bytes.data() + offset, delimiter.data(), length) == 0) return offset;
+                ++offset;
+            }
+            return bytes.size();
+        }
+
+#if defined (__SSE2__)
+        std::size_t FindDelimiterSse2(std::span<const std::byte> bytes, std::span<const std::byte> delimiter)
+        {
+            constexpr std::size_t Width = 16;
+            auto last = delimiter.size() - 1;
+            auto first = _mm_set1_epi8(std::to_integer<char>(delimiter.front()));
+            auto final = _mm_set1_epi8(std::to_integer<char>(delimiter.back()));
+
+            std::size_t offset = 0;
+            for(; offset + last + Width <= bytes.size(); offset += Width)
+            {
+                auto* position = bytes.data() + offset;
+                auto starts = _mm_cmpeq_epi8(first, _mm_loadu_si128(reinterpret_cast<const __m128i*>(position)));
+                auto ends = _mm_cmpeq_epi8(final,
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(position + last)));
+                auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(starts, ends)));
+                if(auto bit = MatchCandidates(mask, position, delimiter); bit != SIZE_MAX) return offset + bit;
+            }
+            return FindDelimiterScalar(bytes, delimiter, offset);
+        }
+#endif
+
+#if (defined (__x86_64__) || defined (__i386__)) && defined (__GNUC__)
+#define EAGLE_NET_FRAMING_AVX2
+        __attribute__((target("avx2")))
+        std::size_t FindDelimiterAvx2(std::span<const std::byte> bytes, std::span<const std::byte> delimiter)
+        {
+            constexpr std::size_t Width = 32;
+            auto last = delimiter.size() - 1;
+            auto first = _mm256_set1_epi8(std::to_integer<char>(delimiter.front()));
+            auto final = _mm256_set1_epi8(std::to_integer<char>(delimiter.back()));
+
+            std::size_t offset = 0;
+            for(; offset + last + Width <= bytes.size(); offset += Width)
+            {
+                auto* position = bytes.data() + offset;
+                auto starts = _mm256_cmpeq_epi8(first,
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(position)));
+                auto ends = _mm256_cmpeq_epi8(final,
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(position + last)));
+                auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(starts, ends)));
+                if(auto bit = MatchCandidates(mask, position, delimiter); bit != SIZE_MAX) return offset + bit;
+            }
+            return FindDelimiterScalar(bytes, delimiter, offset);
+        }
+#endif
+
+        using FindDelimiterFunction = std::size_t (*)(std::span<const std::byte>, std::span<const std::byte>);
+
+        FindDelimiterFunction SelectFindDelimiter()
+        {
+#if defined (EAGLE_NET_FRAMING_AVX2)
+            if(__builtin_cpu_supports("avx2")) return FindDelimiterAvx2;
+#endif
+#if defined (__SSE2__)
+            return FindDelimiterSse2;
+#else
+            return [](std::span<const std::byte> bytes, std::span<const std::byte> delimiter) {
+                return FindDelimiterScalar(bytes, delimiter, 0);
+            };
+#endif
+        }
+
+        const FindDelimiterFunction FindDelimiterImplementation = SelectFindDelimiter();
+    }
+
+    namespace Detail
+    {
+        std::size_t FindDelimiter(std::span<const std::byte> bytes, std::span<const std::byte> delimiter)
+        {
+            if(delimiter.empty() || delimiter.size() > bytes.size()) return bytes.size();
+            return FindDelimiterImplementation(bytes, delimiter);
+        }
+
+        FrameStorage::FrameStorage(std::size_t maximumSize)
+            : maximumSize(maximumSize)
+        {
+        }
+
+        std::span<std::byte> FrameStorage::PrepareWrite(std::size_t minimum)
+        {
+            auto stored = writeOffset - readOffset;
+            if(readOffset != 0 && capacity - writeOffset < minimum)
+            {
+                std::memmove(data.get(), data.get() + readOffset, stored);
+                readOffset = 0;
+                writeOffset = stored;
+            }
+
+            if(capacity - writeOffset < minimum && capacity < maximumSize)
+            {
+                auto grown = std::min(maximumSize, std::max({capacity * 2, stored + minimum, InitialStorageSize}));
+                std::unique_ptr<std::byte[]> replacement(new std::byte[grown]);
+                if(stored != 0) std::memcpy(replacement.get(), data.get() + readOffset, stored);
+                data = std::move(replacement);
+                capacity = grown;
+                readOffset = 0;
+                writeOffset = stored;
+            }
+            return {data.get() + writeOffset, capacity - writeOffset};
+        }
+
+        void FrameStorage::Commit(std::size_t count)
+        {
+            writeOffset += std::min(count, capacity - writeOffset);
+        }
+
+        void FrameStorage::Consume(std::size_t count)
+        {
+            readOffset += std::min(count, writeOffset - readOffset);
+            if(readOffset == writeOffset)
+            {
+                // Nothing is left to keep, the next write can start over without moving bytes.
+                readOffset = 0;
+                writeOffset = 0;
+            }
+        }
+
+        std::span<const std::byte> FrameStorage::GetReadable() const
+        {
+            return {data.get() + readOffset, writeOffset - readOffset};
+        }
+    }
+
+    LengthPrefixFramer::LengthPrefixFramer(LengthPrefix prefix)
+        : prefix(prefix)
+    {
+    }
+
+    FrameBoundaryResult LengthPrefixFramer::Find(std::span<const std::byte> bytes, std::size_t maximumFrameSize)
+    {
+        std::uint64_t length = 0;
+        std::size_t prefixLength = 0;
+
+        switch(prefix)
+        {
+        case LengthPrefix::Varint:
+            for(;; ++prefixLength)
+            {
+                if(prefixLength == MaxPrefixLength) return Utilities::MakeError(FrameError::Malformed);
+                if(prefixLength == bytes.size()) return Utilities::MakeError(FrameError::Incomplete);
+
+                auto byte = std::to_integer<std::uint64_t>(bytes[prefixLength]);
+                // The tenth byte only has room for the top bit of a 64-bit value.
+                if(prefixLength == MaxPrefixLength - 1 && byte > 1) return Utilities::MakeError(FrameError::Malformed);
+                length |= (byte & 0x7f) << (7 * prefixLength);
+                if(!(byte & 0x80))
+                {
+                    ++prefixLength;
+                    break;
+                }
+            }
+            break;
+        case LengthPrefix::Fixed16:
+        case LengthPrefix::Fixed32:
+            prefixLength = prefix == LengthPrefix::Fixed16 ? 2 : 4;
+            if(bytes.size() < prefixLength) return Utilities::MakeError(FrameError::Incomplete);
+            for(std::size_t i = 0; i < prefixLength; ++i)
+            {
+                length = (length << 8) | std::to_integer<std::uint64_t>(bytes[i]);
+            }
+            break;
+        }
+
+        if(length > maximumFrameSize) return Utilities::MakeError(FrameError::TooLarge);
+        auto payloadLength = static_cast<std::size_t>(length);
+        if(bytes.size() - prefixLength < payloadLength) return Utilities::MakeError(FrameError::Incomplete);
+        return Detail::FrameBoundary{prefixLength, payloadLength, prefixLength + payloadLength};
+    }
+
+    std::size_t LengthPrefixFramer::EncodePrefix(std::uint64_t payloadLength,
+        std::span<std::byte, MaxPrefixLength> encoded) const
+    {
+        switch(prefix)
+        {
+        case LengthPrefix::Varint:
+        {
+            std::size_t count = 0;
+            do {
+                auto byte = payloadLength & 0x7f;
+                payloadLength >>= 7;
+                encoded[count++] = static_cast<std::byte>(payloadLength ? byte | 0x80 : byte);
+            } while(payloadLength);
+            return count;
+        }
+        case LengthPrefix::Fixed16:
+        case LengthPrefix::Fixed32:
+        {
+            std::size_t count = prefix == LengthPrefix::Fixed16 ? 2 : 4;
+            if(count < sizeof(payloadLength) && payloadLength >> (8 * count)) return 0;
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                encoded[count - 1 - i] = static_cast<std::byte>(payloadLength >> (8 * i));
+            }
+            return count;
+        }
+        }
+        return 0;
+    }
+
+    DelimiterFramer::DelimiterFramer(std::string_view delimiter)
+        : delimiter{}, delimiterLength(delimiter.size())
+    {
+        if(delimiterLength == 0 || delimiterLength > MaxDelimiterLength)
+        {
+            throw DelimiterFramerCreationFailure();
+        }
+        std::memcpy(this->delimiter, delimiter.data(), delimiterLength);
+    }
+
+    FrameBoundaryResult DelimiterFramer::Find(std::span<const std::byte> bytes, std::size_t maximumFrameSize)
+    {
+        // A delimiter may straddle the end of what was searched before.
+        auto start = searched > delimiterLength - 1 ? searched - (delimiterLength - 1) : 0;
+        auto offset = start + Detail::FindDelimiter(bytes.subspan(std::min(start, bytes.size())),
+            std::span(delimiter, delimiterLength));
+
+        if(offset >= bytes.size())
+        {
+            searched = bytes.size();
+            if(bytes.size() >= maximumFrameSize + delimiterLength) return Utilities::MakeError(FrameError::TooLarge);
+            return Utilities::MakeError(FrameError::Incomplete);
+        }
+
+        searched = 0;
+        if(offset > maximumFrameSize) return Utilities::MakeError(FrameError::TooLarge);
+        return Detail::FrameBoundary{0, offset, offset + delimiterLength};
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/HandleTable.hh>
+#include <algorithm>
+
+namespace Eagle::Core
+{
+    HandleTable::HandleTable(std::size_t resourceCapacity)
+    {
+        generations.reserve(resourceCapacity);
+        states.reserve(resourceCapacity);
+        interests.reserve(resourceCapacity);
+        outboundBytes.reserve(resourceCapacity);
+        contexts.reserve(resourceCapacity);
+    }
+
+    Utilities::Result<ConnectionHandle, HandleTableError> HandleTable::Acquire(int resource)
+    {
+        if(resource < 0 || static_cast<std::uint32_t>(resource) == ConnectionHandle::InvalidIndex)
+        {
+            return Utilities::MakeError(HandleTableError::InvalidResource);
+        }
+
+        auto index = static_cast<std::uint32_t>(resource);
+        if(index >= generations.size())
+        {
+            Grow(static_cast<std::size_t>(index) + 1);
+        }
+        if(generations[index] & 1)
+        {
+            return Utilities::MakeError(HandleTableError::InUse);
+        }
+
+        auto generation = ++generations[index];
+        states[index] = 0;
+        interests[index] = 0;
+        outboundBytes[index] = 0;
+        contexts[index] = nullptr;
+        ++count;
+        return ConnectionHandle{index, generation};
+    }
+
+    bool HandleTable::Release(ConnectionHandle handle)
+    {
+        if(!Contains(handle))
+        {
+            return false;
+        }
+
+        ++generations[handle.index];
+        --count;
+        return true;
+    }
+
+    ConnectionHandle HandleTable::Find(int resource) const
+    {
+        if(resource < 0 || static_cast<std::size_t>(resource) >= generations.size())
+        {
+            return {};
+        }
+
+        auto index = static_cast<std::uint32_t>(resource);
+        auto generation = generations[index];
+        return (generation & 1) ? ConnectionHandle{index, generation} : ConnectionHandle{};
+    }
+
+    std::size_t HandleTable::GetCount() const
+    {
+        return count;
+    }
+
+    std::size_t HandleTable::GetCapacity() const
+    {
+        return generations.size();
+    }
+
+    void HandleTable::Grow(std::size_t size)
+    {
+        // Descriptors are allocated lowest first, doubling keeps regrowth rare.
+        auto capacity = std::max(size, generations.size() * 2);
+        generations.reserve(capacity);
+        states.reserve(capacity);
+        interests.reserve(capacity);
+        outboundBytes.reserve(capacity);
+        contexts.reserve(capacity);
+
+        generations.resize(size, 0);
+        states.resize(size, 0);
+        interests.resize(size, 0);
+        outboundBytes.resize(size, 0);
+        contexts.resize(size, nullptr);
+    }
+}
@@ -0,0 +1,512 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/HttpParser.hh>
+#include <EagleNetwork/Framing.hh>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <immintrin.h>
+#endif
+
+namespace Eagle::Core
+{
+    namespace
+    {
+        enum CharacterClass : std::uint8_t
+        {
+            TokenCharacter = 1,
+            TargetCharacter = 2,
+            ValueCharacter = 4
+        };
+
+        constexpr std::array<std::uint8_t, 256> CharacterClasses = [] {
+            std::array<std::uint8_t, 256> classes{};
+            constexpr std::string_view TokenSymbols = "!#$%&'*+-.^_`|~";
+            for(unsigned character = 0; character < 256; ++character)
+            {
+                bool alphanumeric = (character >= '0' && character <= '9') || (character >= 'a' && character <= 'z') ||
+                    (character >= 'A' && character <= 'Z');
+                if(alphanumeric || TokenSymbols.find(static_cast<char>(character)) != std::string_view::npos)
+                {
+                    classes[character] |= TokenCharacter;
+                }
+                if(character > 0x20 && character != 0x7f) classes[character] |= TargetCharacter;
+                if(character == '\t' || (character >= 0x20 && character != 0x7f)) classes[character] |= ValueCharacter;
+            }
+            return classes;
+        }();
+
+        /**
+         * _mm_cmpestri ranges of the bytes ending each class. The token ranges
+         * also cover '|' and '~' inside '{'..'\xff', so a token stop is only a
+         * candidate to re-check against CharacterClasses.
+         */
+        alignas(16) constexpr char TokenStops[16] = {
+            '\x00', ' ', '"', '"', '(', ')', ',', ',', '/', '/', ':', '@', '[', ']', '{', '\xff'};
+        alignas(16) constexpr char TargetStops[16] = {'\x00', ' ', '\x7f', '\x7f'};
+        alignas(16) constexpr char ValueStops[16] = {'\x00', '\x08', '\x0a', '\x1f', '\x7f', '\x7f'};
+
+        const char* ScanScalar(const char* position, const char* end, CharacterClass characterClass)
+        {
+            while(position != end && (CharacterClasses[static_cast<unsigned char>(*position)] & characterClass))
+            {
+                ++position;
+            }
+            return position;
+        }
+
+#if (defined (__x86_64__) || defined (__i386__)) && defined (__GNUC__)
+#define EAGLE_NET_HTTP_VECTOR_SCAN
+        __attribute__((target("sse4.2")))
+        const char* ScanSse42(const char* position, const char* end, CharacterClass characterClass)
+        {
+            const char* stops = characterClass == TokenCharacter ? TokenStops :
+                characterClass == TargetCharacter ? TargetStops : ValueStops;
+            int stopsLength = characterClass == TokenCharacter ? 16 : characterClass == TargetCharacter ? 4 : 6;
+            auto ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(stops));
+
+            while(end - position >= 16)
+            {
+                auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+                auto index = _mm_cmpestri(ranges, stopsLength, bytes, 16,
+                    _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+                position += index;
+                if(index != 16)
+                {
+                    if(!(CharacterClasses[static_cast<unsigned char>(*position)] & characterClass)) return position;
+                    ++position;
+                }
+            }
+            return ScanScalar(position, end, characterClass);
+        }
+
+        /**
+         * Targets and values end at control characters (values allow HTAB) and,
+         * for targets, at the space: all below a limit, plus DEL.
+         */
+        __attribute__((target("avx2")))
+        const char* ScanAvx2(const char* position, const char* end, CharacterClass characterClass)
+        {
+            bool value = characterClass == ValueCharacter;
+            auto limit = _mm256_set1_epi8(value ? 0x1f : 0x20);
+            auto tab = _mm256_set1_epi8('\t');
+            auto del = _mm256_set1_epi8(0x7f);
+
+            for(; end - position >= 32; position += 32)
+            {
+                auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(position));
+                auto low = _mm256_cmpeq_epi8(_mm256_max_epu8(bytes, limit), limit);
+                if(value) low = _mm256_andnot_si256(_mm256_cmpeq_epi8(bytes, tab), low);
+                auto stops = _mm256_or_si256(low, _mm256_cmpeq_epi8(bytes, del));
+                auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(stops));
+                if(mask != 0) return position + std::countr_zero(mask);
+            }
+            return ScanScalar(position, end, characterClass);
+        }
+#endif
+
+        enum class ScanLevel { Scalar, Sse42, Avx2 };
+
+        ScanLevel SelectScanLevel()
+        {
+#if defined (EAGLE_NET_HTTP_VECTOR_SCAN)
+            if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2")) return ScanLevel::Avx2;
+            if(__builtin_cpu_supports("sse4.2")) return ScanLevel::Sse42;
+#endif
+            return ScanLevel::Scalar;
+        }
+
+        const ScanLevel Level = SelectScanLevel();
+
+        /**
+         * @return The first byte from position that isn't of characterClass, or end.
+         */
+        const char* Scan(const char* position, const char* end, CharacterClass characterClass)
+        {
+#if defined (EAGLE_NET_HTTP_VECTOR_SCAN)
+            // Tokens are short and not worth a 32 byte load, they stay on SSE4.2.
+            if(Level == ScanLevel::Avx2 && characterClass != TokenCharacter)
+            {
+                return ScanAvx2(position, end, characterClass);
+            }
+            if(Level != ScanLevel::Scalar) return ScanSse42(position, end, characterClass);
+#endif
+            return ScanScalar(position, end, characterClass);
+        }
+
+        template <typename T>
+        using ParseResult = Utilities::Result<T, HttpParseError>;
+
+        auto Malformed()
+        {
+            return Utilities::MakeError(HttpParseError::Malformed);
+        }
+
+        bool EqualsIgnoringCase(std::string_view left, std::string_view right)
+        {
+            if(left.size() != right.size()) return false;
+            for(std::size_t i = 0; i < left.size(); ++i)
+            {
+                auto a = static_cast<unsigned char>(left[i]);
+                auto b = static_cast<unsigned char>(right[i]);
+                if(a != b && (a | 0x20) != (b | 0x20)) return false;
+                if(a != b && ((a | 0x20) < 'a' || (a | 0x20) > 'z')) return false;
+            }
+            return true;
+        }
+
+        std::string_view TrimWhitespace(std::string_view text)
+        {
+            while(!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+            while(!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+            return text;
+        }
+
+        /**
+         * Position in a buffer known to hold a complete head, end points past its final CRLF CRLF.
+         */
+        struct Cursor
+        {
+            const char* position;
+            const char* end;
+
+            bool Skip(std::string_view expected)
+            {
+                if(static_cast<std::size_t>(end - position) < expected.size() ||
+                    std::memcmp(position, expected.data(), expected.size()) != 0)
+                {
+                    return false;
+                }
+                position += expected.size();
+                return true;
+            }
+
+            std::string_view Take(CharacterClass characterClass)
+            {
+                auto start = position;
+                position = Scan(position, end, characterClass);
+                return {start, static_cast<std::size_t>(position - start)};
+            }
+        };
+
+        /**
+         * @return The length of the head at the front of buffer, 0 while it isn't complete.
+         */
+        std::size_t FindHeadLength(std::string_view buffer, std::size_t searchedLength, std::size_t& skipped)
+        {
+            // Empty lines ahead of a message are tolerated, RFC 9112 section 2.2.
+            skipped = 0;
+            while(buffer.substr(skipped, 2) == "\r\n") skipped += 2;
+
+            constexpr std::string_view HeadEnd = "\r\n\r\n";
+            // A request line without fields ends with a single CRLF before the empty line.
+            auto start = std::max(skipped, searchedLength >= HeadEnd.size() ? searchedLength - (HeadEnd.size() - 1) : 0);
+            if(start >= buffer.size()) return 0;
+
+            auto bytes = std::as_bytes(std::span(buffer.data(), buffer.size())).subspan(start);
+            auto offset = Detail::FindDelimiter(bytes, std::as_bytes(std::span(HeadEnd.data(), HeadEnd.size())));
+            if(offset == bytes.size()) return 0;
+            return start + offset + HeadEnd.size();
+        }
+
+        ParseResult<int> ParseVersion(Cursor& cursor)
+        {
+            if(!cursor.Skip("HTTP/1.") || cursor.position == cursor.end) return Malformed();
+            auto minor = *cursor.position - '0';
+            if(minor < 0 || minor > 9) return Malformed();
+            ++cursor.position;
+            return minor;
+        }
+
+        ParseResult<std::span<HttpHeader>> ParseHeaders(Cursor& cursor, std::span<HttpHeader> headers)
+        {
+            std::size_t count = 0;
+            while(!cursor.Skip("\r\n"))
+            {
+                auto name = cursor.Take(TokenCharacter);
+                // Empty names and obsolete line folding are rejected, RFC 9112 section 5.2.
+                if(name.empty() || !cursor.Skip(":")) return Malformed();
+
+                auto value = cursor.Take(ValueCharacter);
+                if(!cursor.Skip("\r\n")) return Malformed();
+                if(count == headers.size()) return Utilities::MakeError(HttpParseError::TooManyHeaders);
+                headers[count++] = HttpHeader{name, TrimWhitespace(value)};
+            }
+            return headers.first(count);
+        }
+
+        /**
+         * @return true if the last coding of a Transfer-Encoding value is chunked.
+         */
+        bool IsChunkedLast(std::string_view value)
+        {
+            auto comma = value.rfind(',');
+            auto last = comma == std::string_view::npos ? value : value.substr(comma + 1);
+            return EqualsIgnoringCase(TrimWhitespace(last), "chunked");
+        }
+
+        ParseResult<std::uint64_t> ParseContentLength(std::string_view value)
+        {
+            if(value.empty()) return Malformed();
+            std::uint64_t length = 0;
+            for(auto character : value)
+            {
+                if(character < '0' || character > '9') return Malformed();
+                auto digit = static_cast<std::uint64_t>(character - '0');
+                if(length > (std::numeric_limits<std::uint64_t>::max() - digit) / 10)
+                {
+                    return Utilities::MakeError(HttpParseError::TooLarge);
+                }
+                length = length * 10 + digit;
+            }
+            return length;
+        }
+
+        /**
+         * Collects the framing fields of a head.
+         */
+        struct BodyFields
+        {
+            bool hasTransferEncoding = false;
+            bool chunked = false;
+            bool hasContentLength = false;
+            std::uint64_t contentLength = 0;
+        };
+
+        ParseResult<BodyFields> ReadBodyFields(std::span<const HttpHeader> headers)
+        {
+            BodyFields fields;
+            for(const auto& header : headers)
+            {
+                if(header.NameEquals("transfer-encoding"))
+                {
+                    // Only the last coding counts when the field is repeated.
+                    fields.hasTransferEncoding = true;
+                    fields.chunked = IsChunkedLast(header.value);
+                } else if(header.NameEquals("content-length")) {
+                    auto length = ParseContentLength(header.value);
+                    if(length.HasError()) return Utilities::MakeError(length.GetError());
+                    if(fields.hasContentLength && fields.contentLength != length.GetResult()) return Malformed();
+                    fields.hasContentLength = true;
+                    fields.contentLength = length.GetResult();
+                }
+            }
+
+            if(fields.hasTransferEncoding && fields.hasContentLength) return Malformed();
+            return fields;
+        }
+    }
+
+    bool HttpHeader::NameEquals(std::string_view other) const noexcept
+    {
+        return EqualsIgnoringCase(name, other);
+    }
+
+    Utilities::Result<HttpRequest, HttpParseError> HttpParser::ParseRequest(std::string_view buffer,
+        std::span<HttpHeader> headers, std::size_t searchedLength)
+    {
+        std::size_t skipped;
+        auto headLength = FindHeadLength(buffer, searchedLength, skipped);
+        if(headLength == 0) return Utilities::MakeError(HttpParseError::Incomplete);
+
+        Cursor cursor{buffer.data() + skipped, buffer.data() + headLength};
+        auto method = cursor.Take(TokenCharacter);
+        if(method.empty() || !cursor.Skip(" ")) return Malformed();
+        auto target = cursor.Take(TargetCharacter);
+        if(target.empty() || !cursor.Skip(" ")) return Malformed();
+
+        auto minorVersion = ParseVersion(cursor);
+        if(minorVersion.HasError()) return Utilities::MakeError(minorVersion.GetError());
+        if(!cursor.Skip("\r\n")) return Malformed();
+
+        auto fields = ParseHeaders(cursor, headers);
+        if(fields.HasError()) return Utilities::MakeError(fields.GetError());
+        return HttpRequest{method, target, minorVersion.GetResult(), fields.GetResult(), headLength};
+    }
+
+    Utilities::Result<HttpResponse, HttpParseError> HttpParser::ParseResponse(std::string_view buffer,
+        std::span<HttpHeader> headers, std::size_t searchedLength)
+    {
+        std::size_t skipped;
+        auto headLength = FindHeadLength(buffer, searchedLength, skipped);
+        if(headLength == 0) return Utilities::MakeError(HttpParseError::Incomplete);
+
+        Cursor cursor{buffer.data() + skipped, buffer.data() + headLength};
+        auto minorVersion = ParseVersion(cursor);
+        if(minorVersion.HasError()) return Utilities::MakeError(minorVersion.GetError());
+        if(!cursor.Skip(" ") || cursor.end - cursor.position < 3) return Malformed();
+
+        int status = 0;
+        for(int i = 0; i < 3; ++i)
+        {
+            auto digit = *cursor.position++ - '0';
+            if(digit < 0 || digit > 9) return Malformed();
+            status = status * 10 + digit;
+        }
+
+        // Some servers leave out the space before an empty reason phrase.
+        std::string_view reason;
+        if(cursor.Skip(" ")) reason = cursor.Take(ValueCharacter);
+        if(!cursor.Skip("\r\n")) return Malformed();
+
+        auto fields = ParseHeaders(cursor, headers);
+        if(fields.HasError()) return Utilities::MakeError(fields.GetError());
+        return HttpResponse{minorVersion.GetResult(), status, reason, fields.GetResult(), headLength};
+    }
+
+    Utilities::Result<HttpBody, HttpParseError> HttpParser::GetRequestBody(const HttpRequest& request)
+    {
+        auto fields = ReadBodyFields(request.headers);
+        if(fields.HasError()) return Utilities::MakeError(fields.GetError());
+
+        auto& body = fields.GetResult();
+        if(body.hasTransferEncoding)
+        {
+            // A request body must be chunked to have a known end, RFC 9112 section 6.3.
+            if(!body.chunked) return Malformed();
+            return HttpBody{HttpBody::Kind::Chunked, 0};
+        }
+        if(body.hasContentLength) return HttpBody{HttpBody::Kind::ContentLength, body.contentLength};
+        return HttpBody{HttpBody::Kind::None, 0};
+    }
+
+    Utilities::Result<HttpBody, HttpParseError> HttpParser::GetResponseBody(const HttpResponse& response,
+        std::string_view requestMethod)
+    {
+        if(requestMethod == "HEAD" || (response.status >= 100 && response.status < 200) ||
+            response.status == 204 || response.status == 304)
+        {
+            return HttpBody{HttpBody::Kind::None, 0};
+        }
+
+        auto fields = ReadBodyFields(response.headers);
+        if(fields.HasError()) return Utilities::MakeError(fields.GetError());
+
+        auto& body = fields.GetResult();
+        if(body.hasTransferEncoding)
+        {
+            return HttpBody{body.chunked ? HttpBody::Kind::Chunked : HttpBody::Kind::UntilClose, 0};
+        }
+        if(body.hasContentLength) return HttpBody{HttpBody::Kind::ContentLength, body.contentLength};
+        return HttpBody{HttpBody::Kind::UntilClose, 0};
+    }
+
+    Utilities::Result<HttpChunkedDecoder::Progress, HttpParseError> HttpChunkedDecoder::Decode(std::span<char> buffer)
+    {
+        auto* output = buffer.data();
+        auto* position = buffer.data();
+        auto* end = buffer.data() + buffer.size();
+
+        while(position != end && state != State::Complete)
+        {
+            if(state == State::Data)
+            {
+                auto count = static_cast<std::size_t>(std::min<std::uint64_t>(remaining,
+                    static_cast<std::uint64_t>(end - position)));
+                std::memmove(output, position, count);
+                output += count;
+                position += count;
+                remaining -= count;
+                if(remaining == 0) state = State::DataCarriageReturn;
+                continue;
+            }
+
+            auto character = *position++;
+            switch(state)
+            {
+            case State::Size:
+            {
+                int digit = character >= '0' && character <= '9' ? character - '0' :
+                    (character | 0x20) >= 'a' && (character | 0x20) <= 'f' ? (character | 0x20) - 'a' + 10 : -1;
+                if(digit >= 0)
+                {
+                    if(remaining > (std::numeric_limits<std::uint64_t>::max() >> 4))
+                    {
+                        return Utilities::MakeError(HttpParseError::TooLarge);
+                    }
+                    remaining = (remaining << 4) | static_cast<std::uint64_t>(digit);
+                    hasSizeDigit = true;
+                } else if(!hasSizeDigit) {
+                    return Malformed();
+                } else if(character == '\r') {
+                    state = State::SizeLineFeed;
+                } else if(character == ';' || character == ' ' || character == '\t') {
+                    state = State::Extension;
+                } else {
+                    return Malformed();
+                }
+                break;
+            }
+            case State::Extension:
+                // A bare LF would end the line for some peers and not others.
+                if(character == '\n') return Malformed();
+                if(character == '\r') state = State::SizeLineFeed;
+                break;
+            case State::SizeLineFeed:
+                if(character != '\n') return Malformed();
+                hasSizeDigit = false;
+                state = remaining == 0 ? State::TrailerLineStart : State::Data;
+                break;
+            case State::DataCarriageReturn:
+                if(character != '\r') return Malformed();
+                state = State::DataLineFeed;
+                break;
+            case State::DataLineFeed:
+                if(character != '\n') return Malformed();
+                state = State::Size;
+                break;
+            case State::TrailerLineStart:
+                // Trailer lines end with CRLF too, for the same reason as extensions.
+                if(character == '\n') return Malformed();
+                state = character == '\r' ? State::TrailerLineFeed : State::TrailerLine;
+                break;
+            case State::TrailerLine:
+                if(character == '\n') return Malformed();
+                if(character == '\r') state = State::TrailerLineEnd;
+                break;
+            case State::TrailerLineEnd:
+                if(character != '\n') return Malformed();
+                state = State::TrailerLineStart;
+                break;
+            case State::TrailerLineFeed:
+                if(character != '\n') return Malformed();
+                state = State::Complete;
+                break;
+            case State::Data:
+            case State::Complete:
+                break;
+            }
+        }
+
+        return Progress{static_cast<std::size_t>(output - buffer.data()),
+            static_cast<std::size_t>(position - buffer.data()), state == State::Complete};
+    }
+
+    bool HttpChunkedDecoder::IsComplete() const noexcept
+    {
+        return state == State::Complete;
+    }
+}
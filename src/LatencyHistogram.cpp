@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/LatencyHistogram.hh>
+#include <algorithm>
+#include <cmath>
+
+namespace Eagle::Core
+{
+    void LatencyHistogram::Merge(const LatencyHistogram& other)
+    {
+        for(std::size_t i = 0; i < BucketCount; ++i)
+        {
+            auto value = other.buckets[i].load(std::memory_order_relaxed);
+            if(value) buckets[i].fetch_add(value, std::memory_order_relaxed);
+        }
+        count.fetch_add(other.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        auto otherMax = other.max.load(std::memory_order_relaxed);
+        auto currentMax = max.load(std::memory_order_relaxed);
+        while(otherMax > currentMax && !max.compare_exchange_weak(currentMax, otherMax, std::memory_order_relaxed)) {}
+    }
+
+    void LatencyHistogram::TakeInterval(LatencyHistogram& interval)
+    {
+        interval.Reset();
+        for(std::size_t i = 0; i < BucketCount; ++i)
+        {
+            auto value = buckets[i].exchange(0, std::memory_order_relaxed);
+            interval.buckets[i].store(value, std::memory_order_relaxed);
+        }
+        interval.count.store(count.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        interval.sum.store(sum.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        interval.max.store(max.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::Reset()
+    {
+        for(auto& bucket : buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    std::uint64_t LatencyHistogram::GetCount() const
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t LatencyHistogram::GetMax() const
+    {
+        return max.load(std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::GetMean() const
+    {
+        auto total = GetCount();
+        return total ? static_cast<double>(sum.load(std::memory_order_relaxed)) / static_cast<double>(total) : 0.0;
+    }
+
+    std::uint64_t LatencyHistogram::GetValueAtPercentile(double percentile) const
+    {
+        // Sum the buckets rather than trusting count, recorders may be midway.
+        std::uint64_t total = 0;
+        for(const auto& bucket : buckets)
+        {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        if(total == 0)
+        {
+            return 0;
+        }
+
+        percentile = std::clamp(percentile, 0.0, 100.0);
+        auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total))));
+        std::uint64_t seen = 0;
+        for(std::size_t i = 0; i < BucketCount; ++i)
+        {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if(seen >= rank)
+            {
+                // The bucket bound may overshoot the largest value actually seen.
+                auto bound = GetBucketUpperBound(i);
+                auto largest = GetMax();
+                return largest && bound > largest ? largest : bound;
+            }
+        }
+        return GetMax();
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Metrics.hh>
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct MetricDescription
+    {
+        std::string_view name;
+        std::string_view help;
+        std::string_view type;
+    };
+
+    constexpr std::array<MetricDescription, Eagle::Core::MetricCount> Descriptions{{
+        {"eagle_socket_bytes_read_total", "Bytes received by sockets.", "counter"},
+        {"eagle_socket_bytes_written_total", "Bytes sent by sockets.", "counter"},
+        {"eagle_socket_syscalls_total", "System calls issued by socket operations.", "counter"},
+        {"eagle_socket_would_block_total", "Socket operations that returned EAGAIN.", "counter"},
+        {"eagle_socket_partial_writes_total", "Socket writes that sent less than requested.", "counter"},
+        {"eagle_socket_queued_write_bytes", "Bytes waiting in outbound queues.", "gauge"},
+        {"eagle_loop_iterations_total", "Event loop iterations.", "counter"},
+        {"eagle_loop_events_dispatched_total", "Readiness events dispatched by event loops.", "counter"},
+        {"eagle_loop_busy_seconds_total", "Time event loops spent dispatching rather than waiting.", "counter"},
+    }};
+
+    /**
+     * Slots of the live threads plus the totals of the exited ones. Slots are
+     * owned by the registry so a snapshot never reads a released one.
+     */
+    struct MetricsRegistry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Eagle::Core::Detail::MetricsSlot>> slots;
+        std::vector<Eagle::Core::Detail::MetricsSlot*> freeSlots;
+    };
+
+    MetricsRegistry& GetRegistry()
+    {
+        // Leaked, threads may exit after static destruction started.
+        static auto* registry = new MetricsRegistry();
+        return *registry;
+    }
+
+    /**
+     * Hands the slot back for reuse when its thread exits, its counts are kept so
+     * totals never go backwards.
+     */
+    struct SlotReleaser
+    {
+        Eagle::Core::Detail::MetricsSlot* slot{nullptr};
+
+        ~SlotReleaser()
+        {
+            if(!slot) return;
+            auto& registry = GetRegistry();
+            std::lock_guard lock(registry.mutex);
+            registry.freeSlots.push_back(slot);
+            Eagle::Core::Detail::threadMetricsSlot = nullptr;
+        }
+    };
+
+    thread_local SlotReleaser releaser;
+}
+
+namespace Eagle::Core
+{
+    Detail::MetricsSlot* Detail::RegisterMetricsSlot()
+    {
+        // Called right after failed system calls, errno has to survive.
+        auto savedError = errno;
+        auto& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+
+        MetricsSlot* slot;
+        if(!registry.freeSlots.empty())
+        {
+            slot = registry.freeSlots.back();
+            registry.freeSlots.pop_back();
+        } else {
+            registry.slots.push_back(std::make_unique<MetricsSlot>());
+            slot = registry.slots.back().get();
+        }
+        releaser.slot = slot;
+        errno = savedError;
+        return slot;
+    }
+
+    MetricsSnapshot Metrics::Snapshot()
+    {
+        MetricsSnapshot snapshot;
+        auto& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        for(const auto& slot : registry.slots)
+        {
+            for(std::size_t i = 0; i < MetricCount; ++i)
+            {
+                snapshot.values[i] += slot->values[i].load(std::memory_order_relaxed);
+            }
+        }
+        return snapshot;
+    }
+
+    std::string_view Metrics::GetName(Metric metric)
+    {
+        return Descriptions[static_cast<std::size_t>(metric)].name;
+    }
+
+    std::string Metrics::FormatPrometheus(const MetricsSnapshot& snapshot)
+    {
+        std::string text;
+        for(std::size_t i = 0; i < MetricCount; ++i)
+        {
+            const auto& description = Descriptions[i];
+            text.append("# HELP ").append(description.name).append(" ").append(description.help).append("\n");
+            text.append("# TYPE ").append(description.name).append(" ").append(description.type).append("\n");
+            text.append(description.name).append(" ");
+
+            auto value = snapshot.values[i];
+            if(static_cast<Metric>(i) == Metric::LoopBusyNanoseconds)
+            {
+                text.append(std::to_string(static_cast<double>(value) / 1e9));
+            } else if(static_cast<Metric>(i) == Metric::SocketQueuedWriteBytes) {
+                text.append(std::to_string(static_cast<std::int64_t>(value)));
+            } else {
+                text.append(std::to_string(value));
+            }
+            text.append("\n");
+        }
+        return text;
+    }
+}
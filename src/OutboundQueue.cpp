@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/OutboundQueue.hh>
+#include <EagleNetwork/Metrics.hh>
+#include <cerrno>
+
+namespace Eagle::Core
+{
+    OutboundQueue::OutboundQueue(Reactor& reactor, BasicSocket& socket, IOutboundQueueHandler* handler,
+        const OutboundQueueOptions& options)
+        : reactor(reactor), socket(socket), handler(handler), options(options)
+    {
+    }
+
+    OutboundQueue::~OutboundQueue()
+    {
+        if(flushScheduled) reactor.CancelDeferred(*this);
+        Metrics::Subtract(Metric::SocketQueuedWriteBytes, pending.Size());
+        PublishQueued(0);
+    }
+
+    bool OutboundQueue::Enqueue(std::span<const std::byte> bytes)
+    {
+        if(failed) return false;
+
+        pending.Append(bytes);
+        Metrics::Add(Metric::SocketQueuedWriteBytes, bytes.size());
+        ScheduleFlush();
+        UpdateQueued(pending.Size());
+        return true;
+    }
+
+    bool OutboundQueue::Enqueue(const ChainedBuffer& buffer)
+    {
+        if(failed) return false;
+
+        pending.Append(buffer);
+        Metrics::Add(Metric::SocketQueuedWriteBytes, buffer.Size());
+        ScheduleFlush();
+        UpdateQueued(pending.Size());
+        return true;
+    }
+
+    Detail::SocketIOResult OutboundQueue::Flush()
+    {
+        if(failed) return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{EPIPE});
+
+        std::size_t written = 0;
+        while(!pending.IsEmpty())
+        {
+            // Only the last sendmsg of a flush may leave a partial segment behind.
+            bool more = pending.GetSegmentCount() > BasicSocket::MaxWriteVectors;
+            auto result = socket.Write(pending, more);
+            if(result.HasError())
+            {
+                auto error = result.GetError();
+                if(error == EAGAIN || error == EWOULDBLOCK)
+                {
+                    waitingWritable = true;
+                    break;
+                }
+
+                failed = true;
+                Metrics::Subtract(Metric::SocketQueuedWriteBytes, pending.Size());
+                pending.Clear();
+                PublishQueued(0);
+                if(handler) handler->OnWriteError(*this, error);
+                return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{error});
+            }
+
+            written += result.GetResult();
+            Metrics::Subtract(Metric::SocketQueuedWriteBytes, result.GetResult());
+        }
+
+        UpdateQueued(pending.Size());
+        return written;
+    }
+
+    void OutboundQueue::OnWritable()
+    {
+        if(!waitingWritable) return;
+        waitingWritable = false;
+        Flush();
+    }
+
+    std::size_t OutboundQueue::GetQueuedBytes() const
+    {
+        return pending.Size();
+    }
+
+    bool OutboundQueue::IsAboveHighWatermark() const
+    {
+        return aboveHighWatermark;
+    }
+
+    void OutboundQueue::OnDeferred(Reactor&)
+    {
+        flushScheduled = false;
+        // Bytes left by an earlier flush wait for writability, writing now would only see EAGAIN.
+        if(!waitingWritable) Flush();
+    }
+
+    void OutboundQueue::ScheduleFlush()
+    {
+        if(flushScheduled || waitingWritable) return;
+        flushScheduled = true;
+        reactor.Defer(*this);
+    }
+
+    void OutboundQueue::PublishQueued(std::size_t queued)
+    {
+        auto& handles = reactor.GetHandles();
+        auto handle = reactor.GetHandle(socket);
+        if(handles.Contains(handle)) handles.GetOutboundBytes(handle) = queued;
+    }
+
+    void OutboundQueue::UpdateQueued(std::size_t queued)
+    {
+        PublishQueued(queued);
+        if(!aboveHighWatermark && queued >= options.highWatermark)
+        {
+            aboveHighWatermark = true;
+            if(handler) handler->OnHighWatermark(*this);
+        } else if(aboveHighWatermark && queued <= options.lowWatermark) {
+            aboveHighWatermark = false;
+            if(handler) handler->OnLowWatermark(*this);
+        }
+    }
+}
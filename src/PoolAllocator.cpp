@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/PoolAllocator.hh>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+#include <sys/mman.h>
+#include <utility>
+
+namespace
+{
+    using Eagle::Core::PoolAllocator;
+
+    std::mutex threadPoolOptionsMutex;
+    Eagle::Core::PoolAllocatorOptions threadPoolOptions;
+
+    /**
+     * Start of every chunk, found from any of its blocks by masking with ChunkAlignment.
+     */
+    struct alignas(Eagle::Core::Detail::CacheLineSize) ChunkHeader
+    {
+        PoolAllocator* owner;
+    };
+
+    bool IsChunkAligned(void* chunk)
+    {
+        return (reinterpret_cast<std::uintptr_t>(chunk) & (PoolAllocator::ChunkAlignment - 1)) == 0;
+    }
+
+    void* MapChunk(std::size_t size, bool useHugePages)
+    {
+#if defined (MAP_HUGETLB)
+        if(useHugePages)
+        {
+            auto* chunk = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if(chunk != MAP_FAILED && IsChunkAligned(chunk)) return chunk;
+            if(chunk != MAP_FAILED) ::munmap(chunk, size);
+        }
+#endif
+        // Over-map by the alignment and trim both ends.
+        auto* mapping = ::mmap(nullptr, size + PoolAllocator::ChunkAlignment, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(mapping == MAP_FAILED) throw std::bad_alloc();
+        auto address = reinterpret_cast<std::uintptr_t>(mapping);
+        auto aligned = (address + PoolAllocator::ChunkAlignment - 1) & ~(PoolAllocator::ChunkAlignment - 1);
+        auto* chunk = reinterpret_cast<void*>(aligned);
+        if(aligned != address) ::munmap(mapping, aligned - address);
+        ::munmap(static_cast<std::byte*>(chunk) + size, PoolAllocator::ChunkAlignment - (aligned - address));
+#if defined (MADV_HUGEPAGE)
+        if(useHugePages) ::madvise(chunk, size, MADV_HUGEPAGE);
+#endif
+        return chunk;
+    }
+}
+
+namespace Eagle::Core
+{
+    PoolAllocator::FreeBlock* const PoolAllocator::RetiredMarker =
+        reinterpret_cast<PoolAllocator::FreeBlock*>(std::uintptr_t{1});
+
+    PoolAllocator::PoolAllocator(const PoolAllocatorOptions& options)
+        : options(options)
+    {
+        // Whole multiples of the largest class keep the chunks page aligned at both ends.
+        auto granule = SizeClasses.back();
+        auto chunkSize = std::max(options.chunkSize, sizeof(ChunkHeader) + granule);
+        this->options.chunkSize = std::min((chunkSize + granule - 1) / granule * granule, ChunkAlignment);
+    }
+
+    PoolAllocator::~PoolAllocator()
+    {
+        for(auto [chunk, size] : chunks)
+        {
+            ::munmap(chunk, size);
+        }
+    }
+
+    std::size_t PoolAllocator::GetSizeClass(std::size_t size)
+    {
+        if(size <= SizeClasses.front()) return 0;
+        return static_cast<std::size_t>(std::bit_width(size - 1)) - std::bit_width(SizeClasses.front() - 1);
+    }
+
+    std::byte* PoolAllocator::CarveBlock(std::size_t blockSize)
+    {
+        if(static_cast<std::size_t>(chunkEnd - chunkCursor) < blockSize)
+        {
+            auto* chunk = static_cast<std::byte*>(MapChunk(options.chunkSize, options.useHugePages));
+            new (chunk) ChunkHeader{this};
+            chunks.emplace_back(chunk, options.chunkSize);
+            statistics.chunkBytes += options.chunkSize;
+            chunkCursor = chunk + sizeof(ChunkHeader);
+            chunkEnd = chunk + options.chunkSize;
+        }
+
+        auto* block = chunkCursor;
+        chunkCursor += blockSize;
+        return block;
+    }
+
+    bool PoolAllocator::DrainReturnedBlocks() noexcept
+    {
+        if(!returnedBlocks.load(std::memory_order_relaxed)) return false;
+
+        auto* block = returnedBlocks.exchange(nullptr, std::memory_order_acquire);
+        while(block)
+        {
+            auto* next = block->next;
+            block->next = freeLists[block->sizeClass];
+            freeLists[block->sizeClass] = block;
+            statistics.bytesInUse -= std::min(statistics.bytesInUse, SizeClasses[block->sizeClass]);
+            --blocksInUse;
+            block = next;
+        }
+        return true;
+    }
+
+    void* PoolAllocator::Allocate(std::size_t size)
+    {
+        void* block;
+        std::size_t blockSize = size;
+        if(size > SizeClasses.back())
+        {
+            ++statistics.misses;
+            block = ::operator new(size);
+        } else {
+            auto sizeClass = GetSizeClass(size);
+            blockSize = SizeClasses[sizeClass];
+            if(!freeLists[sizeClass]) DrainReturnedBlocks();
+            if(auto* free = freeLists[sizeClass])
+            {
+                ++statistics.hits;
+                freeLists[sizeClass] = free->next;
+                block = free;
+            } else {
+                ++statistics.misses;
+                block = CarveBlock(blockSize);
+            }
+            ++blocksInUse;
+        }
+
+        statistics.bytesInUse += blockSize;
+        statistics.highWaterMark = std::max(statistics.highWaterMark, statistics.bytesInUse);
+        return block;
+    }
+
+    void PoolAllocator::Deallocate(void* pointer, std::size_t size) noexcept
+    {
+        if(!pointer) return;
+
+        if(size > SizeClasses.back())
+        {
+            ::operator delete(pointer);
+            statistics.bytesInUse -= std::min(statistics.bytesInUse, size);
+            return;
+        }
+
+        auto sizeClass = GetSizeClass(size);
+        auto* block = static_cast<FreeBlock*>(pointer);
+        block->sizeClass = sizeClass;
+        auto chunk = reinterpret_cast<std::uintptr_t>(pointer) & ~(ChunkAlignment - 1);
+        auto* owner = reinterpret_cast<ChunkHeader*>(chunk)->owner;
+        if(owner != this)
+        {
+            owner->ReturnBlock(block);
+            return;
+        }
+
+        block->next = freeLists[sizeClass];
+        freeLists[sizeClass] = block;
+        statistics.bytesInUse -= std::min(statistics.bytesInUse, SizeClasses[sizeClass]);
+        --blocksInUse;
+    }
+
+    void PoolAllocator::ReturnBlock(FreeBlock* block) noexcept
+    {
+        auto* head = returnedBlocks.load(std::memory_order_relaxed);
+        do {
+            if(head == RetiredMarker)
+            {
+                if(retiredBlocks.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+                return;
+            }
+            block->next = head;
+        } while(!returnedBlocks.compare_exchange_weak(head, block, std::memory_order_release,
+            std::memory_order_relaxed));
+    }
+
+    void PoolAllocator::Retire() noexcept
+    {
+        // Blocks released from now on only count down retiredBlocks. The ones
+        // that raced ahead of the marker are still on the list.
+        auto* block = returnedBlocks.exchange(RetiredMarker, std::memory_order_acq_rel);
+        for(; block; block = block->next) --blocksInUse;
+
+        auto outstanding = static_cast<std::ptrdiff_t>(blocksInUse);
+        if(retiredBlocks.fetch_add(outstanding, std::memory_order_acq_rel) + outstanding == 0) delete this;
+    }
+
+    PoolAllocatorStatistics PoolAllocator::GetStatistics() const
+    {
+        return statistics;
+    }
+
+    PoolAllocator& PoolAllocator::ForCurrentThread()
+    {
+        struct Retirement
+        {
+            PoolAllocator*& pool;
+
+            ~Retirement()
+            {
+                std::exchange(pool, nullptr)->Retire();
+            }
+        };
+
+        // The pointer is trivially destructible so it stays usable while other
+        // thread_local objects are torn down. A pool created after the retirement
+        // ran is not retired and stays allocated.
+        thread_local PoolAllocator* pool = nullptr;
+        if(!pool)
+        {
+            std::lock_guard lock(threadPoolOptionsMutex);
+            pool = new PoolAllocator(threadPoolOptions);
+            thread_local Retirement retirement{pool};
+        }
+        return *pool;
+    }
+
+    void PoolAllocator::SetThreadPoolOptions(const PoolAllocatorOptions& options)
+    {
+        std::lock_guard lock(threadPoolOptionsMutex);
+        threadPoolOptions = options;
+    }
+}
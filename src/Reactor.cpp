@@ -0,0 +1,291 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/Metrics.hh>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    std::uint32_t ToEpollEvents(Eagle::Core::ReactorEvent::Type interest)
+    {
+        std::uint32_t events = EPOLLET | EPOLLRDHUP;
+        if(interest & Eagle::Core::ReactorEvent::Read) events |= EPOLLIN;
+        if(interest & Eagle::Core::ReactorEvent::Write) events |= EPOLLOUT;
+        return events;
+    }
+}
+
+namespace Eagle::Core
+{
+    struct Reactor::ReactorImpl
+    {
+        /**
+         * Cold fields of a registration, read once per dispatched event.
+         */
+        struct Binding
+        {
+            BasicSocket* socket{nullptr};
+            IReactorHandler* handler{nullptr};
+        };
+
+        int epollResource{-1};
+        HandleTable handles;
+        std::vector<Binding> bindings;
+        std::vector<epoll_event> events;
+        TimerWheel* timers{nullptr};
+        std::vector<IReactorDeferred*> deferred;
+        std::vector<IReactorDeferred*> runningDeferred;
+        bool running{false};
+
+        void Dispatch(const epoll_event& event)
+        {
+            // Events of a socket unregistered earlier in this batch no longer match
+            // its slot, even when a new socket was registered with the same resource.
+            auto handle = ConnectionHandle::Unpack(event.data.u64);
+            if(!handles.Contains(handle)) return;
+            auto binding = bindings[handle.index];
+
+            if(event.events & EPOLLERR)
+            {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                ::getsockopt(static_cast<int>(handle.index), SOL_SOCKET, SO_ERROR, &error, &length);
+                binding.handler->OnError(*binding.socket, error);
+                return;
+            }
+
+            auto interest = handles.GetInterest(handle);
+            if((event.events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) && (interest & ReactorEvent::Read))
+            {
+                binding.handler->OnReadable(*binding.socket);
+                // The handler may have unregistered the socket.
+                if(!handles.Contains(handle)) return;
+                interest = handles.GetInterest(handle);
+            } else if((event.events & EPOLLHUP) && !(interest & ReactorEvent::Write)) {
+                // Nothing else would tell the handler about the hang-up.
+                binding.handler->OnError(*binding.socket, EPIPE);
+                return;
+            }
+
+            // Without Read interest a hang-up goes to OnWritable, whose next write fails.
+            bool hungUp = (event.events & EPOLLHUP) && !(interest & ReactorEvent::Read);
+            if((event.events & EPOLLOUT || hungUp) && (interest & ReactorEvent::Write))
+            {
+                binding.handler->OnWritable(*binding.socket);
+            }
+        }
+    };
+
+    Reactor::Reactor(std::size_t maxEventsPerPoll)
+        : impl(std::make_unique<ReactorImpl>())
+    {
+        impl->epollResource = ::epoll_create1(EPOLL_CLOEXEC);
+        if(impl->epollResource == -1)
+        {
+            throw ReactorCreationFailure();
+        }
+        impl->events.resize(maxEventsPerPoll ? maxEventsPerPoll : 1);
+    }
+
+    Reactor::~Reactor()
+    {
+        ::close(impl->epollResource);
+    }
+
+    bool Reactor::Register(BasicSocket& socket, IReactorHandler& handler, ReactorEvent::Type interest)
+    {
+        auto acquired = impl->handles.Acquire(socket.GetSocketResource());
+        if(acquired.HasError())
+        {
+            return false;
+        }
+
+        auto handle = acquired.GetResult();
+        epoll_event event{};
+        event.events = ToEpollEvents(interest);
+        event.data.u64 = handle.Pack();
+        if(::epoll_ctl(impl->epollResource, EPOLL_CTL_ADD, static_cast<int>(handle.index), &event) == -1)
+        {
+            impl->handles.Release(handle);
+            return false;
+        }
+
+        if(handle.index >= impl->bindings.size())
+        {
+            impl->bindings.resize(impl->handles.GetCapacity());
+        }
+        impl->bindings[handle.index] = {&socket, &handler};
+        impl->handles.GetInterest(handle) = interest;
+        return true;
+    }
+
+    bool Reactor::Modify(BasicSocket& socket, ReactorEvent::Type interest)
+    {
+        auto handle = impl->handles.Find(socket.GetSocketResource());
+        if(!handle.IsValid())
+        {
+            return false;
+        }
+
+        epoll_event event{};
+        event.events = ToEpollEvents(interest);
+        event.data.u64 = handle.Pack();
+        if(::epoll_ctl(impl->epollResource, EPOLL_CTL_MOD, static_cast<int>(handle.index), &event) == -1)
+        {
+            return false;
+        }
+
+        impl->handles.GetInterest(handle) = interest;
+        return true;
+    }
+
+    bool Reactor::Unregister(BasicSocket& socket)
+    {
+        auto handle = impl->handles.Find(socket.GetSocketResource());
+        if(!handle.IsValid())
+        {
+            return false;
+        }
+
+        ::epoll_ctl(impl->epollResource, EPOLL_CTL_DEL, static_cast<int>(handle.index), nullptr);
+        impl->handles.Release(handle);
+        impl->bindings[handle.index] = {};
+        return true;
+    }
+
+    Detail::SocketIOResult Reactor::RunOnce(int timeoutMilliseconds)
+    {
+        if(impl->timers)
+        {
+            auto timerTimeout = impl->timers->GetNextTimeout(TimerWheel::Clock::now());
+            if(timerTimeout >= 0 && (timeoutMilliseconds < 0 || timerTimeout < timeoutMilliseconds))
+            {
+                timeoutMilliseconds = timerTimeout;
+            }
+        }
+
+        if(!impl->deferred.empty())
+        {
+            timeoutMilliseconds = 0;
+        }
+
+        int count = ::epoll_wait(impl->epollResource, impl->events.data(),
+            static_cast<int>(impl->events.size()), timeoutMilliseconds);
+#if !defined (EAGLE_NET_DISABLE_METRICS)
+        auto busyStart = std::chrono::steady_clock::now();
+#endif
+        Metrics::Add(Metric::SocketSyscalls);
+        Metrics::Add(Metric::LoopIterations);
+        if(count == -1)
+        {
+            if(errno != EINTR) return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+            count = 0;
+        }
+
+        for(int i = 0; i < count; ++i)
+        {
+            impl->Dispatch(impl->events[i]);
+        }
+
+        if(impl->timers)
+        {
+            impl->timers->Advance(TimerWheel::Clock::now());
+        }
+
+        if(!impl->deferred.empty())
+        {
+            // Swapping keeps both vectors' storage, so deferring stays allocation free.
+            impl->runningDeferred.swap(impl->deferred);
+            for(std::size_t i = 0; i < impl->runningDeferred.size(); ++i)
+            {
+                if(auto* deferred = impl->runningDeferred[i]) deferred->OnDeferred(*this);
+            }
+            impl->runningDeferred.clear();
+        }
+
+        Metrics::Add(Metric::LoopEventsDispatched, static_cast<std::uint64_t>(count));
+#if !defined (EAGLE_NET_DISABLE_METRICS)
+        auto busy = std::chrono::steady_clock::now() - busyStart;
+        Metrics::Add(Metric::LoopBusyNanoseconds,
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count()));
+#endif
+        return static_cast<std::size_t>(count);
+    }
+
+    void Reactor::Run()
+    {
+        impl->running = true;
+        while(impl->running)
+        {
+            auto result = RunOnce(-1);
+            if(!result.HasResult())
+            {
+                impl->running = false;
+            }
+        }
+    }
+
+    void Reactor::Stop()
+    {
+        impl->running = false;
+    }
+
+    void Reactor::SetTimerWheel(TimerWheel* wheel)
+    {
+        impl->timers = wheel;
+    }
+
+    void Reactor::Defer(IReactorDeferred& deferred)
+    {
+        impl->deferred.push_back(&deferred);
+    }
+
+    void Reactor::CancelDeferred(IReactorDeferred& deferred)
+    {
+        std::erase(impl->deferred, &deferred);
+        // Runs of this iteration that haven't happened yet are skipped in place.
+        std::replace(impl->runningDeferred.begin(), impl->runningDeferred.end(), &deferred,
+            static_cast<IReactorDeferred*>(nullptr));
+    }
+
+    std::size_t Reactor::GetRegisteredCount() const
+    {
+        return impl->handles.GetCount();
+    }
+
+    ConnectionHandle Reactor::GetHandle(BasicSocket& socket) const
+    {
+        return impl->handles.Find(socket.GetSocketResource());
+    }
+
+    HandleTable& Reactor::GetHandles()
+    {
+        return impl->handles;
+    }
+}
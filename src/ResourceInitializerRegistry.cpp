@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/ResourceInitializerRegistry.hh>
+
+namespace Eagle::Core
+{
+    struct ResourceInitializerRegistry::Node
+    {
+        std::string name;
+        Utilities::IResourceInitializer* initializer;
+        std::function<bool()> validate;
+        std::vector<Node*> dependents;
+        std::size_t dependencyCount{0};
+        std::atomic<std::size_t> pendingDependencies{0};
+        std::atomic<bool> dependencyFailed{false};
+        Utilities::Result<void, ResourceInitializationError> result;
+        ResourceInitializationTiming timing;
+    };
+
+    ResourceInitializerRegistry::ResourceInitializerRegistry() = default;
+    ResourceInitializerRegistry::~ResourceInitializerRegistry() = default;
+
+    ResourceInitializerRegistry::NodeId ResourceInitializerRegistry::Add(std::string name,
+        Utilities::IResourceInitializer& initializer, const std::vector<NodeId>& dependencies)
+    {
+        return AddNode(std::move(name), initializer, {}, dependencies);
+    }
+
+    ResourceInitializerRegistry::NodeId ResourceInitializerRegistry::AddNode(std::string name,
+        Utilities::IResourceInitializer& initializer, std::function<bool()> validate,
+        const std::vector<NodeId>& dependencies)
+    {
+        for(auto dependency : dependencies)
+        {
+            if(dependency >= nodes.size())
+            {
+                throw ResourceInitializerRegistryInvalidDependency();
+            }
+        }
+
+        auto node = std::make_unique<Node>();
+        node->name = std::move(name);
+        node->initializer = &initializer;
+        node->validate = std::move(validate);
+        node->dependencyCount = dependencies.size();
+        for(auto dependency : dependencies)
+        {
+            nodes[dependency]->dependents.push_back(node.get());
+        }
+        nodes.push_back(std::move(node));
+        return nodes.size() - 1;
+    }
+
+    ResourceInitializationSummary ResourceInitializerRegistry::Run(Executor& executor)
+    {
+        runStart = std::chrono::steady_clock::now();
+        remaining = nodes.size();
+        for(auto& node : nodes)
+        {
+            node->pendingDependencies.store(node->dependencyCount, std::memory_order_relaxed);
+            node->dependencyFailed.store(false, std::memory_order_relaxed);
+            node->result = Utilities::Result<void, ResourceInitializationError>();
+            node->timing = {};
+        }
+
+        // Roots are collected first, a fast root could otherwise release a
+        // dependent while this loop still reads its pending count.
+        std::vector<Node*> roots;
+        for(auto& node : nodes)
+        {
+            if(node->dependencyCount == 0) roots.push_back(node.get());
+        }
+        for(auto* root : roots)
+        {
+            Schedule(executor, *root);
+        }
+
+        std::unique_lock lock(mutex);
+        done.wait(lock, [this] { return remaining == 0; });
+
+        ResourceInitializationSummary summary;
+        summary.elapsed = std::chrono::steady_clock::now() - runStart;
+        for(const auto& node : nodes)
+        {
+            (node->result.HasResult() ? summary.succeeded : summary.failed) += 1;
+        }
+        return summary;
+    }
+
+    void ResourceInitializerRegistry::Schedule(Executor& executor, Node& node)
+    {
+        if(node.dependencyFailed.load(std::memory_order_acquire))
+        {
+            node.result = Utilities::MakeError(
+                ResourceInitializationError{ResourceInitializationError::Code::DependencyFailed, nullptr});
+            Complete(executor, node, false);
+            return;
+        }
+
+        if(!executor.Post([this, &executor, &node] { Execute(executor, node); }))
+        {
+            node.result = Utilities::MakeError(
+                ResourceInitializationError{ResourceInitializationError::Code::Cancelled, nullptr});
+            Complete(executor, node, false);
+        }
+    }
+
+    void ResourceInitializerRegistry::Execute(Executor& executor, Node& node)
+    {
+        auto start = std::chrono::steady_clock::now();
+        node.timing.start = start - runStart;
+        bool succeeded = false;
+#if defined (__cpp_exceptions)
+        try
+        {
+#endif
+            node.initializer->InitializeResource();
+            succeeded = !node.validate || node.validate();
+            if(!succeeded)
+            {
+                node.result = Utilities::MakeError(
+                    ResourceInitializationError{ResourceInitializationError::Code::Failed, nullptr});
+            }
+#if defined (__cpp_exceptions)
+        } catch(...) {
+            node.result = Utilities::MakeError(
+                ResourceInitializationError{ResourceInitializationError::Code::Exception, std::current_exception()});
+        }
+#endif
+        node.timing.duration = std::chrono::steady_clock::now() - start;
+        Complete(executor, node, succeeded);
+    }
+
+    void ResourceInitializerRegistry::Complete(Executor& executor, Node& node, bool succeeded)
+    {
+        for(auto* dependent : node.dependents)
+        {
+            if(!succeeded) dependent->dependencyFailed.store(true, std::memory_order_release);
+            // The last dependency to complete schedules the dependent, acq_rel
+            // publishes every dependency's resource to it.
+            if(dependent->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                Schedule(executor, *dependent);
+            }
+        }
+
+        std::lock_guard lock(mutex);
+        if(--remaining == 0)
+        {
+            done.notify_all();
+        }
+    }
+
+    std::size_t ResourceInitializerRegistry::GetNodeCount() const
+    {
+        return nodes.size();
+    }
+
+    const std::string& ResourceInitializerRegistry::GetName(NodeId node) const
+    {
+        return nodes[node]->name;
+    }
+
+    const Utilities::Result<void, ResourceInitializationError>& ResourceInitializerRegistry::GetResult(NodeId node) const
+    {
+        return nodes[node]->result;
+    }
+
+    const ResourceInitializationTiming& ResourceInitializerRegistry::GetTiming(NodeId node) const
+    {
+        return nodes[node]->timing;
+    }
+}
@@ -0,0 +1,260 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/ShardedAcceptor.hh>
+#include <EagleNetwork/EventNotifier.hh>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/filter.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+
+namespace Eagle::Core
+{
+    namespace
+    {
+        std::uint16_t GetAddressPort(const sockaddr_storage& address)
+        {
+            if(address.ss_family == AF_INET6)
+            {
+                return ntohs(reinterpret_cast<const sockaddr_in6&>(address).sin6_port);
+            }
+            return ntohs(reinterpret_cast<const sockaddr_in&>(address).sin_port);
+        }
+
+        void SetAddressPort(sockaddr_storage& address, std::uint16_t port)
+        {
+            if(address.ss_family == AF_INET6)
+            {
+                reinterpret_cast<sockaddr_in6&>(address).sin6_port = htons(port);
+            } else {
+                reinterpret_cast<sockaddr_in&>(address).sin_port = htons(port);
+            }
+        }
+
+        void PinCurrentThread(std::size_t cpu)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+        }
+    }
+
+    struct ShardedAcceptor::Worker : IReactorHandler
+    {
+        ShardedAcceptor* owner{nullptr};
+        std::size_t index{0};
+        BasicSocket listener;
+        /**
+         * Created with the worker so it outlives Run, connections registered by
+         * the handler are torn down by the shutdown handler before it goes.
+         */
+        Reactor reactor;
+        EventNotifier wakeup;
+        std::thread thread;
+        std::atomic<bool> running{false};
+        std::atomic<std::size_t> accepted{0};
+
+        void OnReadable(BasicSocket& socket) override
+        {
+            if(&socket == &wakeup.GetSocket())
+            {
+                wakeup.Consume();
+                return;
+            }
+
+            while(true)
+            {
+                auto connection = socket.Accept();
+                if(!connection.HasResult())
+                {
+                    // EAGAIN ends the burst, other errors such as ECONNABORTED only
+                    // concern the connection being accepted.
+                    if(connection.GetError() == EAGAIN || connection.GetError() == EWOULDBLOCK) return;
+                    if(connection.GetError() == EMFILE || connection.GetError() == ENFILE) return;
+                    continue;
+                }
+
+                accepted.fetch_add(1, std::memory_order_relaxed);
+                owner->handler(index, reactor, std::move(connection).GetResult());
+            }
+        }
+
+        void Run(std::size_t cpu, bool pin)
+        {
+            if(pin) PinCurrentThread(cpu);
+
+            reactor.Register(wakeup.GetSocket(), *this, ReactorEvent::Read);
+            reactor.Register(listener, *this, ReactorEvent::Read);
+            while(running.load(std::memory_order_acquire))
+            {
+                reactor.RunOnce(-1);
+            }
+            reactor.Unregister(listener);
+            listener.CloseSocket();
+
+            if(owner->shutdownHandler) owner->shutdownHandler(index, reactor);
+            // Let the closes the shutdown handler deferred run while the reactor is alive.
+            reactor.RunOnce(0);
+            reactor.Unregister(wakeup.GetSocket());
+        }
+
+        void Wake()
+        {
+            running.store(false, std::memory_order_release);
+            wakeup.Notify();
+        }
+    };
+
+    ShardedAcceptor::ShardedAcceptor(const ShardedAcceptorOptions& options, ConnectionHandler handler,
+        ShutdownHandler shutdownHandler)
+        : options(options), handler(std::move(handler)), shutdownHandler(std::move(shutdownHandler))
+    {
+        if(this->options.workers == 0)
+        {
+            this->options.workers = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    ShardedAcceptor::~ShardedAcceptor()
+    {
+        Stop();
+    }
+
+    Detail::SocketStatusResult ShardedAcceptor::Start(const sockaddr* address, socklen_t length)
+    {
+        if(!workers.empty() || length > sizeof(sockaddr_storage))
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{EINVAL});
+        }
+
+        auto cpus = std::max(1u, std::thread::hardware_concurrency());
+        // SKF_AD_CPU modulo the worker count only names the worker pinned to
+        // that CPU when there is exactly one worker per CPU.
+        if(options.cpuSteering && (!options.pinWorkers || options.workers != cpus))
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{EINVAL});
+        }
+
+        sockaddr_storage bindAddress{};
+        std::memcpy(&bindAddress, address, length);
+
+        std::vector<std::unique_ptr<Worker>> created;
+        for(std::size_t i = 0; i < options.workers; ++i)
+        {
+            auto worker = std::make_unique<Worker>();
+            worker->owner = this;
+            worker->index = i;
+
+            Detail::SocketResourceDependencies deps{
+                .domain = address->sa_family, .type = SOCK_STREAM, .protocol = 0, .options = options.socketOptions};
+            deps.options.nonBlocking = true;
+            deps.options.closeOnExec = true;
+            if(!worker->listener.OpenSocket(deps))
+            {
+                return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+            }
+
+            auto status = worker->listener.SetOption(SOL_SOCKET, SO_REUSEPORT, 1)
+                .AndThen([&] { return worker->listener.Bind(reinterpret_cast<sockaddr*>(&bindAddress), length); })
+                .AndThen([&] { return worker->listener.Listen(options.backlog); });
+            if(!status.HasResult())
+            {
+                return status;
+            }
+
+            if(i == 0)
+            {
+                // Resolve an ephemeral port once so every worker joins the same group.
+                sockaddr_storage local{};
+                socklen_t localLength = sizeof(local);
+                auto resolved = worker->listener.GetLocalAddress(local, localLength);
+                if(!resolved.HasResult())
+                {
+                    return resolved;
+                }
+                port = GetAddressPort(local);
+                SetAddressPort(bindAddress, port);
+            }
+            created.push_back(std::move(worker));
+        }
+
+        if(options.cpuSteering)
+        {
+            // Select the socket of index "current CPU modulo number of workers".
+            sock_filter code[] = {
+                {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<std::uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+                {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<std::uint32_t>(options.workers)},
+                {BPF_RET | BPF_A, 0, 0, 0},
+            };
+            sock_fprog program{static_cast<unsigned short>(std::size(code)), code};
+            if(::setsockopt(created.front()->listener.GetSocketResource(), SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                &program, sizeof(program)) == -1)
+            {
+                return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+            }
+        }
+
+        workers = std::move(created);
+        for(auto& worker : workers)
+        {
+            worker->running.store(true, std::memory_order_release);
+            worker->thread = std::thread([worker = worker.get(), cpus, pin = options.pinWorkers] {
+                worker->Run(worker->index % cpus, pin);
+            });
+        }
+        return {};
+    }
+
+    void ShardedAcceptor::Stop()
+    {
+        for(auto& worker : workers)
+        {
+            worker->Wake();
+        }
+        for(auto& worker : workers)
+        {
+            if(worker->thread.joinable()) worker->thread.join();
+        }
+        workers.clear();
+    }
+
+    std::size_t ShardedAcceptor::GetWorkerCount() const
+    {
+        return options.workers;
+    }
+
+    std::uint16_t ShardedAcceptor::GetPort() const
+    {
+        return port;
+    }
+
+    std::size_t ShardedAcceptor::GetAcceptedCount(std::size_t worker) const
+    {
+        if(worker >= workers.size()) return 0;
+        return workers[worker]->accepted.load(std::memory_order_relaxed);
+    }
+}
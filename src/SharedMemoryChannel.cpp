@@ -0,0 +1,478 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/SharedMemoryChannel.hh>
+#include <EagleNetwork/Metrics.hh>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace Eagle::Core
+{
+    namespace Detail
+    {
+        /**
+         * One direction of the channel. head is only written by the producer and
+         * tail by the consumer, each on its own cache line; the flags let a side
+         * going to sleep ask the other for a wakeup.
+         */
+        struct SharedMemoryRing
+        {
+            alignas(CacheLineSize) std::atomic<std::uint64_t> head{0};
+            alignas(CacheLineSize) std::atomic<std::uint64_t> tail{0};
+            alignas(CacheLineSize) std::atomic<std::uint32_t> readerWaiting{0};
+            std::atomic<std::uint32_t> writerWaiting{0};
+            std::atomic<std::uint32_t> readerClosed{0};
+            std::atomic<std::uint32_t> writerClosed{0};
+        };
+
+        /**
+         * Start of the shared mapping, followed by the data of rings[0] (creator
+         * to attacher) and then of rings[1], capacity bytes each.
+         */
+        struct SharedMemoryHeader
+        {
+            std::uint64_t magic;
+            std::uint64_t capacity;
+            SharedMemoryRing rings[2];
+        };
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+            "The rings are shared between processes and need address-free atomics.");
+    }
+
+    namespace
+    {
+        constexpr std::uint64_t ChannelMagic = 0x45474c45'53484d31; // "EGLESHM1"
+        constexpr std::size_t MinimumCapacity = 4096;
+        constexpr std::size_t MaximumCapacity = std::size_t{1} << 30;
+
+        struct ChannelOffer
+        {
+            std::uint64_t magic;
+            std::uint64_t capacity;
+        };
+
+        enum OfferedDescriptor : std::size_t { Memory, CreatorNotifier, AttacherNotifier, OfferedDescriptorCount };
+
+        std::size_t GetMappingLength(std::size_t capacity)
+        {
+            return sizeof(Detail::SharedMemoryHeader) + 2 * capacity;
+        }
+
+        Utilities::Error<Detail::SocketPlatformErrorType::Type> MakeErrno(int error = errno)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{error});
+        }
+
+        int OpenEventResource()
+        {
+            return ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        }
+
+        std::size_t CopyIn(std::byte* data, std::size_t capacity, std::uint64_t position,
+            std::span<const std::byte> source)
+        {
+            auto offset = static_cast<std::size_t>(position & (capacity - 1));
+            auto first = std::min(source.size(), capacity - offset);
+            std::memcpy(data + offset, source.data(), first);
+            std::memcpy(data, source.data() + first, source.size() - first);
+            return source.size();
+        }
+
+        std::size_t CopyOut(const std::byte* data, std::size_t capacity, std::uint64_t position,
+            std::span<std::byte> destination)
+        {
+            auto offset = static_cast<std::size_t>(position & (capacity - 1));
+            auto first = std::min(destination.size(), capacity - offset);
+            std::memcpy(destination.data(), data + offset, first);
+            std::memcpy(destination.data() + first, data, destination.size() - first);
+            return destination.size();
+        }
+    }
+
+    SharedMemoryChannel::ChannelResult SharedMemoryChannel::Create(BasicSocket& control,
+        const SharedMemoryChannelOptions& options)
+    {
+        auto capacity = std::bit_ceil(std::clamp(options.capacity, MinimumCapacity, MaximumCapacity));
+        auto length = GetMappingLength(capacity);
+
+        BasicSocket memory(::memfd_create("eagle-shm-channel", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+        if(memory.GetSocketResource() == -1) return MakeErrno();
+        auto memoryResource = memory.GetSocketResource();
+
+        // Sealing the size keeps the peer from shrinking the file under our mapping.
+        if(::ftruncate(memoryResource, static_cast<off_t>(length)) == -1 ||
+            ::fcntl(memoryResource, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1)
+        {
+            return MakeErrno();
+        }
+
+        BasicSocket creatorNotifier(OpenEventResource());
+        BasicSocket attacherNotifier(OpenEventResource());
+        if(creatorNotifier.GetSocketResource() == -1 || attacherNotifier.GetSocketResource() == -1)
+        {
+            return MakeErrno();
+        }
+
+        auto* mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, memoryResource, 0);
+        if(mapping == MAP_FAILED) return MakeErrno();
+
+        new (mapping) Detail::SharedMemoryHeader{ChannelMagic, capacity, {}};
+        SharedMemoryChannel channel(mapping, length, capacity, true, std::move(creatorNotifier),
+            std::move(attacherNotifier), options);
+
+        ChannelOffer offer{ChannelMagic, capacity};
+        std::array<int, OfferedDescriptorCount> descriptors{};
+        descriptors[Memory] = memoryResource;
+        descriptors[CreatorNotifier] = channel.notifier.GetSocketResource();
+        descriptors[AttacherNotifier] = channel.peerNotifier.GetSocketResource();
+
+        auto sent = control.WriteDescriptors(std::as_bytes(std::span(&offer, 1)), descriptors);
+        if(sent.HasError()) return MakeErrno(sent.GetError());
+        if(sent.GetResult() != sizeof(offer)) return MakeErrno(EPROTO);
+        return channel;
+    }
+
+    SharedMemoryChannel::ChannelResult SharedMemoryChannel::Attach(BasicSocket& control,
+        const SharedMemoryChannelOptions& options)
+    {
+        ChannelOffer offer{};
+        std::array<int, OfferedDescriptorCount> descriptors{};
+        std::size_t descriptorCount = 0;
+        auto received = control.ReadDescriptors(std::as_writable_bytes(std::span(&offer, 1)), descriptors,
+            descriptorCount);
+        if(received.HasError()) return MakeErrno(received.GetError());
+
+        std::array<BasicSocket, OfferedDescriptorCount> owned;
+        for(std::size_t i = 0; i < descriptorCount; ++i)
+        {
+            owned[i] = BasicSocket(descriptors[i]);
+        }
+
+        if(received.GetResult() != sizeof(offer) || descriptorCount != OfferedDescriptorCount ||
+            offer.magic != ChannelMagic || offer.capacity < MinimumCapacity || offer.capacity > MaximumCapacity ||
+            !std::has_single_bit(offer.capacity))
+        {
+            return MakeErrno(EPROTO);
+        }
+
+        auto memoryResource = descriptors[Memory];
+        auto length = GetMappingLength(offer.capacity);
+        struct stat status{};
+        if(::fstat(memoryResource, &status) == -1) return MakeErrno();
+        auto seals = ::fcntl(memoryResource, F_GET_SEALS);
+        if(static_cast<std::size_t>(status.st_size) < length || seals == -1 || !(seals & F_SEAL_SHRINK))
+        {
+            return MakeErrno(EPROTO);
+        }
+
+        auto* mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, memoryResource, 0);
+        if(mapping == MAP_FAILED) return MakeErrno();
+
+        auto* header = static_cast<Detail::SharedMemoryHeader*>(mapping);
+        if(header->magic != ChannelMagic || header->capacity != offer.capacity)
+        {
+            ::munmap(mapping, length);
+            return MakeErrno(EPROTO);
+        }
+
+        return SharedMemoryChannel(mapping, length, offer.capacity, false, std::move(owned[AttacherNotifier]),
+            std::move(owned[CreatorNotifier]), options);
+    }
+
+    SharedMemoryChannel::SharedMemoryChannel(void* mapping, std::size_t mappingLength, std::size_t capacity,
+        bool creator, BasicSocket&& notifier, BasicSocket&& peerNotifier, const SharedMemoryChannelOptions& options)
+        : mapping(mapping), mappingLength(mappingLength), capacity(capacity), busyPollSpins(options.busyPollSpins),
+          notifier(std::move(notifier)), peerNotifier(std::move(peerNotifier))
+    {
+        auto* header = static_cast<Detail::SharedMemoryHeader*>(mapping);
+        auto* data = static_cast<std::byte*>(mapping) + sizeof(Detail::SharedMemoryHeader);
+
+        std::size_t outgoingIndex = creator ? 0 : 1;
+        outgoing = &header->rings[outgoingIndex];
+        incoming = &header->rings[1 - outgoingIndex];
+        outgoingData = data + outgoingIndex * capacity;
+        incomingData = data + (1 - outgoingIndex) * capacity;
+    }
+
+    SharedMemoryChannel::SharedMemoryChannel(SharedMemoryChannel&& other) noexcept
+        : mapping(std::exchange(other.mapping, nullptr)),
+          mappingLength(std::exchange(other.mappingLength, 0)),
+          incoming(std::exchange(other.incoming, nullptr)),
+          outgoing(std::exchange(other.outgoing, nullptr)),
+          incomingData(std::exchange(other.incomingData, nullptr)),
+          outgoingData(std::exchange(other.outgoingData, nullptr)),
+          capacity(std::exchange(other.capacity, 0)),
+          busyPollSpins(other.busyPollSpins),
+          broken(other.broken),
+          notifier(std::move(other.notifier)),
+          peerNotifier(std::move(other.peerNotifier))
+    {
+    }
+
+    SharedMemoryChannel& SharedMemoryChannel::operator=(SharedMemoryChannel&& other) noexcept
+    {
+        if(this != &other)
+        {
+            Release();
+            mapping = std::exchange(other.mapping, nullptr);
+            mappingLength = std::exchange(other.mappingLength, 0);
+            incoming = std::exchange(other.incoming, nullptr);
+            outgoing = std::exchange(other.outgoing, nullptr);
+            incomingData = std::exchange(other.incomingData, nullptr);
+            outgoingData = std::exchange(other.outgoingData, nullptr);
+            capacity = std::exchange(other.capacity, 0);
+            busyPollSpins = other.busyPollSpins;
+            broken = other.broken;
+            notifier = std::move(other.notifier);
+            peerNotifier = std::move(other.peerNotifier);
+        }
+        return *this;
+    }
+
+    SharedMemoryChannel::~SharedMemoryChannel()
+    {
+        Release();
+    }
+
+    void SharedMemoryChannel::Release()
+    {
+        if(!mapping) return;
+
+        outgoing->writerClosed.store(1, std::memory_order_seq_cst);
+        incoming->readerClosed.store(1, std::memory_order_seq_cst);
+        SignalPeer();
+        ::munmap(mapping, mappingLength);
+        mapping = nullptr;
+    }
+
+    bool SharedMemoryChannel::CheckIndices(std::uint64_t head, std::uint64_t tail)
+    {
+        // Both indices live in memory the peer can write. An unsigned distance
+        // above capacity covers a tail ahead of the head as well.
+        if(head - tail <= capacity) return true;
+        broken = true;
+        return false;
+    }
+
+    Detail::SocketIOResult SharedMemoryChannel::Read(std::span<std::byte> buffer)
+    {
+        if(broken) return MakeErrno(EPROTO);
+
+        auto tail = incoming->tail.load(std::memory_order_relaxed);
+        auto head = incoming->head.load(std::memory_order_acquire);
+        if(!CheckIndices(head, tail)) return MakeErrno(EPROTO);
+
+        if(head == tail)
+        {
+            // Ask for a wakeup, then look again: the writer either sees the flag
+            // or published before our second load.
+            ConsumeNotification();
+            incoming->readerWaiting.store(1, std::memory_order_seq_cst);
+            head = incoming->head.load(std::memory_order_seq_cst);
+            if(head == tail)
+            {
+                if(incoming->writerClosed.load(std::memory_order_seq_cst))
+                {
+                    // The writer closes after its last publish, re-read to catch it.
+                    head = incoming->head.load(std::memory_order_acquire);
+                    if(head == tail) return std::size_t{0};
+                    if(!CheckIndices(head, tail)) return MakeErrno(EPROTO);
+                } else {
+                    Metrics::Add(Metric::SocketWouldBlock);
+                    return MakeErrno(EAGAIN);
+                }
+            }
+            if(!CheckIndices(head, tail)) return MakeErrno(EPROTO);
+            incoming->readerWaiting.store(0, std::memory_order_relaxed);
+        }
+
+        auto count = std::min<std::size_t>(buffer.size(), head - tail);
+        CopyOut(incomingData, capacity, tail, buffer.first(count));
+        incoming->tail.store(tail + count, std::memory_order_seq_cst);
+
+        if(incoming->writerWaiting.load(std::memory_order_seq_cst) &&
+            incoming->writerWaiting.exchange(0, std::memory_order_seq_cst))
+        {
+            SignalPeer();
+        }
+        Metrics::Add(Metric::SocketBytesRead, count);
+        return count;
+    }
+
+    Detail::SocketIOResult SharedMemoryChannel::Write(std::span<const std::byte> buffer)
+    {
+        if(broken) return MakeErrno(EPROTO);
+        if(outgoing->readerClosed.load(std::memory_order_acquire) ||
+            outgoing->writerClosed.load(std::memory_order_relaxed))
+        {
+            return MakeErrno(EPIPE);
+        }
+
+        auto head = outgoing->head.load(std::memory_order_relaxed);
+        auto tail = outgoing->tail.load(std::memory_order_acquire);
+        if(!CheckIndices(head, tail)) return MakeErrno(EPROTO);
+
+        if(head - tail == capacity)
+        {
+            ConsumeNotification();
+            outgoing->writerWaiting.store(1, std::memory_order_seq_cst);
+            tail = outgoing->tail.load(std::memory_order_seq_cst);
+            if(!CheckIndices(head, tail)) return MakeErrno(EPROTO);
+            if(head - tail == capacity)
+            {
+                if(outgoing->readerClosed.load(std::memory_order_seq_cst)) return MakeErrno(EPIPE);
+                Metrics::Add(Metric::SocketWouldBlock);
+                return MakeErrno(EAGAIN);
+            }
+            outgoing->writerWaiting.store(0, std::memory_order_relaxed);
+        }
+
+        auto count = std::min<std::size_t>(buffer.size(), capacity - (head - tail));
+        CopyIn(outgoingData, capacity, head, buffer.first(count));
+        outgoing->head.store(head + count, std::memory_order_seq_cst);
+
+        if(outgoing->readerWaiting.load(std::memory_order_seq_cst) &&
+            outgoing->readerWaiting.exchange(0, std::memory_order_seq_cst))
+        {
+            SignalPeer();
+        }
+        Metrics::Add(Metric::SocketBytesWritten, count);
+        if(count < buffer.size()) Metrics::Add(Metric::SocketPartialWrites);
+        return count;
+    }
+
+    bool SharedMemoryChannel::IsReadable() const noexcept
+    {
+        return broken || incoming->head.load(std::memory_order_seq_cst) != incoming->tail.load(std::memory_order_relaxed) ||
+            incoming->writerClosed.load(std::memory_order_seq_cst);
+    }
+
+    bool SharedMemoryChannel::IsWritable() const noexcept
+    {
+        // A corrupted distance counts as writable so that Write gets to report it.
+        return broken ||
+            outgoing->head.load(std::memory_order_relaxed) - outgoing->tail.load(std::memory_order_seq_cst) !=
+            capacity || outgoing->readerClosed.load(std::memory_order_seq_cst);
+    }
+
+    bool SharedMemoryChannel::WaitReadable(int timeoutMilliseconds)
+    {
+        return Wait(false, timeoutMilliseconds);
+    }
+
+    bool SharedMemoryChannel::WaitWritable(int timeoutMilliseconds)
+    {
+        return Wait(true, timeoutMilliseconds);
+    }
+
+    bool SharedMemoryChannel::Wait(bool writable, int timeoutMilliseconds)
+    {
+        auto ready = writable ? &SharedMemoryChannel::IsWritable : &SharedMemoryChannel::IsReadable;
+        auto& waiting = writable ? outgoing->writerWaiting : incoming->readerWaiting;
+
+        for(std::uint32_t spin = 0; spin < busyPollSpins; ++spin)
+        {
+            if((this->*ready)()) return true;
+        }
+
+        using Clock = std::chrono::steady_clock;
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMilliseconds);
+        while(true)
+        {
+            ConsumeNotification();
+            waiting.store(1, std::memory_order_seq_cst);
+            if((this->*ready)())
+            {
+                waiting.store(0, std::memory_order_relaxed);
+                return true;
+            }
+
+            int remaining = timeoutMilliseconds;
+            if(timeoutMilliseconds >= 0)
+            {
+                auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+                remaining = static_cast<int>(std::max<decltype(left)>(left, 0));
+            }
+
+            pollfd descriptor{notifier.GetSocketResource(), POLLIN, 0};
+            Metrics::Add(Metric::SocketSyscalls);
+            auto polled = ::poll(&descriptor, 1, remaining);
+            if(polled == 0 || (polled == -1 && errno != EINTR))
+            {
+                waiting.store(0, std::memory_order_relaxed);
+                return (this->*ready)();
+            }
+        }
+    }
+
+    void SharedMemoryChannel::ShutdownWrite()
+    {
+        if(outgoing->writerClosed.exchange(1, std::memory_order_seq_cst) == 0)
+        {
+            SignalPeer();
+        }
+    }
+
+    void SharedMemoryChannel::SignalPeer()
+    {
+        std::uint64_t increment = 1;
+        ssize_t written;
+        Metrics::Add(Metric::SocketSyscalls);
+        do {
+            written = ::write(peerNotifier.GetSocketResource(), &increment, sizeof(increment));
+        } while(written == -1 && errno == EINTR);
+    }
+
+    void SharedMemoryChannel::ConsumeNotification()
+    {
+        std::uint64_t counter;
+        ssize_t received;
+        Metrics::Add(Metric::SocketSyscalls);
+        do {
+            received = ::read(notifier.GetSocketResource(), &counter, sizeof(counter));
+        } while(received == -1 && errno == EINTR);
+    }
+
+    BasicSocket& SharedMemoryChannel::GetNotifier()
+    {
+        return notifier;
+    }
+
+    std::size_t SharedMemoryChannel::GetCapacity() const noexcept
+    {
+        return capacity;
+    }
+}
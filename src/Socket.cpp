@@ -0,0 +1,744 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Socket.hh>
+#include <EagleNetwork/LatencyHistogram.hh>
+#include <EagleNetwork/Metrics.hh>
+#include <EagleNetwork/PoolAllocator.hh>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined (__linux__)
+#include <linux/errqueue.h>
+#include <sys/sendfile.h>
+#endif
+#include <utility>
+#include <vector>
+
+namespace
+{
+#if defined (MSG_NOSIGNAL)
+    constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+    constexpr int SendFlags = 0;
+#endif
+
+#if defined (MSG_MORE)
+    constexpr int MoreFlag = MSG_MORE;
+#else
+    constexpr int MoreFlag = 0;
+#endif
+
+    using Eagle::Core::IoLatencyHistograms;
+    using Eagle::Core::LatencyHistogram;
+    using Eagle::Core::Metric;
+    using Eagle::Core::Metrics;
+
+    /**
+     * Times a system call when the socket has latency histograms attached.
+     */
+    class SyscallTimer
+    {
+    public:
+        SyscallTimer(IoLatencyHistograms* histograms, LatencyHistogram IoLatencyHistograms::* operation)
+            : histogram(histograms ? &(histograms->*operation) : nullptr)
+        {
+            if(histogram) start = std::chrono::steady_clock::now();
+        }
+
+        void Stop(bool failed)
+        {
+            if(!histogram) return;
+            if(failed && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+
+            auto savedError = errno;
+            histogram->Record(std::chrono::steady_clock::now() - start);
+            errno = savedError;
+        }
+
+    private:
+        LatencyHistogram* histogram;
+        std::chrono::steady_clock::time_point start{};
+    };
+
+    int SetIntegerOption(int resource, int level, int name, int value)
+    {
+        Metrics::Add(Metric::SocketSyscalls);
+        return ::setsockopt(resource, level, name, &value, sizeof(value)) == -1 ? errno : 0;
+    }
+
+    /**
+     * @return 0, or the error of the first option that could not be applied.
+     */
+    int ApplySocketOptions(int resource, const Eagle::Core::Detail::SocketOptions& options)
+    {
+        int error = 0;
+        auto apply = [&](bool requested, int level, int name, int value) {
+            if(requested && error == 0) error = SetIntegerOption(resource, level, name, value);
+        };
+        auto unsupported = [&](bool requested) {
+            if(requested && error == 0) error = ENOPROTOOPT;
+        };
+
+#if !defined (SOCK_NONBLOCK) || !defined (SOCK_CLOEXEC)
+        if(options.nonBlocking && error == 0)
+        {
+            auto flags = ::fcntl(resource, F_GETFL, 0);
+            if(flags == -1 || ::fcntl(resource, F_SETFL, flags | O_NONBLOCK) == -1) error = errno;
+        }
+        if(options.closeOnExec && error == 0 && ::fcntl(resource, F_SETFD, FD_CLOEXEC) == -1)
+        {
+            error = errno;
+        }
+#endif
+        apply(options.noDelay, IPPROTO_TCP, TCP_NODELAY, 1);
+        apply(options.sendBufferSize > 0, SOL_SOCKET, SO_SNDBUF, options.sendBufferSize);
+        apply(options.receiveBufferSize > 0, SOL_SOCKET, SO_RCVBUF, options.receiveBufferSize);
+#if defined (TCP_QUICKACK)
+        apply(options.quickAck, IPPROTO_TCP, TCP_QUICKACK, 1);
+#else
+        unsupported(options.quickAck);
+#endif
+#if defined (TCP_FASTOPEN)
+        apply(options.fastOpenQueueLength > 0, IPPROTO_TCP, TCP_FASTOPEN, options.fastOpenQueueLength);
+#else
+        unsupported(options.fastOpenQueueLength > 0);
+#endif
+#if defined (TCP_FASTOPEN_CONNECT)
+        apply(options.fastOpenConnect, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, 1);
+#else
+        unsupported(options.fastOpenConnect);
+#endif
+#if defined (SO_BUSY_POLL)
+        apply(options.busyPollMicroseconds > 0, SOL_SOCKET, SO_BUSY_POLL, options.busyPollMicroseconds);
+#else
+        unsupported(options.busyPollMicroseconds > 0);
+#endif
+#if defined (SO_INCOMING_CPU)
+        apply(options.incomingCpu >= 0, SOL_SOCKET, SO_INCOMING_CPU, options.incomingCpu);
+#else
+        unsupported(options.incomingCpu >= 0);
+#endif
+#if defined (TCP_NOTSENT_LOWAT)
+        apply(options.notSentLowWatermark > 0, IPPROTO_TCP, TCP_NOTSENT_LOWAT, options.notSentLowWatermark);
+#else
+        unsupported(options.notSentLowWatermark > 0);
+#endif
+        (void)unsupported;
+        return error;
+    }
+}
+
+namespace Eagle::Core
+{
+    struct BasicSocket::BasicSocketImpl
+    {
+        static void* operator new(std::size_t size)
+        {
+            return PoolAllocator::ForCurrentThread().Allocate(size);
+        }
+
+        static void operator delete(void* pointer, std::size_t size) noexcept
+        {
+            PoolAllocator::ForCurrentThread().Deallocate(pointer, size);
+        }
+
+        Detail::SocketResourceType::ResourceType resource{BasicSocket::InvalidResource};
+#if defined (__linux__)
+        struct PendingZeroCopy
+        {
+            std::uint32_t sequence;
+            std::shared_ptr<const void> owner;
+        };
+
+        /**
+         * Sequence number the kernel gives to the next zero-copy send.
+         */
+        std::uint32_t zeroCopySequence{0};
+        /**
+         * Empty until the first zero-copy send, then grown from the thread's pool.
+         */
+        std::vector<PendingZeroCopy, PoolAllocatorAdapter<PendingZeroCopy>> zeroCopyPending;
+        /**
+         * Without SO_ZEROCOPY the kernel ignores MSG_ZEROCOPY and posts no completion.
+         */
+        bool zeroCopyEnabled{false};
+#endif
+        IoLatencyHistograms* latency{nullptr};
+    };
+
+    BasicSocket::BasicSocket()
+        : impl(std::make_unique<BasicSocketImpl>())
+    {}
+
+    BasicSocket::BasicSocket(Detail::SocketResourceType::ResourceType resource)
+        : impl(std::make_unique<BasicSocketImpl>())
+    {
+        impl->resource = resource;
+    }
+
+    BasicSocket& BasicSocket::operator=(Detail::SocketResourceType::ResourceType resource)
+    {
+        if(!impl) impl = std::make_unique<BasicSocketImpl>();
+        CloseSocket();
+        impl->resource = resource;
+        return *this;
+    }
+
+    BasicSocket::BasicSocket(ResourceInitializerType initializer)
+        : impl(std::make_unique<BasicSocketImpl>())
+    {
+        initializer.InitializeResource();
+        if(!initializer.IsValidResource())
+        {
+            throw BasicSocketInvalidDependencies();
+        }
+
+        impl->resource = initializer.GetActualResrouce();
+    }
+
+    BasicSocket& BasicSocket::operator=(ResourceInitializerType initializer)
+    {
+        initializer.InitializeResource();
+        if(!initializer.IsValidResource())
+        {
+            throw BasicSocketInvalidDependencies();
+        }
+
+        if(!impl) impl = std::make_unique<BasicSocketImpl>();
+        CloseSocket();
+        impl->resource = initializer.GetActualResrouce();
+        return *this;
+    }
+
+    BasicSocket::BasicSocket(BasicSocket&& other) noexcept
+        : impl(std::move(other.impl))
+    {}
+
+    BasicSocket& BasicSocket::operator=(BasicSocket&& other) noexcept
+    {
+        if(this != &other)
+        {
+            if(impl) CloseSocket();
+            std::swap(impl, other.impl);
+        }
+        return *this;
+    }
+
+    BasicSocket::~BasicSocket()
+    {
+        if(impl)
+        {
+            CloseSocket();
+        }
+    }
+
+    bool BasicSocket::OpenSocket(Detail::SocketResourceDependencies& dependencies)
+    {
+        if(!impl) impl = std::make_unique<BasicSocketImpl>();
+        if(IsOpen())
+        {
+            return false;
+        }
+
+        auto opened = OpenResource(dependencies);
+        if(!opened.HasResult())
+        {
+            errno = opened.GetError();
+            return false;
+        }
+
+        impl->resource = opened.GetResult();
+        return true;
+    }
+
+    Detail::SocketInitResult BasicSocket::OpenResource(const Detail::SocketResourceDependencies& dependencies)
+    {
+        const auto& options = dependencies.options;
+        int type = dependencies.type;
+#if defined (SOCK_NONBLOCK) && defined (SOCK_CLOEXEC)
+        if(options.nonBlocking) type |= SOCK_NONBLOCK;
+        if(options.closeOnExec) type |= SOCK_CLOEXEC;
+#endif
+
+        auto resource = ::socket(dependencies.domain, type, dependencies.protocol);
+        Metrics::Add(Metric::SocketSyscalls);
+        if(resource == InvalidResource)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+
+        auto error = ApplySocketOptions(resource, options);
+        if(error != 0)
+        {
+            ::close(resource);
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{error});
+        }
+        return resource;
+    }
+
+    Detail::SocketResourceType::ResourceType BasicSocket::GetSocket()
+    {
+        return impl->resource;
+    }
+
+    bool BasicSocket::CloseSocket()
+    {
+        if(!IsOpen())
+        {
+            return false;
+        }
+
+        auto resource = std::exchange(impl->resource, InvalidResource);
+#if defined (__linux__)
+        impl->zeroCopySequence = 0;
+        impl->zeroCopyPending.clear();
+        impl->zeroCopyEnabled = false;
+#endif
+        return ::close(resource) == 0;
+    }
+
+    Detail::SocketResourceType::ResourceType BasicSocket::GetSocketResource()
+    {
+        return impl->resource;
+    }
+
+    Detail::SocketStatusResult BasicSocket::Bind(const sockaddr* address, socklen_t length)
+    {
+        if(::bind(impl->resource, address, length) == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return {};
+    }
+
+    Detail::SocketStatusResult BasicSocket::Listen(int backlog)
+    {
+        if(::listen(impl->resource, backlog) == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return {};
+    }
+
+    Utilities::Result<BasicSocket, Detail::SocketPlatformErrorType::Type> BasicSocket::Accept(bool nonBlocking)
+    {
+        Detail::SocketResourceType::ResourceType resource;
+        SyscallTimer timer(impl->latency, &IoLatencyHistograms::accept);
+        do {
+#if defined (__linux__)
+            resource = ::accept4(impl->resource, nullptr, nullptr, SOCK_CLOEXEC | (nonBlocking ? SOCK_NONBLOCK : 0));
+#else
+            resource = ::accept(impl->resource, nullptr, nullptr);
+#endif
+        } while(resource == InvalidResource && errno == EINTR);
+        timer.Stop(resource == InvalidResource);
+
+        Metrics::Add(Metric::SocketSyscalls);
+        if(resource == InvalidResource)
+        {
+            Metrics::RecordFailure();
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+
+        BasicSocket connection(resource);
+        connection.impl->latency = impl->latency;
+#if !defined (__linux__)
+        connection.SetNonBlocking(nonBlocking);
+#endif
+        return connection;
+    }
+
+    Detail::SocketStatusResult BasicSocket::Connect(const sockaddr* address, socklen_t length)
+    {
+        int result;
+        SyscallTimer timer(impl->latency, &IoLatencyHistograms::connect);
+        do {
+            result = ::connect(impl->resource, address, length);
+        } while(result == -1 && errno == EINTR);
+        // A non-blocking connect completes later, AsyncSocket times it.
+        if(result == 0 || errno != EINPROGRESS) timer.Stop(result == -1);
+
+        Metrics::Add(Metric::SocketSyscalls);
+        if(result == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return {};
+    }
+
+    Detail::SocketStatusResult BasicSocket::SetOption(int level, int name, int value)
+    {
+        if(::setsockopt(impl->resource, level, name, &value, sizeof(value)) == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return {};
+    }
+
+    Detail::SocketStatusResult BasicSocket::GetLocalAddress(sockaddr_storage& address, socklen_t& length)
+    {
+        length = sizeof(address);
+        if(::getsockname(impl->resource, reinterpret_cast<sockaddr*>(&address), &length) == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return {};
+    }
+
+    bool BasicSocket::IsOpen() const
+    {
+        return impl && impl->resource != InvalidResource;
+    }
+
+    void BasicSocket::SetLatencyHistograms(IoLatencyHistograms* histograms)
+    {
+        impl->latency = histograms;
+    }
+
+    IoLatencyHistograms* BasicSocket::GetLatencyHistograms() const
+    {
+        return impl->latency;
+    }
+
+    bool BasicSocket::SetNonBlocking(bool enabled)
+    {
+        int flags = ::fcntl(impl->resource, F_GETFL, 0);
+        if(flags == -1)
+        {
+            return false;
+        }
+
+        flags = enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+        return ::fcntl(impl->resource, F_SETFL, flags) == 0;
+    }
+
+    Detail::SocketIOResult BasicSocket::Read(std::span<std::byte> buffer)
+    {
+        ssize_t received;
+        SyscallTimer timer(impl->latency, &IoLatencyHistograms::read);
+        do {
+            received = ::recv(impl->resource, buffer.data(), buffer.size(), 0);
+        } while(received == -1 && errno == EINTR);
+        timer.Stop(received == -1);
+
+        Metrics::RecordRead(received);
+        if(received == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return static_cast<std::size_t>(received);
+    }
+
+    Detail::SocketIOResult BasicSocket::Write(std::span<const std::byte> buffer)
+    {
+        ssize_t sent;
+        SyscallTimer timer(impl->latency, &IoLatencyHistograms::write);
+        do {
+            sent = ::send(impl->resource, buffer.data(), buffer.size(), SendFlags);
+        } while(sent == -1 && errno == EINTR);
+        timer.Stop(sent == -1);
+
+        Metrics::RecordWrite(sent, buffer.size());
+        if(sent == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return static_cast<std::size_t>(sent);
+    }
+
+    Detail::SocketIOResult BasicSocket::Read(ChainedBuffer& buffer, std::size_t maxBytes)
+    {
+        auto writable = buffer.PrepareWrite();
+        auto result = Read(writable.first(std::min(writable.size(), maxBytes)));
+        if(result.HasResult())
+        {
+            buffer.Commit(result.GetResult());
+        }
+        return result;
+    }
+
+    Detail::SocketIOResult BasicSocket::Write(ChainedBuffer& buffer, bool more)
+    {
+        iovec vectors[MaxWriteVectors];
+        msghdr message{};
+        message.msg_iov = vectors;
+        message.msg_iovlen = buffer.ExportVectors(vectors);
+
+        std::size_t requested = 0;
+        for(std::size_t i = 0; i < message.msg_iovlen; ++i)
+        {
+            requested += vectors[i].iov_len;
+        }
+
+        ssize_t sent;
+        SyscallTimer timer(impl->latency, &IoLatencyHistograms::write);
+        do {
+            sent = ::sendmsg(impl->resource, &message, more ? SendFlags | MoreFlag : SendFlags);
+        } while(sent == -1 && errno == EINTR);
+        timer.Stop(sent == -1);
+
+        Metrics::RecordWrite(sent, requested);
+        if(sent == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        buffer.Consume(static_cast<std::size_t>(sent));
+        return static_cast<std::size_t>(sent);
+    }
+
+    Detail::SocketIOResult BasicSocket::WriteDescriptors(std::span<const std::byte> buffer,
+        std::span<const int> descriptors)
+    {
+        if(buffer.empty() || descriptors.size() > MaxPassedDescriptors)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{EINVAL});
+        }
+
+        iovec vector{const_cast<std::byte*>(buffer.data()), buffer.size()};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MaxPassedDescriptors)];
+        msghdr message{};
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+
+        if(!descriptors.empty())
+        {
+            message.msg_control = control;
+            message.msg_controllen = CMSG_SPACE(sizeof(int) * descriptors.size());
+            auto* header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int) * descriptors.size());
+            std::memcpy(CMSG_DATA(header), descriptors.data(), sizeof(int) * descriptors.size());
+        }
+
+        ssize_t sent;
+        SyscallTimer timer(impl->latency, &IoLatencyHistograms::write);
+        do {
+            sent = ::sendmsg(impl->resource, &message, SendFlags);
+        } while(sent == -1 && errno == EINTR);
+        timer.Stop(sent == -1);
+
+        Metrics::RecordWrite(sent, buffer.size());
+        if(sent == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return static_cast<std::size_t>(sent);
+    }
+
+    Detail::SocketIOResult BasicSocket::ReadDescriptors(std::span<std::byte> buffer, std::span<int> descriptors,
+        std::size_t& descriptorCount)
+    {
+        descriptorCount = 0;
+        iovec vector{buffer.data(), buffer.size()};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MaxPassedDescriptors)];
+        msghdr message{};
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+#if defined (MSG_CMSG_CLOEXEC)
+        constexpr int ReceiveFlags = MSG_CMSG_CLOEXEC;
+#else
+        constexpr int ReceiveFlags = 0;
+#endif
+        ssize_t received;
+        SyscallTimer timer(impl->latency, &IoLatencyHistograms::read);
+        do {
+            received = ::recvmsg(impl->resource, &message, ReceiveFlags);
+        } while(received == -1 && errno == EINTR);
+        timer.Stop(received == -1);
+
+        Metrics::RecordRead(received);
+        if(received == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+
+        for(auto* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header))
+        {
+            if(header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) continue;
+
+            auto count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                int descriptor;
+                std::memcpy(&descriptor, CMSG_DATA(header) + i * sizeof(int), sizeof(int));
+                if(descriptorCount < descriptors.size())
+                {
+#if !defined (MSG_CMSG_CLOEXEC)
+                    ::fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+#endif
+                    descriptors[descriptorCount++] = descriptor;
+                } else {
+                    ::close(descriptor);
+                }
+            }
+        }
+
+        if(message.msg_flags & MSG_CTRUNC)
+        {
+            // The kernel dropped descriptors that didn't fit, what arrived is incomplete.
+            for(std::size_t i = 0; i < descriptorCount; ++i)
+            {
+                ::close(descriptors[i]);
+            }
+            descriptorCount = 0;
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{EMSGSIZE});
+        }
+        return static_cast<std::size_t>(received);
+    }
+
+    Utilities::Result<std::pair<BasicSocket, BasicSocket>, Detail::SocketPlatformErrorType::Type>
+        BasicSocket::MakePair(const Detail::SocketResourceDependencies& dependencies)
+    {
+        const auto& options = dependencies.options;
+        int type = dependencies.type;
+#if defined (SOCK_NONBLOCK) && defined (SOCK_CLOEXEC)
+        if(options.nonBlocking) type |= SOCK_NONBLOCK;
+        if(options.closeOnExec) type |= SOCK_CLOEXEC;
+#endif
+
+        int pair[2];
+        Metrics::Add(Metric::SocketSyscalls);
+        if(::socketpair(dependencies.domain, type, dependencies.protocol, pair) == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+
+        std::pair<BasicSocket, BasicSocket> sockets{BasicSocket(pair[0]), BasicSocket(pair[1])};
+        for(auto resource : pair)
+        {
+            if(auto error = ApplySocketOptions(resource, options); error != 0)
+            {
+                return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{error});
+            }
+        }
+        return sockets;
+    }
+
+#if defined (__linux__)
+    bool BasicSocket::EnableZeroCopy()
+    {
+        int enabled = 1;
+        impl->zeroCopyEnabled = ::setsockopt(impl->resource, SOL_SOCKET, SO_ZEROCOPY, &enabled,
+            sizeof(enabled)) == 0;
+        return impl->zeroCopyEnabled;
+    }
+
+    Detail::SocketIOResult BasicSocket::WriteZeroCopy(std::span<const std::byte> buffer,
+        std::shared_ptr<const void> owner)
+    {
+        if(!impl->zeroCopyEnabled)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{EINVAL});
+        }
+
+        ssize_t sent;
+        SyscallTimer timer(impl->latency, &IoLatencyHistograms::write);
+        do {
+            sent = ::send(impl->resource, buffer.data(), buffer.size(), SendFlags | MSG_ZEROCOPY);
+        } while(sent == -1 && errno == EINTR);
+        timer.Stop(sent == -1);
+
+        Metrics::RecordWrite(sent, buffer.size());
+        if(sent == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+
+        // Every successful call consumes one notification sequence number, even
+        // when the kernel fell back to copying.
+        impl->zeroCopyPending.push_back({impl->zeroCopySequence++, std::move(owner)});
+        return static_cast<std::size_t>(sent);
+    }
+
+    Detail::SocketIOResult BasicSocket::ProcessZeroCopyCompletions()
+    {
+        std::size_t released = 0;
+        while(!impl->zeroCopyPending.empty())
+        {
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+            msghdr message{};
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            Metrics::Add(Metric::SocketSyscalls);
+            if(::recvmsg(impl->resource, &message, MSG_ERRQUEUE | MSG_DONTWAIT) == -1)
+            {
+                if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+                if(errno == EINTR) continue;
+                return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+            }
+
+            for(auto* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header))
+            {
+                bool isRecvErr = (header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR)
+                    || (header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR);
+                if(!isRecvErr) continue;
+
+                auto* error = reinterpret_cast<sock_extended_err*>(CMSG_DATA(header));
+                if(error->ee_errno != 0 || error->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+
+                // The notification covers the inclusive range [ee_info, ee_data].
+                std::uint32_t first = error->ee_info;
+                std::uint32_t count = error->ee_data - first + 1;
+                released += std::erase_if(impl->zeroCopyPending, [first, count](const auto& pending) {
+                    return pending.sequence - first < count;
+                });
+            }
+        }
+        return released;
+    }
+
+    std::size_t BasicSocket::GetPendingZeroCopyCount() const
+    {
+        return impl->zeroCopyPending.size();
+    }
+
+    Detail::SocketIOResult BasicSocket::SendFile(int fileResource, off_t& offset, std::size_t count)
+    {
+        ssize_t sent;
+        SyscallTimer timer(impl->latency, &IoLatencyHistograms::write);
+        do {
+            sent = ::sendfile(impl->resource, fileResource, &offset, count);
+        } while(sent == -1 && errno == EINTR);
+        timer.Stop(sent == -1);
+
+        Metrics::RecordWrite(sent, count);
+        if(sent == -1)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+        }
+        return static_cast<std::size_t>(sent);
+    }
+#endif
+}
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/SpliceForwarder.hh>
+#include <EagleNetwork/Metrics.hh>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Eagle::Core
+{
+    SpliceForwarder::SpliceForwarder(std::size_t pipeCapacity)
+    {
+        if(::pipe2(pipeResources, O_NONBLOCK | O_CLOEXEC) == -1)
+        {
+            throw SpliceForwarderCreationFailure();
+        }
+
+        if(pipeCapacity)
+        {
+            ::fcntl(pipeResources[1], F_SETPIPE_SZ, static_cast<int>(pipeCapacity));
+        }
+    }
+
+    SpliceForwarder::~SpliceForwarder()
+    {
+        ::close(pipeResources[0]);
+        ::close(pipeResources[1]);
+    }
+
+    Detail::SocketIOResult SpliceForwarder::Forward(BasicSocket& source, BasicSocket& destination,
+        std::size_t maxBytes)
+    {
+        constexpr unsigned flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+        std::size_t written = 0;
+
+        while(written < maxBytes)
+        {
+            if(buffered == 0)
+            {
+                if(sourceClosed) break;
+
+                auto filled = ::splice(source.GetSocketResource(), nullptr, pipeResources[1], nullptr,
+                    maxBytes - written, flags);
+                Metrics::RecordRead(filled);
+                if(filled == 0)
+                {
+                    sourceClosed = true;
+                    break;
+                }
+                if(filled == -1)
+                {
+                    if(errno == EINTR) continue;
+                    if(written == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+                    {
+                        return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+                    }
+                    break;
+                }
+                buffered = static_cast<std::size_t>(filled);
+            }
+
+            auto drained = ::splice(pipeResources[0], nullptr, destination.GetSocketResource(), nullptr,
+                buffered, flags);
+            Metrics::RecordWrite(drained, buffered);
+            if(drained == -1)
+            {
+                if(errno == EINTR) continue;
+                if(written == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+                {
+                    return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{errno});
+                }
+                break;
+            }
+
+            buffered -= static_cast<std::size_t>(drained);
+            written += static_cast<std::size_t>(drained);
+        }
+        return written;
+    }
+
+    std::size_t SpliceForwarder::GetBufferedCount() const
+    {
+        return buffered;
+    }
+
+    bool SpliceForwarder::IsSourceClosed() const
+    {
+        return sourceClosed;
+    }
+}
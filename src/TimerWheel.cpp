@@ -0,0 +1,284 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/TimerWheel.hh>
+#include <algorithm>
+#include <bit>
+#include <functional>
+
+namespace Eagle::Core
+{
+    Timer::~Timer()
+    {
+        if(wheel)
+        {
+            wheel->Cancel(*this);
+        }
+    }
+
+    TimerWheel::TimerWheel(std::chrono::milliseconds resolution, Clock::time_point start)
+        : resolution(std::max(resolution, std::chrono::milliseconds(1))), start(start) {}
+
+    TimerWheel::~TimerWheel()
+    {
+        auto release = [this](Timer*& head) {
+            while(head)
+            {
+                auto& timer = *head;
+                Unlink(timer);
+                timer.wheel = nullptr;
+            }
+        };
+
+        for(auto& head : firstLevel) release(head);
+        for(auto& level : upperLevels)
+        {
+            for(auto& head : level) release(head);
+        }
+    }
+
+    void TimerWheel::Link(Timer*& head, Timer& timer)
+    {
+        timer.next = head;
+        timer.previous = &head;
+        if(head)
+        {
+            head->previous = &timer.next;
+        }
+        head = &timer;
+    }
+
+    void TimerWheel::Unlink(Timer& timer)
+    {
+        *timer.previous = timer.next;
+        if(timer.next)
+        {
+            timer.next->previous = timer.previous;
+        } else if(std::less_equal<>{}(firstLevel.data(), timer.previous)
+            && std::less<>{}(timer.previous, firstLevel.data() + FirstLevelSlots)
+            && *timer.previous == nullptr) {
+            auto index = static_cast<std::size_t>(timer.previous - firstLevel.data());
+            firstLevelOccupancy[index / 64] &= ~(std::uint64_t{1} << (index % 64));
+        }
+        timer.next = nullptr;
+        timer.previous = nullptr;
+    }
+
+    void TimerWheel::Insert(Timer& timer)
+    {
+        // The slot of the current tick was processed already, unless we are
+        // cascading into it, which is the only case an expiry can equal it.
+        auto expiry = std::max(timer.expiry, currentTick);
+        if(expiry - currentTick < FirstLevelSlots)
+        {
+            auto index = static_cast<std::size_t>(expiry & (FirstLevelSlots - 1));
+            Link(firstLevel[index], timer);
+            firstLevelOccupancy[index / 64] |= std::uint64_t{1} << (index % 64);
+            return;
+        }
+
+        for(std::size_t level = 0; level < UpperLevels; ++level)
+        {
+            auto shift = FirstLevelBits + level * UpperLevelBits;
+            auto slotTick = expiry >> shift;
+            auto currentSlotTick = currentTick >> shift;
+            if(slotTick - currentSlotTick < UpperLevelSlots || level + 1 == UpperLevels)
+            {
+                // Beyond the wheel range: park in the farthest slot, the timer
+                // is filed again when it is cascaded.
+                slotTick = std::min(slotTick, currentSlotTick + UpperLevelSlots - 1);
+                Link(upperLevels[level][slotTick & (UpperLevelSlots - 1)], timer);
+                return;
+            }
+        }
+    }
+
+    void TimerWheel::Cascade(std::size_t level)
+    {
+        auto shift = FirstLevelBits + level * UpperLevelBits;
+        auto& head = upperLevels[level][(currentTick >> shift) & (UpperLevelSlots - 1)];
+        while(head)
+        {
+            auto& timer = *head;
+            Unlink(timer);
+            Insert(timer);
+        }
+    }
+
+    void TimerWheel::CollectExpired(Timer*& expired)
+    {
+        auto& head = firstLevel[currentTick & (FirstLevelSlots - 1)];
+        while(head)
+        {
+            auto& timer = *head;
+            Unlink(timer);
+            if(timer.expiry <= currentTick)
+            {
+                Link(expired, timer);
+            } else {
+                // The deadline was pushed back after the timer was filed.
+                Insert(timer);
+            }
+        }
+    }
+
+    std::uint64_t TimerWheel::GetTick(Clock::time_point now) const
+    {
+        if(now <= start) return 0;
+        return static_cast<std::uint64_t>((now - start) / resolution);
+    }
+
+    std::uint64_t TimerWheel::GetNextFirstLevelTick() const
+    {
+        auto next = currentTick + 1;
+        auto index = static_cast<std::size_t>(next & (FirstLevelSlots - 1));
+        if(index == 0)
+        {
+            return next;
+        }
+
+        // Only the rest of the current turn is scanned, the slots behind the
+        // cursor belong to the next turn.
+        for(auto word = index / 64; word < firstLevelOccupancy.size(); ++word)
+        {
+            auto bits = firstLevelOccupancy[word];
+            if(word == index / 64)
+            {
+                bits &= ~std::uint64_t{0} << (index % 64);
+            }
+            if(bits)
+            {
+                return next - index + word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+            }
+        }
+        return (currentTick | (FirstLevelSlots - 1)) + 1;
+    }
+
+    void TimerWheel::Arm(Timer& timer, std::chrono::milliseconds timeout)
+    {
+        auto ticks = timeout.count() > 0
+            ? static_cast<std::uint64_t>((timeout + resolution - std::chrono::milliseconds(1)) / resolution)
+            : std::uint64_t{0};
+        auto expiry = currentTick + std::max<std::uint64_t>(ticks, 1);
+
+        if(timer.wheel == this)
+        {
+            if(expiry >= timer.expiry)
+            {
+                timer.expiry = expiry;
+                return;
+            }
+            Unlink(timer);
+        } else {
+            if(timer.wheel)
+            {
+                timer.wheel->Cancel(timer);
+            }
+            timer.wheel = this;
+            ++armedCount;
+        }
+
+        timer.expiry = expiry;
+        Insert(timer);
+    }
+
+    void TimerWheel::Cancel(Timer& timer)
+    {
+        if(timer.wheel != this)
+        {
+            return;
+        }
+
+        Unlink(timer);
+        timer.wheel = nullptr;
+        --armedCount;
+    }
+
+    std::size_t TimerWheel::Advance(Clock::time_point now)
+    {
+        auto target = GetTick(now);
+        if(armedCount == 0)
+        {
+            currentTick = std::max(currentTick, target);
+            return 0;
+        }
+
+        Timer* expired = nullptr;
+        while(currentTick < target)
+        {
+            // Jump over the empty slots of the first level.
+            currentTick = std::min(GetNextFirstLevelTick(), target);
+            if((currentTick & (FirstLevelSlots - 1)) == 0)
+            {
+                for(auto level = UpperLevels; level-- > 0;)
+                {
+                    auto shift = FirstLevelBits + level * UpperLevelBits;
+                    if((currentTick & ((std::uint64_t{1} << shift) - 1)) == 0)
+                    {
+                        Cascade(level);
+                    }
+                }
+            }
+            CollectExpired(expired);
+        }
+
+        std::size_t count = 0;
+        while(expired)
+        {
+            auto& timer = *expired;
+            Unlink(timer);
+            if(timer.expiry > currentTick)
+            {
+                // Re-armed by a handler dispatched earlier in this batch.
+                Insert(timer);
+                continue;
+            }
+
+            timer.wheel = nullptr;
+            --armedCount;
+            ++count;
+            timer.handler->OnTimerExpired(timer);
+        }
+        return count;
+    }
+
+    int TimerWheel::GetNextTimeout(Clock::time_point now) const
+    {
+        if(armedCount == 0)
+        {
+            return -1;
+        }
+
+        auto deadline = start + resolution * GetNextFirstLevelTick();
+        if(deadline <= now)
+        {
+            return 0;
+        }
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        return static_cast<int>(remaining.count());
+    }
+
+    std::size_t TimerWheel::GetArmedCount() const
+    {
+        return armedCount;
+    }
+}
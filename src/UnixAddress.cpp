@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/UnixAddress.hh>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+namespace Eagle::Core
+{
+    namespace
+    {
+        constexpr std::size_t PathOffset = offsetof(sockaddr_un, sun_path);
+        constexpr std::size_t PathCapacity = sizeof(sockaddr_un::sun_path);
+    }
+
+    UnixAddress::AddressResult UnixAddress::FromPath(std::string_view path)
+    {
+        if(path.empty() || path.find('\0') != std::string_view::npos)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{EINVAL});
+        }
+        // Keep room for the terminator, some platforms insist on it.
+        if(path.size() >= PathCapacity)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{ENAMETOOLONG});
+        }
+
+        UnixAddress unixAddress;
+        unixAddress.address.sun_family = AF_UNIX;
+        std::memcpy(unixAddress.address.sun_path, path.data(), path.size());
+        unixAddress.length = static_cast<socklen_t>(PathOffset + path.size() + 1);
+        return unixAddress;
+    }
+
+#if defined (__linux__)
+    UnixAddress::AddressResult UnixAddress::FromAbstractName(std::string_view name)
+    {
+        if(name.size() + 1 > PathCapacity)
+        {
+            return Utilities::MakeError(Detail::SocketPlatformErrorType::Type{ENAMETOOLONG});
+        }
+
+        // The length delimits the name, trailing null bytes would be part of it.
+        UnixAddress unixAddress;
+        unixAddress.address.sun_family = AF_UNIX;
+        std::memcpy(unixAddress.address.sun_path + 1, name.data(), name.size());
+        unixAddress.length = static_cast<socklen_t>(PathOffset + 1 + name.size());
+        return unixAddress;
+    }
+#endif
+
+    UnixAddress UnixAddress::FromNative(const sockaddr_un& address, socklen_t length)
+    {
+        UnixAddress unixAddress;
+        unixAddress.length = std::min<socklen_t>(length, sizeof(sockaddr_un));
+        std::memcpy(&unixAddress.address, &address, unixAddress.length);
+        return unixAddress;
+    }
+
+    const sockaddr* UnixAddress::GetAddress() const noexcept
+    {
+        return reinterpret_cast<const sockaddr*>(&address);
+    }
+
+    socklen_t UnixAddress::GetLength() const noexcept
+    {
+        return length;
+    }
+
+    std::string_view UnixAddress::GetName() const noexcept
+    {
+        if(IsUnnamed()) return {};
+
+        std::size_t size = length - PathOffset;
+        if(IsAbstract()) return {address.sun_path + 1, size - 1};
+        return {address.sun_path, ::strnlen(address.sun_path, size)};
+    }
+
+    bool UnixAddress::IsAbstract() const noexcept
+    {
+        return !IsUnnamed() && address.sun_path[0] == '\0';
+    }
+
+    bool UnixAddress::IsUnnamed() const noexcept
+    {
+        return length <= PathOffset;
+    }
+}
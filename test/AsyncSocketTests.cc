@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/AsyncSocket.hh>
+#include <EagleNetwork/PoolAllocator.hh>
+#include <EagleNetwork/Task.hh>
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <array>
+#include <cstring>
+#include <netinet/in.h>
+#include <string_view>
+
+using namespace Eagle::Core;
+
+namespace {
+    Task<int> Add(int a, int b)
+    {
+        co_return a + b;
+    }
+
+    Task<void> Accumulate(int& total)
+    {
+        total += co_await Add(1, 2);
+        total += co_await Add(3, 4);
+    }
+
+    BasicSocket OpenTcpSocket()
+    {
+        BasicSocket socket;
+        Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0};
+        socket.OpenSocket(deps);
+        return socket;
+    }
+
+    Task<void> EchoOnce(AsyncSocket& listener, bool& done)
+    {
+        auto accepted = co_await listener.Accept();
+        EXPECT_TRUE(accepted.HasResult());
+        if(!accepted.HasResult()) co_return;
+
+        AsyncSocket connection(listener.GetReactor(), std::move(accepted).GetResult());
+        std::array<std::byte, 64> buffer{};
+        auto read = co_await connection.Read(buffer);
+        EXPECT_TRUE(read.HasResult());
+        if(!read.HasResult()) co_return;
+
+        auto written = co_await connection.WriteAll(std::span<const std::byte>(buffer.data(), read.GetResult()));
+        EXPECT_TRUE(written.HasResult());
+        done = true;
+    }
+
+    Task<void> Ping(AsyncSocket& client, const sockaddr_in& address, std::string& reply)
+    {
+        auto connected = co_await client.Connect(reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        EXPECT_TRUE(connected.HasResult());
+        if(!connected.HasResult()) co_return;
+
+        constexpr std::string_view message = "ping";
+        auto written = co_await client.WriteAll(std::as_bytes(std::span(message)));
+        EXPECT_TRUE(written.HasResult());
+
+        std::array<std::byte, 64> buffer{};
+        auto read = co_await client.Read(buffer);
+        EXPECT_TRUE(read.HasResult());
+        if(!read.HasResult()) co_return;
+        reply.assign(reinterpret_cast<const char*>(buffer.data()), read.GetResult());
+    }
+
+    Task<void> ConnectRefused(AsyncSocket& client, const sockaddr_in& address, Detail::SocketPlatformErrorType::Type& error)
+    {
+        auto connected = co_await client.Connect(reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        error = connected.HasResult() ? 0 : connected.GetError();
+    }
+}
+
+TEST(Task, NestedAwait)
+{
+    int total = 0;
+    auto task = Accumulate(total);
+    ASSERT_FALSE(task.IsDone());
+    Spawn(std::move(task));
+    ASSERT_EQ(total, 10);
+}
+
+TEST(Task, FramesFromThreadPool)
+{
+    auto& pool = PoolAllocator::ForCurrentThread();
+    auto before = pool.GetStatistics().bytesInUse;
+    auto task = Add(1, 1);
+    ASSERT_GT(pool.GetStatistics().bytesInUse, before);
+    task = Task<int>();
+    ASSERT_EQ(pool.GetStatistics().bytesInUse, before);
+}
+
+TEST(AsyncSocket, Echo)
+{
+    Reactor reactor;
+
+    auto listenerSocket = OpenTcpSocket();
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_TRUE(listenerSocket.Bind(reinterpret_cast<sockaddr*>(&address), sizeof(address)).HasResult());
+    ASSERT_TRUE(listenerSocket.Listen().HasResult());
+    sockaddr_storage local{};
+    socklen_t length;
+    listenerSocket.GetLocalAddress(local, length);
+    address.sin_port = reinterpret_cast<sockaddr_in&>(local).sin_port;
+
+    AsyncSocket listener(reactor, std::move(listenerSocket));
+    AsyncSocket client(reactor, OpenTcpSocket());
+
+    bool echoed = false;
+    std::string reply;
+    Spawn(EchoOnce(listener, echoed));
+    Spawn(Ping(client, address, reply));
+
+    for(int i = 0; i < 100 && reply.empty(); ++i)
+    {
+        ASSERT_TRUE(reactor.RunOnce(100).HasResult());
+    }
+    ASSERT_TRUE(echoed);
+    ASSERT_EQ(reply, "ping");
+}
+
+TEST(AsyncSocket, ConnectRefused)
+{
+    Reactor reactor;
+
+    // Grab a free port and release it so nothing listens there.
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    {
+        auto probe = OpenTcpSocket();
+        ASSERT_TRUE(probe.Bind(reinterpret_cast<sockaddr*>(&address), sizeof(address)).HasResult());
+        sockaddr_storage local{};
+        socklen_t length;
+        probe.GetLocalAddress(local, length);
+        address.sin_port = reinterpret_cast<sockaddr_in&>(local).sin_port;
+    }
+
+    AsyncSocket client(reactor, OpenTcpSocket());
+    Detail::SocketPlatformErrorType::Type error = -1;
+    Spawn(ConnectRefused(client, address, error));
+
+    for(int i = 0; i < 100 && error == -1; ++i)
+    {
+        ASSERT_TRUE(reactor.RunOnce(100).HasResult());
+    }
+    ASSERT_EQ(error, ECONNREFUSED);
+}
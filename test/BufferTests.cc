@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Buffer.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+
+using namespace Eagle::Core;
+
+namespace {
+    std::span<const std::byte> Bytes(std::string_view text)
+    {
+        return std::as_bytes(std::span(text));
+    }
+
+    std::string ToString(const ChainedBuffer& buffer)
+    {
+        std::string text(buffer.Size(), '\0');
+        buffer.CopyTo(std::as_writable_bytes(std::span(text)));
+        return text;
+    }
+}
+
+TEST(ChainedBuffer, AppendAndConsume)
+{
+    ChainedBuffer buffer(4);
+    buffer.Append(Bytes("hello world"));
+
+    ASSERT_EQ(buffer.Size(), 11);
+    ASSERT_EQ(buffer.GetSegmentCount(), 3);
+    ASSERT_EQ(ToString(buffer), "hello world");
+
+    buffer.Consume(6);
+    ASSERT_EQ(ToString(buffer), "world");
+    ASSERT_EQ(buffer.GetSegmentCount(), 2);
+
+    buffer.Consume(100);
+    ASSERT_TRUE(buffer.IsEmpty());
+}
+
+TEST(ChainedBuffer, SliceAndSplitShareSlabs)
+{
+    ChainedBuffer buffer(8);
+    buffer.Append(Bytes("header:payload"));
+
+    auto slice = buffer.Slice(7, 7);
+    ASSERT_EQ(ToString(slice), "payload");
+
+    auto head = buffer.Split(7);
+    ASSERT_EQ(ToString(head), "header:");
+    ASSERT_EQ(ToString(buffer), "payload");
+
+    // The shared tail slab is not written in place by the original buffer.
+    ChainedBuffer copy(buffer);
+    buffer.Append(Bytes("!"));
+    ASSERT_EQ(ToString(buffer), "payload!");
+    ASSERT_EQ(ToString(copy), "payload");
+    ASSERT_EQ(ToString(slice), "payload");
+}
+
+TEST(ChainedBuffer, ExportVectors)
+{
+    ChainedBuffer buffer(4);
+    buffer.Append(Bytes("abcdefghij"));
+
+    iovec vectors[2];
+    ASSERT_EQ(buffer.ExportVectors(vectors), 2);
+    ASSERT_EQ(vectors[0].iov_len, 4);
+    ASSERT_EQ(std::string_view(static_cast<char*>(vectors[1].iov_base), vectors[1].iov_len), "efgh");
+}
+
+TEST(ChainedBuffer, SocketReadWrite)
+{
+    int pair[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    BasicSocket first(pair[0]);
+    BasicSocket second(pair[1]);
+
+    ChainedBuffer outbound(4);
+    outbound.Append(Bytes("gathered write"));
+    auto written = first.Write(outbound);
+    ASSERT_EQ(written.GetResult(), 14);
+    ASSERT_TRUE(outbound.IsEmpty());
+
+    ChainedBuffer inbound;
+    auto read = second.Read(inbound, 1024);
+    ASSERT_EQ(read.GetResult(), 14);
+    ASSERT_EQ(ToString(inbound), "gathered write");
+}
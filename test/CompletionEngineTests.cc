@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/CompletionEngine.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <array>
+#include <cstring>
+#include <sys/socket.h>
+
+using namespace Eagle::Core;
+
+namespace {
+    using InputOperation = Detail::IO::IOSocketOperationDep<Detail::IO::InputSocketOperationDep, char[64]>;
+    using OutputOperation = Detail::IO::IOSocketOperationDep<Detail::IO::OutputSocketOperationDep, char[64]>;
+
+    bool IsIoUringAvailable()
+    {
+        static const bool available = [] {
+            try {
+                CompletionEngine probe(1, CompletionEngineBackend::IoUring);
+                return true;
+            } catch(const CompletionEngineCreationFailure&) {
+                return false;
+            }
+        }();
+        return available;
+    }
+
+    class CompletionEngineTest : public ::testing::TestWithParam<CompletionEngineBackend>
+    {
+    protected:
+        void SetUp() override
+        {
+            // seccomp, kernel.io_uring_disabled or an old kernel.
+            if(GetParam() == CompletionEngineBackend::IoUring && !IsIoUringAvailable())
+            {
+                GTEST_SKIP() << "io_uring unavailable";
+            }
+
+            int pair[2];
+            ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+            first = pair[0];
+            second = pair[1];
+        }
+
+        BasicSocket first;
+        BasicSocket second;
+    };
+}
+
+TEST_P(CompletionEngineTest, BatchedSendAndReceive)
+{
+    CompletionEngine engine(8, GetParam());
+    ASSERT_EQ(engine.GetBackend(), GetParam());
+
+    std::array<InputOperation, 2> inputs{};
+    for(auto& input : inputs)
+    {
+        input.resource = second.GetSocketResource();
+        input.size = 5;
+    }
+
+    std::array<OutputOperation, 2> outputs{};
+    for(std::size_t i = 0; i < outputs.size(); ++i)
+    {
+        outputs[i].resource = first.GetSocketResource();
+        outputs[i].size = 5;
+        std::memcpy(outputs[i].operationBuffer.buffer, i == 0 ? "first" : "other", 5);
+    }
+
+    ASSERT_EQ(engine.Prepare(std::span(outputs), 0), 2);
+    auto submitted = engine.Submit();
+    ASSERT_TRUE(submitted.HasResult());
+    ASSERT_EQ(submitted.GetResult(), 2);
+
+    std::array<IOCompletion, 4> completions{};
+    std::size_t reaped = 0;
+    while(reaped < 2)
+    {
+        auto result = engine.Reap(std::span(completions).subspan(reaped), true);
+        ASSERT_TRUE(result.HasResult());
+        reaped += result.GetResult();
+    }
+    ASSERT_EQ(completions[0].result, 5);
+    ASSERT_EQ(outputs[0].operationBuffer.outputNumberBytes, 5);
+
+    ASSERT_EQ(engine.Prepare(std::span(inputs), 10), 2);
+    ASSERT_EQ(engine.Submit().GetResult(), 2);
+    reaped = 0;
+    while(reaped < 2)
+    {
+        auto result = engine.Reap(std::span(completions).subspan(reaped), true);
+        ASSERT_TRUE(result.HasResult());
+        reaped += result.GetResult();
+    }
+    ASSERT_EQ(engine.GetInFlightCount(), 0);
+
+    std::size_t received = 0;
+    for(std::size_t i = 0; i < reaped; ++i)
+    {
+        ASSERT_GE(completions[i].tag, 10);
+        received += static_cast<std::size_t>(completions[i].result);
+    }
+    ASSERT_EQ(received, 10);
+    ASSERT_EQ(std::memcmp(inputs[0].operationBuffer.buffer, "first", 5), 0);
+}
+
+TEST_P(CompletionEngineTest, ReportsErrors)
+{
+    CompletionEngine engine(4, GetParam());
+    InputOperation input{};
+    input.resource = -1;
+    input.size = 8;
+
+    ASSERT_TRUE(engine.Prepare(input, 7));
+    engine.Submit();
+
+    std::array<IOCompletion, 1> completions{};
+    auto reaped = engine.Reap(completions, true);
+    ASSERT_EQ(reaped.GetResult(), 1);
+    ASSERT_EQ(completions[0].tag, 7);
+    ASSERT_EQ(completions[0].result, -EBADF);
+}
+
+TEST_P(CompletionEngineTest, CompletesWhenDataArrives)
+{
+    CompletionEngine engine(4, GetParam());
+    InputOperation input{};
+    input.resource = second.GetSocketResource();
+    input.size = 64;
+
+    ASSERT_TRUE(engine.Prepare(input, 1));
+    ASSERT_EQ(engine.Submit().GetResult(), 1);
+
+    std::array<IOCompletion, 1> completions{};
+    ASSERT_EQ(engine.Reap(completions, false).GetResult(), 0);
+    ASSERT_EQ(engine.GetInFlightCount(), 1);
+
+    const char message[] = "late";
+    first.Write(std::as_bytes(std::span(message, 4)));
+
+    ASSERT_EQ(engine.Reap(completions, true).GetResult(), 1);
+    ASSERT_EQ(completions[0].result, 4);
+    ASSERT_EQ(input.operationBuffer.inputNumberBytes, 4);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, CompletionEngineTest,
+    ::testing::Values(CompletionEngineBackend::IoUring, CompletionEngineBackend::Readiness));
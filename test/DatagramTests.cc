@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Datagram.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <array>
+#include <arpa/inet.h>
+#include <cstring>
+#include <netinet/in.h>
+
+using namespace Eagle::Core;
+
+namespace {
+    using InputBuffer = Detail::IO::InputSocketOperationDep<char[256]>;
+    using OutputBuffer = Detail::IO::OutputSocketOperationDep<char[256]>;
+
+    // A bound receiver and a sender connected to it on the loopback interface.
+    class DatagramTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_DGRAM, .protocol = 0};
+            ASSERT_TRUE(receiver.OpenSocket(deps));
+            ASSERT_TRUE(sender.OpenSocket(deps));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+            ASSERT_EQ(::bind(receiver.GetSocketResource(), reinterpret_cast<sockaddr*>(&address), length), 0);
+            ASSERT_EQ(::getsockname(receiver.GetSocketResource(), reinterpret_cast<sockaddr*>(&address), &length), 0);
+            ASSERT_EQ(::connect(sender.GetSocketResource(), reinterpret_cast<sockaddr*>(&address), length), 0);
+        }
+
+        BasicSocket receiver;
+        BasicSocket sender;
+    };
+}
+
+TEST_F(DatagramTest, SendAndReceiveBatch)
+{
+    DatagramBatch batch(8);
+
+    std::array<OutputBuffer, 4> outputs{};
+    for(std::size_t i = 0; i < outputs.size(); ++i)
+    {
+        outputs[i].outputNumberBytes = i + 1;
+        std::memset(outputs[i].buffer, 'a' + static_cast<int>(i), sizeof(outputs[i].buffer));
+    }
+    Detail::IO::IOSocketMultiOperationDep<Detail::IO::OutputSocketOperationDep, char[256]> send{
+        sender.GetSocketResource(), outputs, 256};
+
+    auto sent = batch.Send(send);
+    ASSERT_TRUE(sent.HasResult());
+    ASSERT_EQ(sent.GetResult(), 4);
+
+    std::array<InputBuffer, 8> inputs{};
+    Detail::IO::IOSocketMultiOperationDep<Detail::IO::InputSocketOperationDep, char[256]> receive{
+        receiver.GetSocketResource(), inputs, 256};
+
+    auto received = batch.Receive(receive);
+    ASSERT_TRUE(received.HasResult());
+    ASSERT_EQ(received.GetResult(), 4);
+    for(std::size_t i = 0; i < 4; ++i)
+    {
+        ASSERT_EQ(inputs[i].inputNumberBytes, i + 1);
+        ASSERT_EQ(inputs[i].buffer[0], 'a' + static_cast<int>(i));
+    }
+}
+
+TEST_F(DatagramTest, ReplyToSources)
+{
+    // A second unconnected sender, each one must get its own datagram back.
+    BasicSocket other;
+    Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_DGRAM, .protocol = 0};
+    ASSERT_TRUE(other.OpenSocket(deps));
+    sockaddr_storage address{};
+    socklen_t length;
+    receiver.GetLocalAddress(address, length);
+
+    ASSERT_EQ(sender.Write(std::as_bytes(std::span("from sender", 11))).GetResult(), 11);
+    ASSERT_EQ(::sendto(other.GetSocketResource(), "other", 5, 0, reinterpret_cast<sockaddr*>(&address), length), 5);
+
+    DatagramBatch batch(4);
+    std::array<InputBuffer, 4> inputs{};
+    Detail::IO::IOSocketMultiOperationDep<Detail::IO::InputSocketOperationDep, char[256]> receive{
+        receiver.GetSocketResource(), inputs, 256};
+    auto result = batch.Receive(receive);
+    ASSERT_TRUE(result.HasResult());
+    std::size_t received = result.GetResult();
+    ASSERT_EQ(received, 2);
+
+    std::array<OutputBuffer, 4> outputs{};
+    for(std::size_t i = 0; i < received; ++i)
+    {
+        outputs[i].outputNumberBytes = inputs[i].inputNumberBytes;
+        std::memcpy(outputs[i].buffer, inputs[i].buffer, inputs[i].inputNumberBytes);
+    }
+    Detail::IO::IOSocketMultiOperationDep<Detail::IO::OutputSocketOperationDep, char[256]> reply{
+        receiver.GetSocketResource(), outputs, 256};
+    ASSERT_EQ(batch.Reply(reply).GetResult(), 2);
+
+    std::array<std::byte, 64> buffer{};
+    ASSERT_EQ(sender.Read(buffer).GetResult(), 11);
+    ASSERT_EQ(std::memcmp(buffer.data(), "from sender", 11), 0);
+    ASSERT_EQ(other.Read(buffer).GetResult(), 5);
+    ASSERT_EQ(std::memcmp(buffer.data(), "other", 5), 0);
+}
+
+TEST_F(DatagramTest, SegmentedSend)
+{
+    std::array<std::byte, 1000> payload{};
+    auto sent = DatagramBatch::SendSegmented(sender, payload, 300);
+    if(!sent.HasResult())
+    {
+        GTEST_SKIP() << "UDP segmentation offload unavailable: " << sent.GetError();
+    }
+    ASSERT_EQ(sent.GetResult(), payload.size());
+
+    DatagramBatch batch;
+    std::array<InputBuffer, 8> inputs{};
+    Detail::IO::IOSocketMultiOperationDep<Detail::IO::InputSocketOperationDep, char[256]> receive{
+        receiver.GetSocketResource(), inputs, 256};
+    // Datagrams larger than the buffer are truncated, 4 segments are expected.
+    auto received = batch.Receive(receive);
+    ASSERT_EQ(received.GetResult(), 4);
+    ASSERT_EQ(inputs[3].inputNumberBytes, 100);
+}
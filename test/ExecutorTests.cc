@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Executor.hh>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Eagle::Core;
+
+TEST(Executor, WorkStealingDeque)
+{
+    Detail::WorkStealingDeque<int*> deque(2);
+    int values[8]{};
+    for(auto& value : values)
+    {
+        deque.Push(&value);
+    }
+    ASSERT_EQ(deque.Size(), 8);
+
+    // Owner pops the newest, thieves take the oldest.
+    ASSERT_EQ(deque.Take(), &values[7]);
+    ASSERT_EQ(deque.Steal(), &values[0]);
+    ASSERT_EQ(deque.Size(), 6);
+
+    while(deque.Take() != nullptr) {}
+    ASSERT_EQ(deque.Steal(), nullptr);
+    ASSERT_EQ(deque.Size(), 0);
+}
+
+TEST(Executor, WorkStealingDequeConcurrentSteal)
+{
+    constexpr int count = 100000;
+    Detail::WorkStealingDeque<int*> deque;
+    std::vector<int> values(count);
+    std::vector<std::atomic<int>> seen(count);
+    std::atomic<bool> done{false};
+
+    auto record = [&](int* value) { seen[value - values.data()].fetch_add(1); };
+    std::vector<std::thread> thieves;
+    for(int i = 0; i < 3; ++i)
+    {
+        thieves.emplace_back([&] {
+            while(!done.load() || deque.Size() > 0)
+            {
+                if(auto* value = deque.Steal()) record(value);
+            }
+        });
+    }
+
+    for(int i = 0; i < count; ++i)
+    {
+        deque.Push(&values[i]);
+        if(i % 3 == 0)
+        {
+            if(auto* value = deque.Take()) record(value);
+        }
+    }
+    while(auto* value = deque.Take())
+    {
+        record(value);
+    }
+    done.store(true);
+    for(auto& thief : thieves) thief.join();
+
+    for(auto& value : seen)
+    {
+        ASSERT_EQ(value.load(), 1);
+    }
+}
+
+TEST(Executor, Submit)
+{
+    Executor executor(2);
+    ASSERT_EQ(executor.GetWorkerCount(), 2);
+
+    auto value = executor.Submit([] { return 42; });
+    auto result = value.Get();
+    ASSERT_TRUE(result.HasResult());
+    ASSERT_EQ(result.GetResult(), 42);
+    ASSERT_FALSE(value.IsValid());
+
+    std::atomic<bool> ran{false};
+    auto done = executor.Submit([&ran] { ran.store(true); });
+    ASSERT_TRUE(done.Get().HasResult());
+    ASSERT_TRUE(ran.load());
+
+    auto failed = executor.Submit([]() -> int { throw std::runtime_error("handler"); });
+    auto error = failed.Get();
+    ASSERT_FALSE(error.HasResult());
+    ASSERT_EQ(error.GetError().code, ExecutorError::Code::Exception);
+    ASSERT_THROW(std::rethrow_exception(error.GetError().exception), std::runtime_error);
+}
+
+TEST(Executor, PostRunsEveryTask)
+{
+    std::atomic<int> counter{0};
+    {
+        Executor executor(4);
+        for(int i = 0; i < 1000; ++i)
+        {
+            ASSERT_TRUE(executor.Post([&executor, &counter] {
+                counter.fetch_add(1);
+                executor.Post([&counter] { counter.fetch_add(1); });
+            }));
+        }
+    }
+    ASSERT_EQ(counter.load(), 2000);
+}
+
+TEST(Executor, IdleWorkersStealFromBlockedWorker)
+{
+    Executor executor(2);
+    constexpr int children = 64;
+    std::latch finished(children);
+
+    // The parent queues its children on its own deque and blocks until they are
+    // done, which only happens if the other worker steals them.
+    auto parent = executor.Submit([&executor, &finished] {
+        for(int i = 0; i < children; ++i)
+        {
+            executor.Post([&finished] { finished.count_down(); });
+        }
+        finished.wait();
+    });
+
+    ASSERT_TRUE(parent.WaitFor(std::chrono::seconds(10)));
+    ASSERT_TRUE(parent.Get().HasResult());
+    ASSERT_GT(executor.GetStealCount(), 0);
+
+    auto statistics = executor.GetStatistics();
+    ASSERT_EQ(statistics.queued, 0);
+    ASSERT_GE(statistics.executed, children);
+    ASSERT_EQ(statistics.steals, executor.GetStealCount());
+}
+
+TEST(Executor, LvalueCallables)
+{
+    std::atomic<int> calls{0};
+    auto task = [&calls] { return ++calls; };
+    {
+        Executor executor(2);
+        ASSERT_TRUE(executor.Post(task));
+        auto future = executor.Submit(task);
+        ASSERT_TRUE(future.Get().HasResult());
+
+        const auto constTask = task;
+        ASSERT_TRUE(executor.Post(constTask));
+    }
+    ASSERT_EQ(calls.load(), 3);
+}
+
+TEST(Executor, Shutdown)
+{
+    Executor executor(1);
+    executor.Shutdown();
+
+    ASSERT_FALSE(executor.Post([] {}));
+    auto rejected = executor.Submit([] { return 1; });
+    ASSERT_TRUE(rejected.IsReady());
+    auto result = rejected.Get();
+    ASSERT_FALSE(result.HasResult());
+    ASSERT_EQ(result.GetError().code, ExecutorError::Code::Cancelled);
+}
+
+TEST(Executor, ShutdownFromWorker)
+{
+    std::atomic<int> ran{0};
+    {
+        Executor executor(2);
+        std::latch done(1);
+        ASSERT_TRUE(executor.Post([&] {
+            executor.Shutdown();
+            ++ran;
+            done.count_down();
+        }));
+        done.wait();
+        ASSERT_FALSE(executor.Post([&ran] { ++ran; }));
+    }
+    ASSERT_EQ(ran.load(), 1);
+}
@@ -0,0 +1,223 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <EagleNetwork/Framing.hh>
+#include <EagleNetwork/Socket.hh>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <vector>
+
+using namespace Eagle;
+
+namespace
+{
+    std::span<const std::byte> AsBytes(std::string_view text)
+    {
+        return std::as_bytes(std::span(text.data(), text.size()));
+    }
+
+    std::string_view AsText(std::span<const std::byte> bytes)
+    {
+        return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    }
+
+    template <typename TFramer>
+    void Feed(Core::FrameReader<TFramer>& reader, std::string_view bytes)
+    {
+        auto space = reader.PrepareWrite(bytes.size());
+        ASSERT_GE(space.size(), bytes.size());
+        std::memcpy(space.data(), bytes.data(), bytes.size());
+        reader.Commit(bytes.size());
+    }
+
+    template <typename TFramer>
+    std::vector<std::string> TakeFrames(Core::FrameReader<TFramer>& reader)
+    {
+        std::vector<std::string> frames;
+        while(true)
+        {
+            auto frame = reader.Next();
+            if(frame.HasError())
+            {
+                EXPECT_EQ(frame.GetError(), Core::FrameError::Incomplete);
+                return frames;
+            }
+            frames.emplace_back(AsText(frame.GetResult()));
+        }
+    }
+}
+
+TEST(Framing, FindDelimiterMatchesNaiveSearch) {
+    std::mt19937 random(7);
+    for(std::string_view delimiter : {"\n", "\r\n", "abc", "aaaa", "0123456789abcdef"})
+    {
+        for(std::size_t size = 0; size < 150; ++size)
+        {
+            std::string haystack(size, 'x');
+            // A small alphabet makes partial matches and repeated first bytes common.
+            for(auto& character : haystack) character = "abc\r\n01"[random() % 7];
+            auto expected = haystack.find(delimiter);
+            if(expected == std::string::npos) expected = size;
+
+            ASSERT_EQ(Core::Detail::FindDelimiter(AsBytes(haystack), AsBytes(delimiter)), expected)
+                << "delimiter " << delimiter.size() << " size " << size;
+        }
+    }
+}
+
+TEST(Framing, FindDelimiterAtEveryPosition) {
+    for(std::size_t position = 0; position < 100; ++position)
+    {
+        std::string haystack(100, '.');
+        haystack.replace(position, 2, "\r\n");
+        ASSERT_EQ(Core::Detail::FindDelimiter(AsBytes(haystack), AsBytes("\r\n")), position);
+    }
+}
+
+TEST(Framing, DelimitedFramesAcrossReads) {
+    Core::FrameReader reader(Core::DelimiterFramer("\r\n"));
+    Feed(reader, "GET\r\nPI");
+    ASSERT_EQ(TakeFrames(reader), std::vector<std::string>{"GET"});
+    Feed(reader, "NG\r");
+    ASSERT_TRUE(TakeFrames(reader).empty());
+    Feed(reader, "\n\r\nlast\r\n");
+    ASSERT_EQ(TakeFrames(reader), (std::vector<std::string>{"PING", "", "last"}));
+    ASSERT_EQ(reader.GetBufferedSize(), 0);
+}
+
+TEST(Framing, FramesAreViewsOfTheReceiveBuffer) {
+    Core::FrameReader reader(Core::DelimiterFramer("\n"));
+    auto space = reader.PrepareWrite(8);
+    std::memcpy(space.data(), "one\ntwo\n", 8);
+    reader.Commit(8);
+
+    auto first = reader.Next();
+    auto second = reader.Next();
+    ASSERT_EQ(first.GetResult().data(), space.data());
+    ASSERT_EQ(second.GetResult().data(), space.data() + 4);
+}
+
+TEST(Framing, DelimitedFrameTooLarge) {
+    Core::FrameReader reader(Core::DelimiterFramer("\n"), 8);
+    Feed(reader, "12345678\n");
+    ASSERT_EQ(TakeFrames(reader), std::vector<std::string>{"12345678"});
+    Feed(reader, "123456789");
+    ASSERT_EQ(reader.Next().GetError(), Core::FrameError::TooLarge);
+}
+
+TEST(Framing, DelimiterLengthIsChecked) {
+    ASSERT_THROW(Core::DelimiterFramer(""), Core::DelimiterFramerCreationFailure);
+    ASSERT_THROW(Core::DelimiterFramer(std::string(Core::DelimiterFramer::MaxDelimiterLength + 1, '-')),
+        Core::DelimiterFramerCreationFailure);
+
+    std::string longest(Core::DelimiterFramer::MaxDelimiterLength, '-');
+    Core::FrameReader reader(Core::DelimiterFramer{longest});
+    Feed(reader, "one" + longest + "two" + longest.substr(1) + "-");
+    ASSERT_EQ(TakeFrames(reader), (std::vector<std::string>{"one", "two"}));
+}
+
+TEST(Framing, LengthPrefixRoundTrip) {
+    for(auto prefix : {Core::LengthPrefix::Varint, Core::LengthPrefix::Fixed16, Core::LengthPrefix::Fixed32})
+    {
+        Core::LengthPrefixFramer framer(prefix);
+        std::string stream;
+        std::vector<std::string> expected;
+        for(std::size_t length : {0, 1, 127, 128, 300, 16383, 16384, 65535})
+        {
+            std::array<std::byte, Core::LengthPrefixFramer::MaxPrefixLength> encoded;
+            auto prefixLength = framer.EncodePrefix(length, encoded);
+            ASSERT_NE(prefixLength, 0);
+            stream += AsText(std::span(encoded).first(prefixLength));
+            expected.emplace_back(length, static_cast<char>('a' + length % 26));
+            stream += expected.back();
+        }
+
+        // Deliver the stream in uneven pieces so prefixes and payloads split.
+        Core::FrameReader reader(framer);
+        std::vector<std::string> frames;
+        for(std::size_t offset = 0; offset < stream.size(); offset += 997)
+        {
+            Feed(reader, std::string_view(stream).substr(offset, 997));
+            auto taken = TakeFrames(reader);
+            frames.insert(frames.end(), taken.begin(), taken.end());
+        }
+        ASSERT_EQ(frames, expected);
+    }
+}
+
+TEST(Framing, LengthPrefixEncoding) {
+    std::array<std::byte, Core::LengthPrefixFramer::MaxPrefixLength> encoded;
+    Core::LengthPrefixFramer varint(Core::LengthPrefix::Varint);
+    ASSERT_EQ(varint.EncodePrefix(300, encoded), 2);
+    ASSERT_EQ(encoded[0], std::byte{0xac});
+    ASSERT_EQ(encoded[1], std::byte{0x02});
+    ASSERT_EQ(varint.EncodePrefix(UINT64_MAX, encoded), 10);
+
+    Core::LengthPrefixFramer fixed(Core::LengthPrefix::Fixed16);
+    ASSERT_EQ(fixed.EncodePrefix(0x1234, encoded), 2);
+    ASSERT_EQ(encoded[0], std::byte{0x12});
+    ASSERT_EQ(encoded[1], std::byte{0x34});
+    ASSERT_EQ(fixed.EncodePrefix(0x10000, encoded), 0);
+}
+
+TEST(Framing, LengthPrefixErrors) {
+    Core::FrameReader tooLarge(Core::LengthPrefixFramer(Core::LengthPrefix::Fixed32), 1024);
+    Feed(tooLarge, std::string_view("\x00\x00\x04\x01", 4));
+    ASSERT_EQ(tooLarge.Next().GetError(), Core::FrameError::TooLarge);
+
+    Core::FrameReader malformed(Core::LengthPrefixFramer(Core::LengthPrefix::Varint));
+    Feed(malformed, std::string(10, '\xff'));
+    ASSERT_EQ(malformed.Next().GetError(), Core::FrameError::Malformed);
+}
+
+TEST(Framing, FillFromSocket) {
+    int pair[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    Core::BasicSocket writer(pair[0]);
+    Core::BasicSocket reading(pair[1]);
+
+    Core::LengthPrefixFramer framer(Core::LengthPrefix::Fixed16);
+    Core::FrameReader reader(framer);
+    std::string payload(50000, 'z');
+    ASSERT_TRUE(writer.Write(AsBytes(std::string_view("\xc3\x50", 2))).HasResult());
+
+    std::size_t written = 0;
+    std::vector<std::string> frames;
+    while(frames.empty())
+    {
+        if(written < payload.size())
+        {
+            auto sent = writer.Write(AsBytes(std::string_view(payload).substr(written, 8192)));
+            ASSERT_TRUE(sent.HasResult());
+            written += sent.GetResult();
+        }
+        ASSERT_TRUE(reader.Fill(reading).HasResult());
+        frames = TakeFrames(reader);
+    }
+    ASSERT_EQ(frames.size(), 1);
+    ASSERT_EQ(frames.front(), payload);
+}
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <EagleNetwork/HandleTable.hh>
+#include <vector>
+
+using namespace Eagle::Core;
+
+TEST(HandleTable, AcquireAndRelease)
+{
+    HandleTable table;
+    auto acquired = table.Acquire(7);
+    ASSERT_TRUE(acquired.HasResult());
+    auto handle = acquired.GetResult();
+    ASSERT_TRUE(handle.IsValid());
+    ASSERT_EQ(handle.index, 7);
+    ASSERT_TRUE(table.Contains(handle));
+    ASSERT_EQ(table.Find(7), handle);
+    ASSERT_EQ(table.GetCount(), 1);
+    ASSERT_EQ(table.GetCapacity(), 8);
+
+    auto again = table.Acquire(7);
+    ASSERT_TRUE(again.HasError());
+    ASSERT_EQ(again.GetError(), HandleTableError::InUse);
+    ASSERT_EQ(table.Acquire(-1).GetError(), HandleTableError::InvalidResource);
+
+    ASSERT_FALSE(table.Find(3).IsValid());
+    ASSERT_FALSE(table.Find(100).IsValid());
+
+    ASSERT_TRUE(table.Release(handle));
+    ASSERT_FALSE(table.Release(handle));
+    ASSERT_FALSE(table.Contains(handle));
+    ASSERT_FALSE(table.Find(7).IsValid());
+    ASSERT_EQ(table.GetCount(), 0);
+}
+
+TEST(HandleTable, StaleHandleAfterReuse)
+{
+    HandleTable table;
+    auto first = table.Acquire(3).GetResult();
+    table.GetOutboundBytes(first) = 42;
+    table.GetState(first) = 2;
+    ASSERT_TRUE(table.Release(first));
+
+    // The same resource comes back for another connection with fresh fields.
+    auto second = table.Acquire(3).GetResult();
+    ASSERT_EQ(second.index, first.index);
+    ASSERT_NE(second.generation, first.generation);
+    ASSERT_FALSE(table.Contains(first));
+    ASSERT_TRUE(table.Contains(second));
+    ASSERT_EQ(table.GetOutboundBytes(second), 0);
+    ASSERT_EQ(table.GetState(second), 0);
+    ASSERT_EQ(table.GetContext(second), nullptr);
+
+    ASSERT_FALSE(table.Release(first));
+    ASSERT_TRUE(table.Contains(second));
+}
+
+TEST(HandleTable, RejectsFabricatedHandles)
+{
+    HandleTable table;
+    auto handle = table.Acquire(5).GetResult();
+    ASSERT_TRUE(table.Release(handle));
+
+    // Slots below the highest acquired resource exist but were never acquired.
+    ASSERT_FALSE(table.Contains({2, 0}));
+    ASSERT_FALSE(table.Release({2, 0}));
+    ASSERT_FALSE(table.Contains({5, handle.generation + 1}));
+    ASSERT_EQ(table.GetCount(), 0);
+}
+
+TEST(HandleTable, FieldsSurviveGrowth)
+{
+    HandleTable table(4);
+    std::vector<ConnectionHandle> handles;
+    for(int resource = 0; resource < 1000; ++resource)
+    {
+        auto handle = table.Acquire(resource).GetResult();
+        table.GetInterest(handle) = static_cast<std::uint32_t>(resource % 3);
+        table.GetOutboundBytes(handle) = static_cast<std::size_t>(resource);
+        handles.push_back(handle);
+    }
+
+    for(int resource = 0; resource < 1000; ++resource)
+    {
+        auto handle = handles[resource];
+        ASSERT_TRUE(table.Contains(handle));
+        ASSERT_EQ(table.GetInterest(handle), static_cast<std::uint32_t>(resource % 3));
+        ASSERT_EQ(table.GetOutboundBytes(handle), static_cast<std::size_t>(resource));
+    }
+    ASSERT_EQ(table.GetCount(), 1000);
+}
+
+TEST(HandleTable, PackRoundTrip)
+{
+    ConnectionHandle handle{123456, 0xdeadbeef};
+    ASSERT_EQ(ConnectionHandle::Unpack(handle.Pack()), handle);
+    ASSERT_FALSE(ConnectionHandle{}.IsValid());
+}
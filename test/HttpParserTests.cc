@@ -0,0 +1,232 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <EagleNetwork/HttpParser.hh>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Eagle;
+
+TEST(HttpParser, Request) {
+    std::string_view text = "GET /index.html?q=1 HTTP/1.1\r\n"
+                            "Host: example.com\r\n"
+                            "User-Agent:\t eagle \r\n"
+                            "X-Empty:\r\n"
+                            "\r\n";
+    std::array<Core::HttpHeader, 8> headers;
+    auto request = Core::HttpParser::ParseRequest(text, headers);
+    ASSERT_TRUE(request.HasResult());
+
+    auto& head = request.GetResult();
+    ASSERT_EQ(head.method, "GET");
+    ASSERT_EQ(head.target, "/index.html?q=1");
+    ASSERT_EQ(head.minorVersion, 1);
+    ASSERT_EQ(head.headLength, text.size());
+    ASSERT_EQ(head.headers.size(), 3);
+    ASSERT_EQ(head.headers[0].name, "Host");
+    ASSERT_EQ(head.headers[0].value, "example.com");
+    ASSERT_EQ(head.headers[1].value, "eagle");
+    ASSERT_EQ(head.headers[2].value, "");
+    ASSERT_TRUE(head.headers[1].NameEquals("user-agent"));
+    ASSERT_FALSE(head.headers[1].NameEquals("user_agent"));
+
+    // Views point into the parsed buffer.
+    ASSERT_EQ(head.target.data(), text.data() + 4);
+}
+
+TEST(HttpParser, LongValuesCrossVectorBoundaries) {
+    for(std::size_t length = 0; length < 100; ++length)
+    {
+        std::string value(length, 'v');
+        std::string target = "/" + std::string(length, 't');
+        auto text = "POST " + target + " HTTP/1.0\r\nX-Long: " + value + "\r\n\r\n";
+        std::array<Core::HttpHeader, 1> headers;
+        auto request = Core::HttpParser::ParseRequest(text, headers);
+        ASSERT_TRUE(request.HasResult()) << length;
+        ASSERT_EQ(request.GetResult().target, target);
+        ASSERT_EQ(request.GetResult().headers[0].value, value);
+        ASSERT_EQ(request.GetResult().minorVersion, 0);
+
+        // A control character anywhere in the value is rejected.
+        if(length > 0)
+        {
+            text[text.find("X-Long: ") + 8 + length / 2] = '\x01';
+            ASSERT_EQ(Core::HttpParser::ParseRequest(text, headers).GetError(), Core::HttpParseError::Malformed);
+        }
+    }
+}
+
+TEST(HttpParser, LongTokensWithSymbols) {
+    for(std::string name : {"X|Pipe-Header-Name-Long", "X~Tilde-Header-Name-Long", "X|~|~|~|~|~|~|~|~|~|~|~|~|~|~"})
+    {
+        std::string method = "M" + name.substr(1) + "-Method";
+        auto text = method + " / HTTP/1.1\r\n" + name + ": value\r\n\r\n";
+        std::array<Core::HttpHeader, 1> headers;
+        auto request = Core::HttpParser::ParseRequest(text, headers);
+        ASSERT_TRUE(request.HasResult()) << name;
+        ASSERT_EQ(request.GetResult().method, method);
+        ASSERT_EQ(request.GetResult().headers[0].name, name);
+        ASSERT_EQ(request.GetResult().headers[0].value, "value");
+
+        // A real separator past the symbols still ends the token.
+        text[text.find(name) + name.size() - 1] = '{';
+        ASSERT_EQ(Core::HttpParser::ParseRequest(text, headers).GetError(), Core::HttpParseError::Malformed);
+    }
+}
+
+TEST(HttpParser, IncompleteUntilHeadEnds) {
+    std::string_view text = "GET / HTTP/1.1\r\nHost: a\r\n\r\n";
+    std::array<Core::HttpHeader, 4> headers;
+    std::size_t searched = 0;
+    for(std::size_t length = 0; length < text.size(); ++length)
+    {
+        auto request = Core::HttpParser::ParseRequest(text.substr(0, length), headers, searched);
+        ASSERT_EQ(request.GetError(), Core::HttpParseError::Incomplete) << length;
+        searched = length;
+    }
+    ASSERT_TRUE(Core::HttpParser::ParseRequest(text, headers, searched).HasResult());
+}
+
+TEST(HttpParser, PipelinedRequests) {
+    std::string_view text = "\r\nGET /a HTTP/1.1\r\n\r\n"
+                            "POST /b HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello"
+                            "GET /c HTTP/1.1\r\nHost: x\r\n\r\n";
+    std::array<Core::HttpHeader, 4> headers;
+    std::vector<std::string> targets;
+    while(!text.empty())
+    {
+        auto request = Core::HttpParser::ParseRequest(text, headers);
+        ASSERT_TRUE(request.HasResult());
+        auto body = Core::HttpParser::GetRequestBody(request.GetResult());
+        ASSERT_TRUE(body.HasResult());
+        targets.emplace_back(request.GetResult().target);
+        text.remove_prefix(request.GetResult().headLength + body.GetResult().length);
+    }
+    ASSERT_EQ(targets, (std::vector<std::string>{"/a", "/b", "/c"}));
+}
+
+TEST(HttpParser, MalformedRequests) {
+    std::array<Core::HttpHeader, 2> headers;
+    for(std::string_view text : {
+            "GET  / HTTP/1.1\r\n\r\n",
+            "GET / HTTP/2.0\r\n\r\n",
+            "GET / HTTP/1.1\r\nNo-Colon\r\n\r\n",
+            "GET / HTTP/1.1\r\nBad Name: x\r\n\r\n",
+            "GET / HTTP/1.1\r\nA: b\r\n folded\r\n\r\n",
+            "GET / HTTP/1.1\r\nA: b\nC: d\r\n\r\n",
+            "G(T / HTTP/1.1\r\n\r\n"})
+    {
+        ASSERT_EQ(Core::HttpParser::ParseRequest(text, headers).GetError(), Core::HttpParseError::Malformed) << text;
+    }
+
+    ASSERT_EQ(Core::HttpParser::ParseRequest("GET / HTTP/1.1\r\nA: 1\r\nB: 2\r\nC: 3\r\n\r\n", headers).GetError(),
+        Core::HttpParseError::TooManyHeaders);
+}
+
+TEST(HttpParser, Response) {
+    std::string_view text = "HTTP/1.1 404 Not Found\r\nContent-Length: 3\r\n\r\nabc";
+    std::array<Core::HttpHeader, 4> headers;
+    auto response = Core::HttpParser::ParseResponse(text, headers);
+    ASSERT_TRUE(response.HasResult());
+    ASSERT_EQ(response.GetResult().status, 404);
+    ASSERT_EQ(response.GetResult().reason, "Not Found");
+    ASSERT_EQ(text.substr(response.GetResult().headLength), "abc");
+
+    auto body = Core::HttpParser::GetResponseBody(response.GetResult());
+    ASSERT_EQ(body.GetResult().kind, Core::HttpBody::Kind::ContentLength);
+    ASSERT_EQ(body.GetResult().length, 3);
+    ASSERT_EQ(Core::HttpParser::GetResponseBody(response.GetResult(), "HEAD").GetResult().kind,
+        Core::HttpBody::Kind::None);
+
+    auto bare = Core::HttpParser::ParseResponse("HTTP/1.0 200\r\n\r\n", headers);
+    ASSERT_TRUE(bare.HasResult());
+    ASSERT_EQ(bare.GetResult().reason, "");
+    ASSERT_EQ(Core::HttpParser::GetResponseBody(bare.GetResult()).GetResult().kind, Core::HttpBody::Kind::UntilClose);
+}
+
+TEST(HttpParser, BodyFraming) {
+    std::array<Core::HttpHeader, 4> headers;
+    auto bodyOf = [&headers](std::string_view text) {
+        auto request = Core::HttpParser::ParseRequest(text, headers);
+        EXPECT_TRUE(request.HasResult());
+        return Core::HttpParser::GetRequestBody(request.GetResult());
+    };
+
+    ASSERT_EQ(bodyOf("POST / HTTP/1.1\r\nTransfer-Encoding: gzip, Chunked\r\n\r\n").GetResult().kind,
+        Core::HttpBody::Kind::Chunked);
+    ASSERT_EQ(bodyOf("POST / HTTP/1.1\r\nContent-Length: 7\r\ncontent-length: 7\r\n\r\n").GetResult().length, 7);
+
+    // Ambiguous framing is what request smuggling feeds on.
+    ASSERT_EQ(bodyOf("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 7\r\n\r\n").GetError(),
+        Core::HttpParseError::Malformed);
+    ASSERT_EQ(bodyOf("POST / HTTP/1.1\r\nContent-Length: 7\r\nContent-Length: 8\r\n\r\n").GetError(),
+        Core::HttpParseError::Malformed);
+    ASSERT_EQ(bodyOf("POST / HTTP/1.1\r\nTransfer-Encoding: chunked, gzip\r\n\r\n").GetError(),
+        Core::HttpParseError::Malformed);
+    ASSERT_EQ(bodyOf("POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n").GetError(), Core::HttpParseError::Malformed);
+    ASSERT_EQ(bodyOf("POST / HTTP/1.1\r\nContent-Length: 99999999999999999999\r\n\r\n").GetError(),
+        Core::HttpParseError::TooLarge);
+}
+
+TEST(HttpChunkedDecoder, DecodeInPlace) {
+    std::string text = "5;name=value\r\nhello\r\n6\r\n world\r\n0\r\nTrailer: x\r\n\r\nNEXT";
+    Core::HttpChunkedDecoder decoder;
+    auto progress = decoder.Decode(text);
+    ASSERT_TRUE(progress.HasResult());
+    ASSERT_TRUE(progress.GetResult().complete);
+    ASSERT_EQ(text.substr(0, progress.GetResult().decoded), "hello world");
+    ASSERT_EQ(text.substr(progress.GetResult().consumed), "NEXT");
+}
+
+TEST(HttpChunkedDecoder, DecodeAcrossReads) {
+    std::string_view text = "A\r\n0123456789\r\n3\r\nabc\r\n0\r\n\r\n";
+    for(std::size_t split = 0; split <= text.size(); ++split)
+    {
+        Core::HttpChunkedDecoder decoder;
+        std::string decoded;
+        for(auto piece : {text.substr(0, split), text.substr(split)})
+        {
+            std::string buffer(piece);
+            auto progress = decoder.Decode(buffer);
+            ASSERT_TRUE(progress.HasResult());
+            decoded += buffer.substr(0, progress.GetResult().decoded);
+        }
+        ASSERT_TRUE(decoder.IsComplete()) << split;
+        ASSERT_EQ(decoded, "0123456789abc");
+    }
+}
+
+TEST(HttpChunkedDecoder, Malformed) {
+    for(std::string text : {"\r\n", "g\r\n", "5\nhello", "3\r\nabcX", "1;ext\nx\r\n",
+        "0\r\nTrailer: x\n\r\n", "0\r\nTrailer: x\r\n\n", "0\r\n\n", "0\r\nTrailer: x\rY\r\n\r\n"})
+    {
+        Core::HttpChunkedDecoder decoder;
+        ASSERT_EQ(decoder.Decode(text).GetError(), Core::HttpParseError::Malformed) << text;
+    }
+
+    std::string huge = "10000000000000000\r\n";
+    Core::HttpChunkedDecoder decoder;
+    ASSERT_EQ(decoder.Decode(huge).GetError(), Core::HttpParseError::TooLarge);
+}
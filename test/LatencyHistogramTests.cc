@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/LatencyHistogram.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+using namespace Eagle::Core;
+
+TEST(LatencyHistogram, BucketBounds)
+{
+    for(std::uint64_t value : {0ull, 1ull, 63ull, 64ull, 65ull, 1000ull, 123456789ull, (1ull << 39) + 12345})
+    {
+        auto index = LatencyHistogram::GetBucketIndex(value);
+        auto upper = LatencyHistogram::GetBucketUpperBound(index);
+        ASSERT_GE(upper, value);
+        // Relative error within one sub-bucket.
+        ASSERT_LE(static_cast<double>(upper - value), static_cast<double>(value) / LatencyHistogram::SubBucketCount);
+        if(index > 0)
+        {
+            ASSERT_LT(LatencyHistogram::GetBucketUpperBound(index - 1), value);
+        }
+    }
+    ASSERT_EQ(LatencyHistogram::GetBucketIndex(~0ull), LatencyHistogram::BucketCount - 1);
+}
+
+TEST(LatencyHistogram, Percentiles)
+{
+    LatencyHistogram histogram;
+    ASSERT_EQ(histogram.GetValueAtPercentile(50), 0);
+
+    for(std::uint64_t value = 1; value <= 10000; ++value)
+    {
+        histogram.Record(value * 1000);
+    }
+    ASSERT_EQ(histogram.GetCount(), 10000);
+    ASSERT_EQ(histogram.GetMax(), 10'000'000);
+    ASSERT_NEAR(histogram.GetMean(), 5'000'500, 1);
+
+    auto near = [](std::uint64_t actual, double expected) {
+        return std::abs(static_cast<double>(actual) - expected) <= expected / LatencyHistogram::SubBucketCount;
+    };
+    ASSERT_TRUE(near(histogram.GetValueAtPercentile(50), 5'000'000));
+    ASSERT_TRUE(near(histogram.GetValueAtPercentile(99), 9'900'000));
+    ASSERT_TRUE(near(histogram.GetValueAtPercentile(99.9), 9'990'000));
+    ASSERT_EQ(histogram.GetValueAtPercentile(100), 10'000'000);
+}
+
+TEST(LatencyHistogram, MergeAndInterval)
+{
+    LatencyHistogram total;
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<LatencyHistogram>> perThread;
+    for(int t = 0; t < 4; ++t)
+    {
+        perThread.push_back(std::make_unique<LatencyHistogram>());
+    }
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&histogram = *perThread[t], t] {
+            for(int i = 0; i < 1000; ++i) histogram.Record(static_cast<std::uint64_t>(t * 1000 + i));
+        });
+    }
+    for(auto& thread : threads) thread.join();
+    for(auto& histogram : perThread) total.Merge(*histogram);
+
+    ASSERT_EQ(total.GetCount(), 4000);
+    ASSERT_EQ(total.GetMax(), 3999);
+
+    LatencyHistogram interval;
+    total.TakeInterval(interval);
+    ASSERT_EQ(interval.GetCount(), 4000);
+    ASSERT_EQ(total.GetCount(), 0);
+    ASSERT_EQ(total.GetValueAtPercentile(99), 0);
+
+    interval.Reset();
+    ASSERT_EQ(interval.GetCount(), 0);
+}
+
+TEST(LatencyHistogram, SocketTiming)
+{
+    int pair[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    BasicSocket first(pair[0]);
+    BasicSocket second(pair[1]);
+    second.SetNonBlocking(true);
+
+    IoLatencyHistograms histograms;
+    first.SetLatencyHistograms(&histograms);
+    second.SetLatencyHistograms(&histograms);
+    ASSERT_EQ(first.GetLatencyHistograms(), &histograms);
+
+    const std::string message = "timed";
+    ASSERT_TRUE(first.Write(std::as_bytes(std::span(message))).HasResult());
+    char buffer[16];
+    ASSERT_TRUE(second.Read(std::as_writable_bytes(std::span(buffer))).HasResult());
+    ASSERT_EQ(second.Read(std::as_writable_bytes(std::span(buffer))).GetError(), EAGAIN);
+
+    ASSERT_EQ(histograms.write.GetCount(), 1);
+    // The EAGAIN read is not recorded.
+    ASSERT_EQ(histograms.read.GetCount(), 1);
+
+    first.SetLatencyHistograms(nullptr);
+    first.Write(std::as_bytes(std::span(message)));
+    ASSERT_EQ(histograms.write.GetCount(), 1);
+}
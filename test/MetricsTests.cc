@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Datagram.hh>
+#include <EagleNetwork/Metrics.hh>
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <array>
+#include <cerrno>
+#include <span>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+
+using namespace Eagle::Core;
+
+namespace {
+    std::uint64_t Delta(const MetricsSnapshot& before, const MetricsSnapshot& after, Metric metric)
+    {
+        return after.Get(metric) - before.Get(metric);
+    }
+}
+
+TEST(Metrics, SocketCounters)
+{
+#if defined (EAGLE_NET_DISABLE_METRICS)
+    GTEST_SKIP() << "Metrics are disabled.";
+#endif
+    int pair[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    BasicSocket first(pair[0]);
+    BasicSocket second(pair[1]);
+    second.SetNonBlocking(true);
+
+    auto before = Metrics::Snapshot();
+    const std::string message = "metrics";
+    ASSERT_TRUE(first.Write(std::as_bytes(std::span(message))).HasResult());
+
+    char buffer[64];
+    auto read = second.Read(std::as_writable_bytes(std::span(buffer)));
+    ASSERT_EQ(read.GetResult(), message.size());
+    auto empty = second.Read(std::as_writable_bytes(std::span(buffer)));
+    ASSERT_EQ(empty.GetError(), EAGAIN);
+    auto after = Metrics::Snapshot();
+
+    ASSERT_EQ(Delta(before, after, Metric::SocketBytesWritten), message.size());
+    ASSERT_EQ(Delta(before, after, Metric::SocketBytesRead), message.size());
+    ASSERT_EQ(Delta(before, after, Metric::SocketSyscalls), 3);
+    ASSERT_EQ(Delta(before, after, Metric::SocketWouldBlock), 1);
+    ASSERT_EQ(Delta(before, after, Metric::SocketPartialWrites), 0);
+}
+
+TEST(Metrics, BatchedDatagramCounters)
+{
+#if defined (EAGLE_NET_DISABLE_METRICS)
+    GTEST_SKIP() << "Metrics are disabled.";
+#endif
+    int pair[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_DGRAM, 0, pair), 0);
+    BasicSocket first(pair[0]);
+    BasicSocket second(pair[1]);
+
+    using OutputBuffer = Detail::IO::OutputSocketOperationDep<char[64]>;
+    using InputBuffer = Detail::IO::InputSocketOperationDep<char[64]>;
+    std::array<OutputBuffer, 3> outputs{};
+    for(auto& output : outputs) output.outputNumberBytes = 10;
+    std::array<InputBuffer, 4> inputs{};
+    Detail::IO::IOSocketMultiOperationDep<Detail::IO::OutputSocketOperationDep, char[64]> send{
+        first.GetSocketResource(), outputs, 64};
+    Detail::IO::IOSocketMultiOperationDep<Detail::IO::InputSocketOperationDep, char[64]> receive{
+        second.GetSocketResource(), inputs, 64};
+
+    DatagramBatch batch(4);
+    auto before = Metrics::Snapshot();
+    ASSERT_EQ(batch.Send(send).GetResult(), outputs.size());
+    ASSERT_EQ(batch.Receive(receive).GetResult(), outputs.size());
+    auto after = Metrics::Snapshot();
+
+    ASSERT_EQ(Delta(before, after, Metric::SocketSyscalls), 2);
+    ASSERT_EQ(Delta(before, after, Metric::SocketBytesWritten), 30);
+    ASSERT_EQ(Delta(before, after, Metric::SocketBytesRead), 30);
+}
+
+TEST(Metrics, LoopCounters)
+{
+#if defined (EAGLE_NET_DISABLE_METRICS)
+    GTEST_SKIP() << "Metrics are disabled.";
+#endif
+    Reactor reactor;
+    auto before = Metrics::Snapshot();
+    reactor.RunOnce(0);
+    reactor.RunOnce(0);
+    auto after = Metrics::Snapshot();
+
+    ASSERT_EQ(Delta(before, after, Metric::LoopIterations), 2);
+    ASSERT_EQ(Delta(before, after, Metric::LoopEventsDispatched), 0);
+}
+
+TEST(Metrics, ExitedThreadsAndGauges)
+{
+#if defined (EAGLE_NET_DISABLE_METRICS)
+    GTEST_SKIP() << "Metrics are disabled.";
+#endif
+    auto before = Metrics::Snapshot();
+    std::thread([] {
+        Metrics::Add(Metric::SocketQueuedWriteBytes, 100);
+        Metrics::Add(Metric::SocketPartialWrites, 2);
+    }).join();
+    Metrics::Subtract(Metric::SocketQueuedWriteBytes, 40);
+    auto after = Metrics::Snapshot();
+
+    ASSERT_EQ(Delta(before, after, Metric::SocketQueuedWriteBytes), 60);
+    ASSERT_EQ(Delta(before, after, Metric::SocketPartialWrites), 2);
+}
+
+TEST(Metrics, FormatPrometheus)
+{
+    MetricsSnapshot snapshot;
+    snapshot.values[static_cast<std::size_t>(Metric::SocketBytesRead)] = 1234;
+    snapshot.values[static_cast<std::size_t>(Metric::LoopBusyNanoseconds)] = 1'500'000'000;
+
+    auto text = Metrics::FormatPrometheus(snapshot);
+    ASSERT_NE(text.find("# TYPE eagle_socket_bytes_read_total counter\n"), std::string::npos);
+    ASSERT_NE(text.find("\neagle_socket_bytes_read_total 1234\n"), std::string::npos);
+    ASSERT_NE(text.find("# TYPE eagle_socket_queued_write_bytes gauge\n"), std::string::npos);
+    ASSERT_NE(text.find("\neagle_loop_busy_seconds_total 1.5"), std::string::npos);
+    ASSERT_EQ(Metrics::GetName(Metric::SocketSyscalls), "eagle_socket_syscalls_total");
+}
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Mailbox.hh>
+#include <EagleNetwork/MpscQueue.hh>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Eagle::Core;
+
+TEST(BoundedMpscQueue, PushPop)
+{
+    BoundedMpscQueue<std::unique_ptr<int>> queue(3);
+    ASSERT_EQ(queue.Capacity(), 4);
+
+    for(int i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(queue.TryPush(std::make_unique<int>(i)));
+    }
+    auto rejected = std::make_unique<int>(4);
+    ASSERT_FALSE(queue.TryPush(std::move(rejected)));
+    ASSERT_NE(rejected, nullptr);
+    ASSERT_EQ(queue.Size(), 4);
+
+    std::unique_ptr<int> value;
+    ASSERT_TRUE(queue.TryPop(value));
+    ASSERT_EQ(*value, 0);
+
+    std::vector<std::unique_ptr<int>> batch(8);
+    ASSERT_EQ(queue.PopBatch(batch), 3);
+    ASSERT_EQ(*batch[2], 3);
+    ASSERT_FALSE(queue.TryPop(value));
+}
+
+TEST(BoundedMpscQueue, ConcurrentProducers)
+{
+    constexpr std::size_t producers = 4;
+    constexpr std::size_t perProducer = 100000;
+    BoundedMpscQueue<std::size_t> queue(1024);
+
+    std::vector<std::thread> threads;
+    for(std::size_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&queue, p] {
+            for(std::size_t i = 0; i < perProducer; ++i)
+            {
+                while(!queue.TryPush(p * perProducer + i)) std::this_thread::yield();
+            }
+        });
+    }
+
+    // Values of one producer come out in the order it pushed them.
+    std::vector<std::size_t> next(producers, 0);
+    std::size_t received = 0;
+    std::size_t value;
+    while(received < producers * perProducer)
+    {
+        if(!queue.TryPop(value)) continue;
+        auto producer = value / perProducer;
+        ASSERT_EQ(value % perProducer, next[producer]);
+        ++next[producer];
+        ++received;
+    }
+    for(auto& thread : threads) thread.join();
+}
+
+TEST(EventNotifier, Coalesces)
+{
+    EventNotifier notifier;
+    ASSERT_FALSE(notifier.Consume());
+    ASSERT_TRUE(notifier.Notify());
+    ASSERT_FALSE(notifier.Notify());
+    ASSERT_TRUE(notifier.Consume());
+    ASSERT_FALSE(notifier.Consume());
+    ASSERT_TRUE(notifier.Notify());
+}
+
+TEST(Mailbox, DeliversAcrossThreads)
+{
+    constexpr int producers = 3;
+    constexpr int perProducer = 20000;
+
+    Reactor reactor;
+    std::size_t delivered = 0;
+    std::size_t batches = 0;
+    long long sum = 0;
+    Mailbox<int> mailbox(reactor, 4096, [&](std::span<int> batch) {
+        ++batches;
+        delivered += batch.size();
+        for(auto value : batch) sum += value;
+    });
+
+    std::vector<std::thread> threads;
+    for(int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&mailbox] {
+            for(int i = 1; i <= perProducer; ++i)
+            {
+                while(!mailbox.Post(i)) std::this_thread::yield();
+            }
+        });
+    }
+
+    while(delivered < producers * perProducer)
+    {
+        ASSERT_TRUE(reactor.RunOnce(1000).HasResult());
+    }
+    for(auto& thread : threads) thread.join();
+
+    ASSERT_EQ(sum, static_cast<long long>(producers) * perProducer * (perProducer + 1) / 2);
+    ASSERT_LT(batches, delivered);
+}
@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/OutboundQueue.hh>
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <span>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+using namespace Eagle::Core;
+
+namespace {
+    struct ForwardingHandler : IReactorHandler
+    {
+        OutboundQueue* queue{nullptr};
+
+        void OnReadable(BasicSocket&) override {}
+
+        void OnWritable(BasicSocket&) override
+        {
+            if(queue) queue->OnWritable();
+        }
+    };
+
+    struct WatermarkHandler : IOutboundQueueHandler
+    {
+        int highCalls{0};
+        int lowCalls{0};
+        int errors{0};
+        Detail::SocketPlatformErrorType::Type lastError{0};
+
+        void OnHighWatermark(OutboundQueue&) override { ++highCalls; }
+        void OnLowWatermark(OutboundQueue&) override { ++lowCalls; }
+
+        void OnWriteError(OutboundQueue&, Detail::SocketPlatformErrorType::Type error) override
+        {
+            ++errors;
+            lastError = error;
+        }
+    };
+
+    std::pair<BasicSocket, BasicSocket> MakePair(int type)
+    {
+        auto pair = BasicSocket::MakePair({.domain = AF_UNIX, .type = type, .protocol = 0,
+            .options = {.nonBlocking = true, .closeOnExec = true}});
+        return std::move(pair).GetResult();
+    }
+
+    std::span<const std::byte> AsBytes(std::string_view text)
+    {
+        return std::as_bytes(std::span(text.data(), text.size()));
+    }
+}
+
+TEST(OutboundQueue, CoalescesWritesOfOneIteration)
+{
+    Reactor reactor;
+    // Each sendmsg on a seqpacket socket is one record, so the records received count the syscalls.
+    auto [writer, reader] = MakePair(SOCK_SEQPACKET);
+    ForwardingHandler forwarding;
+    OutboundQueue queue(reactor, writer);
+    forwarding.queue = &queue;
+    ASSERT_TRUE(reactor.Register(writer, forwarding, ReactorEvent::Write));
+
+    for(int i = 0; i < 100; ++i)
+    {
+        ASSERT_TRUE(queue.Enqueue(AsBytes("message;")));
+    }
+    ASSERT_EQ(queue.GetQueuedBytes(), 800);
+    auto handle = reactor.GetHandle(writer);
+    ASSERT_EQ(reactor.GetHandles().GetOutboundBytes(handle), 800);
+
+    ASSERT_TRUE(reactor.RunOnce(-1).HasResult());
+    ASSERT_EQ(queue.GetQueuedBytes(), 0);
+    ASSERT_EQ(reactor.GetHandles().GetOutboundBytes(handle), 0);
+
+    std::vector<std::byte> buffer(4096);
+    auto read = reader.Read(buffer);
+    ASSERT_EQ(read.GetResult(), 800);
+    ASSERT_EQ(reader.Read(buffer).GetError(), EAGAIN);
+    reactor.Unregister(writer);
+}
+
+TEST(OutboundQueue, WatermarksPauseAndResumeProducers)
+{
+    Reactor reactor;
+    auto [writer, reader] = MakePair(SOCK_STREAM);
+    writer.SetOption(SOL_SOCKET, SO_SNDBUF, 4096);
+
+    ForwardingHandler forwarding;
+    WatermarkHandler watermarks;
+    OutboundQueue queue(reactor, writer, &watermarks, {.highWatermark = 64 * 1024, .lowWatermark = 16 * 1024});
+    forwarding.queue = &queue;
+    ASSERT_TRUE(reactor.Register(writer, forwarding, ReactorEvent::Write));
+
+    std::string payload;
+    for(int i = 0; payload.size() < 256 * 1024; ++i) payload += std::to_string(i) + ",";
+    std::size_t enqueued = 0;
+    std::string received;
+    std::vector<std::byte> buffer(64 * 1024);
+
+    while(received.size() < payload.size())
+    {
+        // Produce until told to pause, as a well-behaved producer would.
+        while(enqueued < payload.size() && !queue.IsAboveHighWatermark())
+        {
+            auto chunk = std::string_view(payload).substr(enqueued, 1000);
+            ASSERT_TRUE(queue.Enqueue(AsBytes(chunk)));
+            enqueued += chunk.size();
+        }
+        ASSERT_LE(queue.GetQueuedBytes(), 64 * 1024 + 1000);
+
+        ASSERT_TRUE(reactor.RunOnce(0).HasResult());
+        auto read = reader.Read(buffer);
+        if(read.HasResult()) received.append(reinterpret_cast<const char*>(buffer.data()), read.GetResult());
+    }
+
+    ASSERT_EQ(received, payload);
+    ASSERT_GE(watermarks.highCalls, 1);
+    ASSERT_EQ(watermarks.lowCalls, watermarks.highCalls);
+    reactor.Unregister(writer);
+}
+
+TEST(OutboundQueue, WriteErrorClosesQueue)
+{
+    Reactor reactor;
+    auto [writer, reader] = MakePair(SOCK_STREAM);
+    ForwardingHandler forwarding;
+    WatermarkHandler watermarks;
+    OutboundQueue queue(reactor, writer, &watermarks);
+    ASSERT_TRUE(reactor.Register(writer, forwarding, ReactorEvent::Write));
+
+    reader.CloseSocket();
+    ASSERT_TRUE(queue.Enqueue(AsBytes("lost")));
+    ASSERT_TRUE(reactor.RunOnce(-1).HasResult());
+
+    ASSERT_EQ(watermarks.errors, 1);
+    ASSERT_EQ(watermarks.lastError, EPIPE);
+    ASSERT_EQ(queue.GetQueuedBytes(), 0);
+    ASSERT_FALSE(queue.Enqueue(AsBytes("refused")));
+    reactor.Unregister(writer);
+}
+
+TEST(OutboundQueue, DestroyingCancelsScheduledFlush)
+{
+    Reactor reactor;
+    auto [writer, reader] = MakePair(SOCK_STREAM);
+    {
+        OutboundQueue queue(reactor, writer);
+        ASSERT_TRUE(queue.Enqueue(AsBytes("dropped")));
+    }
+    ASSERT_TRUE(reactor.RunOnce(0).HasResult());
+
+    std::vector<std::byte> buffer(16);
+    ASSERT_EQ(reader.Read(buffer).GetError(), EAGAIN);
+}
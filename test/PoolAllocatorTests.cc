@@ -0,0 +1,213 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/PoolAllocator.hh>
+#include <EagleNetwork/Buffer.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace Eagle::Core;
+
+namespace
+{
+    // Global operator new calls made by the calling thread.
+    thread_local std::size_t globalAllocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    ++globalAllocations;
+    if(auto* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+TEST(PoolAllocator, RecyclesBlocks)
+{
+    PoolAllocator pool;
+    auto* first = pool.Allocate(100);
+    auto* second = pool.Allocate(128);
+    ASSERT_NE(first, second);
+
+    auto statistics = pool.GetStatistics();
+    ASSERT_EQ(statistics.misses, 2);
+    ASSERT_EQ(statistics.bytesInUse, 256);
+
+    pool.Deallocate(first, 100);
+    auto* recycled = pool.Allocate(65);
+    ASSERT_EQ(recycled, first);
+
+    statistics = pool.GetStatistics();
+    ASSERT_EQ(statistics.hits, 1);
+    ASSERT_EQ(statistics.highWaterMark, 256);
+
+    pool.Deallocate(second, 128);
+    pool.Deallocate(recycled, 65);
+    ASSERT_EQ(pool.GetStatistics().bytesInUse, 0);
+}
+
+TEST(PoolAllocator, LargeAllocations)
+{
+    PoolAllocator pool;
+    auto* block = pool.Allocate(PoolAllocator::SizeClasses.back() + 1);
+    ASSERT_NE(block, nullptr);
+    pool.Deallocate(block, PoolAllocator::SizeClasses.back() + 1);
+    ASSERT_EQ(pool.GetStatistics().misses, 1);
+    ASSERT_EQ(pool.GetStatistics().chunkBytes, 0);
+}
+
+TEST(PoolAllocator, SteadyStateBuffersHitThePool)
+{
+    auto& pool = PoolAllocator::ForCurrentThread();
+    {
+        ChainedBuffer warmup;
+        warmup.PrepareWrite();
+    }
+
+    auto before = pool.GetStatistics();
+    for(int i = 0; i < 100; ++i)
+    {
+        ChainedBuffer buffer;
+        buffer.PrepareWrite();
+        buffer.Commit(10);
+    }
+    auto after = pool.GetStatistics();
+    ASSERT_EQ(after.misses, before.misses);
+    ASSERT_GT(after.hits, before.hits);
+}
+
+TEST(PoolAllocator, ForeignBlocksReturnToOwner)
+{
+    PoolAllocator owner;
+    PoolAllocator other;
+    auto* block = owner.Allocate(100);
+    other.Deallocate(block, 100);
+    ASSERT_EQ(other.GetStatistics().chunkBytes, 0);
+    ASSERT_EQ(owner.GetStatistics().bytesInUse, 128);
+
+    // The owner picks its block back up once its free list runs dry.
+    ASSERT_EQ(owner.Allocate(128), block);
+    ASSERT_EQ(owner.GetStatistics().hits, 1);
+    owner.Deallocate(block, 128);
+    ASSERT_EQ(owner.GetStatistics().bytesInUse, 0);
+}
+
+TEST(PoolAllocator, ProducerConsumerReusesChunks)
+{
+    std::vector<void*> handoff(1000);
+    PoolAllocatorStatistics producer;
+    std::thread([&] {
+        auto& pool = PoolAllocator::ForCurrentThread();
+        for(int round = 0; round < 100; ++round)
+        {
+            for(auto& block : handoff) block = pool.Allocate(1024);
+            std::thread([&handoff] {
+                for(auto* block : handoff) PoolAllocator::ForCurrentThread().Deallocate(block, 1024);
+            }).join();
+        }
+        producer = pool.GetStatistics();
+    }).join();
+
+    // 100 rounds of 1 MiB would need 50 chunks without the blocks coming back.
+    ASSERT_EQ(producer.chunkBytes, PoolAllocatorOptions{}.chunkSize);
+    // The last round is still on the return list.
+    ASSERT_EQ(producer.bytesInUse, handoff.size() * 1024);
+}
+
+TEST(PoolAllocator, ReleaseAfterOwnerExits)
+{
+    void* block = nullptr;
+    std::thread([&block] {
+        block = PoolAllocator::ForCurrentThread().Allocate(256);
+    }).join();
+
+    // The retired pool is freed with this last block.
+    static_cast<std::byte*>(block)[255] = std::byte{1};
+    PoolAllocator::ForCurrentThread().Deallocate(block, 256);
+}
+
+TEST(PoolAllocator, CrossThreadRelease)
+{
+    ChainedBuffer buffer;
+    std::thread([&buffer] {
+        std::byte data[32]{};
+        buffer.Append(data);
+    }).join();
+
+    ASSERT_EQ(buffer.Size(), 32);
+    buffer.Clear();
+}
+
+TEST(PoolAllocator, SocketPathDoesNotAllocate)
+{
+    Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0};
+    BasicSocket listener;
+    ASSERT_TRUE(listener.OpenSocket(deps));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_TRUE(listener.Bind(reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+    ASSERT_TRUE(listener.Listen());
+    sockaddr_storage local{};
+    socklen_t length = sizeof(local);
+    ASSERT_TRUE(listener.GetLocalAddress(local, length));
+
+    auto round = [&] {
+        BasicSocket client;
+        if(!client.OpenSocket(deps) || !client.Connect(reinterpret_cast<sockaddr*>(&local), length)) return false;
+        auto accepted = listener.Accept(false);
+        if(!accepted) return false;
+        BasicSocket server = std::move(accepted).GetResult();
+
+        std::byte data[64]{};
+        return client.Write(data).HasResult() && server.Read(data).HasResult()
+            && server.Write(data).HasResult() && client.Read(data).HasResult()
+            && server.CloseSocket() && client.CloseSocket();
+    };
+
+    // The first round sets up the thread's pool and metrics slot.
+    ASSERT_TRUE(round());
+    auto before = globalAllocations;
+    bool succeeded = true;
+    for(int i = 0; i < 10; ++i)
+    {
+        succeeded = round() && succeeded;
+    }
+    auto allocations = globalAllocations - before;
+    ASSERT_TRUE(succeeded);
+    ASSERT_EQ(allocations, 0);
+}
@@ -0,0 +1,285 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <chrono>
+#include <span>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Eagle::Core;
+
+namespace {
+    struct EchoHandler : IReactorHandler
+    {
+        Reactor* reactor{nullptr};
+        std::string received;
+        int readableCalls{0};
+        int writableCalls{0};
+        bool closed{false};
+
+        void OnReadable(BasicSocket& socket) override
+        {
+            ++readableCalls;
+            char buffer[64];
+            while(true)
+            {
+                auto result = socket.Read(std::as_writable_bytes(std::span(buffer)));
+                if(!result.HasResult()) break;
+                if(result.GetResult() == 0)
+                {
+                    closed = true;
+                    reactor->Unregister(socket);
+                    break;
+                }
+                received.append(buffer, result.GetResult());
+            }
+        }
+
+        void OnWritable(BasicSocket&) override
+        {
+            ++writableCalls;
+        }
+    };
+
+    struct SocketPair
+    {
+        BasicSocket first;
+        BasicSocket second;
+
+        SocketPair()
+        {
+            int pair[2];
+            ::socketpair(AF_UNIX, SOCK_STREAM, 0, pair);
+            first = pair[0];
+            second = pair[1];
+            first.SetNonBlocking(true);
+            second.SetNonBlocking(true);
+        }
+    };
+}
+
+TEST(Reactor, DispatchReadable)
+{
+    Reactor reactor;
+    SocketPair pair;
+    EchoHandler handler;
+    handler.reactor = &reactor;
+
+    ASSERT_TRUE(reactor.Register(pair.second, handler, ReactorEvent::Read));
+    ASSERT_FALSE(reactor.Register(pair.second, handler, ReactorEvent::Read));
+    ASSERT_EQ(reactor.GetRegisteredCount(), 1);
+
+    const char message[] = "hello";
+    pair.first.Write(std::as_bytes(std::span(message, 5)));
+
+    auto dispatched = reactor.RunOnce(1000);
+    ASSERT_TRUE(dispatched.HasResult());
+    ASSERT_EQ(dispatched.GetResult(), 1);
+    ASSERT_EQ(handler.received, "hello");
+
+    // Edge-triggered: nothing new arrived, so nothing is dispatched.
+    dispatched = reactor.RunOnce(0);
+    ASSERT_EQ(dispatched.GetResult(), 0);
+    ASSERT_EQ(handler.readableCalls, 1);
+
+    pair.first.CloseSocket();
+    reactor.RunOnce(1000);
+    ASSERT_TRUE(handler.closed);
+    ASSERT_EQ(reactor.GetRegisteredCount(), 0);
+}
+
+TEST(Reactor, ModifyInterest)
+{
+    Reactor reactor;
+    SocketPair pair;
+    EchoHandler handler;
+    handler.reactor = &reactor;
+
+    ASSERT_TRUE(reactor.Register(pair.first, handler, ReactorEvent::Read));
+    reactor.RunOnce(0);
+    ASSERT_EQ(handler.writableCalls, 0);
+
+    ASSERT_TRUE(reactor.Modify(pair.first, ReactorEvent::Read | ReactorEvent::Write));
+    reactor.RunOnce(1000);
+    ASSERT_EQ(handler.writableCalls, 1);
+
+    ASSERT_TRUE(reactor.Unregister(pair.first));
+    ASSERT_FALSE(reactor.Modify(pair.first, ReactorEvent::Read));
+}
+
+TEST(Reactor, HangUpReachesWriteOnlyHandler)
+{
+    Reactor reactor;
+    SocketPair pair;
+    EchoHandler handler;
+    handler.reactor = &reactor;
+
+    // With a full send buffer the hang-up arrives without EPOLLOUT.
+    char buffer[4096]{};
+    while(pair.first.Write(std::as_bytes(std::span(buffer))).HasResult()) {}
+    ASSERT_TRUE(reactor.Register(pair.first, handler, ReactorEvent::Write));
+    reactor.RunOnce(0);
+    ASSERT_EQ(handler.writableCalls, 0);
+
+    ASSERT_EQ(::shutdown(pair.second.GetSocketResource(), SHUT_RDWR), 0);
+    reactor.RunOnce(1000);
+    ASSERT_EQ(handler.writableCalls, 1);
+    ASSERT_EQ(handler.readableCalls, 0);
+}
+
+TEST(Reactor, TimerWheelBoundsWait)
+{
+    struct CountingTimerHandler : ITimerHandler
+    {
+        int expired{0};
+        void OnTimerExpired(Timer&) override { ++expired; }
+    };
+
+    Reactor reactor;
+    TimerWheel wheel;
+    CountingTimerHandler handler;
+    Timer timer(handler);
+    reactor.SetTimerWheel(&wheel);
+
+    wheel.Arm(timer, std::chrono::milliseconds(20));
+    auto begin = TimerWheel::Clock::now();
+    while(handler.expired == 0)
+    {
+        ASSERT_TRUE(reactor.RunOnce(-1).HasResult());
+    }
+    ASSERT_GE(TimerWheel::Clock::now() - begin, std::chrono::milliseconds(19));
+    ASSERT_FALSE(timer.IsArmed());
+    reactor.SetTimerWheel(nullptr);
+}
+
+TEST(Reactor, DeferredRunsOncePerSchedule)
+{
+    struct Deferred : IReactorDeferred
+    {
+        std::string* log;
+        int runs{0};
+
+        void OnDeferred(Reactor&) override
+        {
+            ++runs;
+            *log += "deferred;";
+        }
+    };
+
+    Reactor reactor;
+    SocketPair pair;
+    std::string log;
+    EchoHandler handler;
+    handler.reactor = &reactor;
+    ASSERT_TRUE(reactor.Register(pair.first, handler, ReactorEvent::Read));
+
+    Deferred deferred;
+    deferred.log = &log;
+    Deferred cancelled;
+    cancelled.log = &log;
+    reactor.Defer(deferred);
+    reactor.Defer(cancelled);
+    reactor.CancelDeferred(cancelled);
+
+    // Pending deferred work keeps the loop from blocking.
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(reactor.RunOnce(1000).HasResult());
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+    ASSERT_EQ(deferred.runs, 1);
+    ASSERT_EQ(cancelled.runs, 0);
+
+    ASSERT_TRUE(reactor.RunOnce(0).HasResult());
+    ASSERT_EQ(deferred.runs, 1);
+    ASSERT_EQ(log, "deferred;");
+    reactor.Unregister(pair.first);
+}
+
+TEST(Reactor, StaleEventAfterResourceReuse)
+{
+    struct CountingHandler : IReactorHandler
+    {
+        int readableCalls{0};
+        void OnReadable(BasicSocket&) override { ++readableCalls; }
+    };
+
+    // Whichever socket is dispatched first closes the other one and registers a
+    // new socket under the freed resource, the other's queued event is then stale.
+    struct ReplacingHandler : IReactorHandler
+    {
+        Reactor* reactor{nullptr};
+        BasicSocket* sockets[2]{};
+        BasicSocket* replacement{nullptr};
+        CountingHandler* replacementHandler{nullptr};
+        bool replaced{false};
+
+        void OnReadable(BasicSocket& socket) override
+        {
+            if(replaced) return;
+            replaced = true;
+            auto& other = &socket == sockets[0] ? *sockets[1] : *sockets[0];
+            auto resource = other.GetSocketResource();
+            reactor->Unregister(other);
+            other.CloseSocket();
+
+            int fresh = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if(fresh != resource)
+            {
+                ::dup2(fresh, resource);
+                ::close(fresh);
+            }
+            *replacement = resource;
+            ASSERT_TRUE(reactor->Register(*replacement, *replacementHandler, ReactorEvent::Read));
+        }
+    };
+
+    Reactor reactor;
+    SocketPair firstPair;
+    SocketPair secondPair;
+    BasicSocket replacement;
+    CountingHandler replacementHandler;
+    ReplacingHandler handler;
+    handler.reactor = &reactor;
+    handler.sockets[0] = &firstPair.second;
+    handler.sockets[1] = &secondPair.second;
+    handler.replacement = &replacement;
+    handler.replacementHandler = &replacementHandler;
+
+    ASSERT_TRUE(reactor.Register(firstPair.second, handler, ReactorEvent::Read));
+    ASSERT_TRUE(reactor.Register(secondPair.second, handler, ReactorEvent::Read));
+    const char message[] = "x";
+    firstPair.first.Write(std::as_bytes(std::span(message, 1)));
+    secondPair.first.Write(std::as_bytes(std::span(message, 1)));
+
+    auto dispatched = reactor.RunOnce(1000);
+    ASSERT_TRUE(dispatched.HasResult());
+    ASSERT_EQ(dispatched.GetResult(), 2);
+    ASSERT_TRUE(handler.replaced);
+    ASSERT_EQ(replacementHandler.readableCalls, 0);
+    ASSERT_EQ(reactor.GetRegisteredCount(), 2);
+    ASSERT_TRUE(reactor.GetHandle(replacement).IsValid());
+    ASSERT_FALSE(reactor.GetHandle(secondPair.second).IsValid());
+}
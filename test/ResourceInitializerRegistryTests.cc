@@ -0,0 +1,200 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <EagleNetwork/ResourceInitializer.hh>
+#include <EagleNetwork/ResourceInitializerRegistry.hh>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Eagle;
+using namespace Eagle::Core;
+
+namespace
+{
+    /**
+     * Records the order initializers ran in.
+     */
+    struct InitializationLog
+    {
+        std::mutex mutex;
+        std::vector<std::string> order;
+
+        void Append(const std::string& name)
+        {
+            std::lock_guard lock(mutex);
+            order.push_back(name);
+        }
+
+        std::ptrdiff_t PositionOf(const std::string& name)
+        {
+            return std::find(order.begin(), order.end(), name) - order.begin();
+        }
+    };
+
+    auto LoggedInitializer(InitializationLog& log, std::string name, bool succeed = true)
+    {
+        return InlineResourceInitializer([&log, name, succeed]() -> Utilities::Result<int, int> {
+            log.Append(name);
+            if(!succeed) return Utilities::MakeError(-1);
+            return 1;
+        });
+    }
+
+    struct ThrowingInitializer : Utilities::IResourceInitializer
+    {
+        void InitializeResource() override
+        {
+            throw std::runtime_error("initializer");
+        }
+    };
+}
+
+TEST(ResourceInitializerRegistry, DependenciesRunFirst)
+{
+    InitializationLog log;
+    auto config = LoggedInitializer(log, "config");
+    auto pool = LoggedInitializer(log, "pool");
+    auto backend = LoggedInitializer(log, "backend");
+    auto listener = LoggedInitializer(log, "listener");
+
+    ResourceInitializerRegistry registry;
+    auto configNode = registry.Add("config", config);
+    auto poolNode = registry.Add("pool", pool, {configNode});
+    auto backendNode = registry.Add("backend", backend, {configNode});
+    auto listenerNode = registry.Add("listener", listener, {poolNode, backendNode});
+    ASSERT_EQ(registry.GetNodeCount(), 4);
+    ASSERT_EQ(registry.GetName(listenerNode), "listener");
+
+    Executor executor(4);
+    auto summary = registry.Run(executor);
+    ASSERT_EQ(summary.succeeded, 4);
+    ASSERT_EQ(summary.failed, 0);
+    ASSERT_EQ(log.order.size(), 4);
+    ASSERT_EQ(log.PositionOf("config"), 0);
+    ASSERT_EQ(log.PositionOf("listener"), 3);
+    ASSERT_TRUE(listener.IsValidResource());
+    ASSERT_GE(registry.GetTiming(listenerNode).start, registry.GetTiming(poolNode).start);
+
+    // Running again initializes everything again.
+    summary = registry.Run(executor);
+    ASSERT_EQ(summary.succeeded, 4);
+    ASSERT_EQ(log.order.size(), 8);
+}
+
+TEST(ResourceInitializerRegistry, FailureSkipsDependents)
+{
+    InitializationLog log;
+    auto config = LoggedInitializer(log, "config");
+    auto backend = LoggedInitializer(log, "backend", false);
+    auto cache = LoggedInitializer(log, "cache");
+    auto listener = LoggedInitializer(log, "listener");
+    auto metrics = LoggedInitializer(log, "metrics");
+    ThrowingInitializer throwing;
+
+    ResourceInitializerRegistry registry;
+    auto configNode = registry.Add("config", config);
+    auto backendNode = registry.Add("backend", backend, {configNode});
+    auto cacheNode = registry.Add("cache", cache, {backendNode});
+    auto listenerNode = registry.Add("listener", listener, {configNode, cacheNode});
+    auto metricsNode = registry.Add("metrics", metrics, {configNode});
+    auto throwingNode = registry.Add("throwing", throwing);
+
+    Executor executor(2);
+    auto summary = registry.Run(executor);
+    ASSERT_EQ(summary.succeeded, 2);
+    ASSERT_EQ(summary.failed, 4);
+
+    ASSERT_TRUE(registry.GetResult(configNode).HasResult());
+    ASSERT_TRUE(registry.GetResult(metricsNode).HasResult());
+    ASSERT_EQ(registry.GetResult(backendNode).GetError().code, ResourceInitializationError::Code::Failed);
+    ASSERT_EQ(backend.GetActualError(), -1);
+    ASSERT_EQ(registry.GetResult(cacheNode).GetError().code, ResourceInitializationError::Code::DependencyFailed);
+    ASSERT_EQ(registry.GetResult(listenerNode).GetError().code, ResourceInitializationError::Code::DependencyFailed);
+    ASSERT_EQ(log.PositionOf("cache"), static_cast<std::ptrdiff_t>(log.order.size()));
+    ASSERT_EQ(log.PositionOf("listener"), static_cast<std::ptrdiff_t>(log.order.size()));
+
+    const auto& error = registry.GetResult(throwingNode).GetError();
+    ASSERT_EQ(error.code, ResourceInitializationError::Code::Exception);
+    ASSERT_THROW(std::rethrow_exception(error.exception), std::runtime_error);
+}
+
+TEST(ResourceInitializerRegistry, IndependentNodesRunConcurrently)
+{
+    constexpr auto Delay = std::chrono::milliseconds(50);
+    std::vector<InlineResourceInitializer<std::function<Utilities::Result<int, int>()>>> initializers;
+    for(int i = 0; i < 8; ++i)
+    {
+        initializers.emplace_back([Delay]() -> Utilities::Result<int, int> {
+            std::this_thread::sleep_for(Delay);
+            return 1;
+        });
+    }
+
+    ResourceInitializerRegistry registry;
+    for(auto& initializer : initializers)
+    {
+        registry.Add("sleeper", initializer);
+    }
+
+    Executor executor(8);
+    auto summary = registry.Run(executor);
+    ASSERT_EQ(summary.succeeded, 8);
+    ASSERT_LT(summary.elapsed, Delay * 4);
+    for(std::size_t node = 0; node < registry.GetNodeCount(); ++node)
+    {
+        ASSERT_GE(registry.GetTiming(node).duration, Delay);
+    }
+}
+
+TEST(ResourceInitializerRegistry, InvalidDependency)
+{
+    InitializationLog log;
+    auto config = LoggedInitializer(log, "config");
+    ResourceInitializerRegistry registry;
+    ASSERT_THROW(registry.Add("config", config, {0}), ResourceInitializerRegistryInvalidDependency);
+    ASSERT_EQ(registry.GetNodeCount(), 0);
+}
+
+TEST(ResourceInitializerRegistry, CancelledByShutdown)
+{
+    InitializationLog log;
+    auto config = LoggedInitializer(log, "config");
+    auto listener = LoggedInitializer(log, "listener");
+    ResourceInitializerRegistry registry;
+    auto configNode = registry.Add("config", config);
+    auto listenerNode = registry.Add("listener", listener, {configNode});
+
+    Executor executor(1);
+    executor.Shutdown();
+    auto summary = registry.Run(executor);
+    ASSERT_EQ(summary.failed, 2);
+    ASSERT_EQ(registry.GetResult(configNode).GetError().code, ResourceInitializationError::Code::Cancelled);
+    ASSERT_EQ(registry.GetResult(listenerNode).GetError().code, ResourceInitializationError::Code::DependencyFailed);
+    ASSERT_TRUE(log.order.empty());
+}
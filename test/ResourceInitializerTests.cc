@@ -54,3 +54,48 @@ TEST(ResourceInitializer, Initialize)
 
     ASSERT_EQ(res, 1);
 }
+
+TEST(InlineResourceInitializer, WithoutDependencies)
+{
+    InlineResourceInitializer initializer([]() -> Utilities::Result<int, int> { return 42; });
+    ASSERT_FALSE(initializer.IsValidResource());
+
+    initializer.InitializeResource();
+    ASSERT_TRUE(initializer.IsValidResource());
+    ASSERT_EQ(initializer.GetActualResrouce(), 42);
+}
+
+TEST(InlineResourceInitializer, OwnedDependencies)
+{
+    int offset = 5;
+    InlineResourceInitializer initializer(
+        [offset](const Dependencies& d) -> Utilities::Result<int, int> {
+            if(d.i == 0) return Utilities::MakeError(-10);
+            return d.i + offset;
+        },
+        Dependencies{.i = 0}
+    );
+
+    initializer.InitializeResource();
+    ASSERT_FALSE(initializer.IsValidResource());
+    ASSERT_EQ(initializer.GetActualError(), -10);
+
+    initializer.SetResourceDependencies(Dependencies{.i = 1});
+    auto moved = std::move(initializer);
+    moved.InitializeResource();
+    ASSERT_EQ(moved.TakeResource(), 6);
+}
+
+TEST(InlineResourceInitializer, ReferencedDependencies)
+{
+    Dependencies deps{.i = 1};
+    InlineResourceInitializer initializer(
+        [](const Dependencies& d) -> Utilities::Result<int, int> { return d.i; },
+        std::cref(deps)
+    );
+
+    deps.i = 9;
+    initializer.InitializeResource();
+    ASSERT_EQ(&initializer.GetResourceDependencies(), &deps);
+    ASSERT_EQ(initializer.GetActualResrouce(), 9);
+}
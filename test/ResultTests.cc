@@ -20,6 +20,7 @@
  * SOFTWARE.
  */
 
+#include <memory>
 #include <string>
 #include <EagleNetwork/Result.hh>
 #include <gtest/gtest.h>
@@ -59,9 +60,87 @@ TEST_F(ResultTest, ConstructAndCheckValidResultValues)
 {
     EXPECT_TRUE(validResult.HasResult());
     EXPECT_FALSE(invalidResult.HasResult());
-    EXPECT_TRUE(invalidResult.HasResult());
+    EXPECT_TRUE(invalidResult.HasError());
 
     EXPECT_STREQ(validResult.GetResult().c_str(), "success");
 
     EXPECT_EQ(invalidResult.GetError(), -1);
 }
+
+namespace Testing
+{
+    struct NoDefault
+    {
+        explicit NoDefault(int _value) : value(_value) {}
+        int value;
+    };
+
+    Utilities::Result<void, int> Validate(int value)
+    {
+        if(value < 0) return Utilities::MakeError(value);
+        return {};
+    }
+}
+
+TEST(Result, UnionStorage)
+{
+    static_assert(sizeof(Utilities::Result<int, int>) == 2 * sizeof(int));
+    static_assert(sizeof(Utilities::Result<std::string, int>) <= sizeof(std::string) + alignof(std::string));
+    static_assert(std::is_trivially_destructible_v<Utilities::Result<int, int>>);
+}
+
+TEST(Result, NonDefaultConstructibleAndMoveOnly)
+{
+    Utilities::Result<Testing::NoDefault, int> result(Testing::NoDefault(3));
+    ASSERT_EQ(result.GetResult().value, 3);
+
+    Utilities::Result<std::unique_ptr<int>, int> owner(std::make_unique<int>(7));
+    auto moved = std::move(owner).GetResult();
+    ASSERT_EQ(*moved, 7);
+}
+
+TEST(Result, ReferenceAccessors)
+{
+    Utilities::Result<std::string, std::string> result(std::string("value"));
+    result.GetResult() += "!";
+    ASSERT_EQ(result.GetResult(), "value!");
+    ASSERT_NE(result.TryGetResult(), nullptr);
+    ASSERT_EQ(result.TryGetError(), nullptr);
+    ASSERT_THROW((void)result.GetError(), Utilities::BadErrorAccess);
+
+    Utilities::Result<std::string, std::string> failure(Utilities::MakeError(std::string("failure")));
+    ASSERT_EQ(failure.GetError(), "failure");
+    ASSERT_EQ(failure.TryGetResult(), nullptr);
+    ASSERT_EQ(failure.ValueOr("fallback"), "fallback");
+    ASSERT_THROW((void)failure.GetResult(), Utilities::BadResultAccess);
+}
+
+TEST(Result, VoidResult)
+{
+    auto valid = Testing::Validate(1);
+    ASSERT_TRUE(valid.HasResult());
+    valid.GetResult();
+
+    auto invalid = Testing::Validate(-2);
+    ASSERT_EQ(invalid.GetError(), -2);
+    ASSERT_THROW(invalid.GetResult(), Utilities::BadResultAccess);
+}
+
+TEST(Result, Monadic)
+{
+    auto length = Testing::DoOperation("valid")
+        .Transform([](const std::string& value) { return value.size(); })
+        .AndThen([](std::size_t size) -> Utilities::Result<int, int> { return static_cast<int>(size) * 2; });
+    ASSERT_EQ(length.GetResult(), 14);
+
+    auto recovered = Testing::DoOperation("invalid")
+        .AndThen([](std::string&&) -> Utilities::Result<std::string, int> { return std::string("unreachable"); })
+        .OrElse([](int error) -> Utilities::Result<std::string, int> { return std::to_string(error); });
+    ASSERT_EQ(recovered.GetResult(), "-1");
+
+    auto checked = Testing::Validate(5).Transform([] { return 5; });
+    ASSERT_EQ(checked.GetResult(), 5);
+
+    auto propagated = Testing::Validate(-3).AndThen([] { return Testing::Validate(1); });
+    ASSERT_EQ(propagated.GetError(), -3);
+}
@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/ShardedAcceptor.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <netinet/in.h>
+#include <thread>
+#include <vector>
+
+using namespace Eagle::Core;
+
+namespace {
+    sockaddr_in LoopbackAddress(std::uint16_t port)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        return address;
+    }
+}
+
+TEST(ShardedAcceptor, DistributesConnections)
+{
+    std::atomic<std::size_t> handled{0};
+    ShardedAcceptor acceptor({.workers = 2, .pinWorkers = false},
+        [&handled](std::size_t, Reactor&, BasicSocket connection) {
+            ASSERT_TRUE(connection.IsOpen());
+            handled.fetch_add(1);
+        });
+
+    auto address = LoopbackAddress(0);
+    auto started = acceptor.Start(reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ASSERT_TRUE(started.HasResult());
+    ASSERT_NE(acceptor.GetPort(), 0);
+
+    address = LoopbackAddress(acceptor.GetPort());
+    std::vector<BasicSocket> clients(8);
+    for(auto& client : clients)
+    {
+        Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0};
+        ASSERT_TRUE(client.OpenSocket(deps));
+        ASSERT_TRUE(client.Connect(reinterpret_cast<sockaddr*>(&address), sizeof(address)).HasResult());
+    }
+
+    for(int i = 0; i < 200 && handled.load() < clients.size(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(handled.load(), clients.size());
+    ASSERT_EQ(acceptor.GetAcceptedCount(0) + acceptor.GetAcceptedCount(1), clients.size());
+
+    acceptor.Stop();
+}
+
+TEST(ShardedAcceptor, RejectsBusyAddress)
+{
+    BasicSocket blocker;
+    Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0};
+    ASSERT_TRUE(blocker.OpenSocket(deps));
+    auto address = LoopbackAddress(0);
+    ASSERT_TRUE(blocker.Bind(reinterpret_cast<sockaddr*>(&address), sizeof(address)).HasResult());
+    ASSERT_TRUE(blocker.Listen().HasResult());
+
+    sockaddr_storage local{};
+    socklen_t length;
+    blocker.GetLocalAddress(local, length);
+
+    ShardedAcceptor acceptor({.workers = 1, .pinWorkers = false}, [](std::size_t, Reactor&, BasicSocket) {});
+    auto started = acceptor.Start(reinterpret_cast<sockaddr*>(&local), length);
+    ASSERT_FALSE(started.HasResult());
+    ASSERT_EQ(started.GetError(), EADDRINUSE);
+}
+
+TEST(ShardedAcceptor, ShutdownClosesWorkerConnections)
+{
+    struct Connection final : IReactorHandler
+    {
+        BasicSocket socket;
+        void OnReadable(BasicSocket&) override {}
+    };
+
+    std::vector<std::vector<std::unique_ptr<Connection>>> owned(2);
+    std::atomic<std::size_t> handled{0};
+    std::atomic<std::size_t> closed{0};
+    ShardedAcceptor acceptor({.workers = 2, .pinWorkers = false},
+        [&](std::size_t worker, Reactor& reactor, BasicSocket connection) {
+            auto registered = std::make_unique<Connection>();
+            registered->socket = std::move(connection);
+            ASSERT_TRUE(reactor.Register(registered->socket, *registered, ReactorEvent::Read));
+            owned[worker].push_back(std::move(registered));
+            handled.fetch_add(1);
+        },
+        [&](std::size_t worker, Reactor& reactor) {
+            for(auto& connection : owned[worker])
+            {
+                ASSERT_TRUE(reactor.Unregister(connection->socket));
+                closed.fetch_add(1);
+            }
+            owned[worker].clear();
+        });
+
+    auto address = LoopbackAddress(0);
+    ASSERT_TRUE(acceptor.Start(reinterpret_cast<sockaddr*>(&address), sizeof(address)).HasResult());
+    address = LoopbackAddress(acceptor.GetPort());
+    std::vector<BasicSocket> clients(4);
+    for(auto& client : clients)
+    {
+        Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0};
+        ASSERT_TRUE(client.OpenSocket(deps));
+        ASSERT_TRUE(client.Connect(reinterpret_cast<sockaddr*>(&address), sizeof(address)).HasResult());
+    }
+    for(int i = 0; i < 200 && handled.load() < clients.size(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(handled.load(), clients.size());
+
+    // Idle workers sleep in epoll, Stop wakes them through their eventfd.
+    auto stopping = std::chrono::steady_clock::now();
+    acceptor.Stop();
+    ASSERT_LT(std::chrono::steady_clock::now() - stopping, std::chrono::milliseconds(50));
+    ASSERT_EQ(closed.load(), clients.size());
+
+    std::byte buffer[1];
+    for(auto& client : clients)
+    {
+        ASSERT_EQ(client.Read(buffer).GetResult(), 0);
+    }
+}
+
+TEST(ShardedAcceptor, CpuSteeringNeedsOneWorkerPerCpu)
+{
+    auto address = LoopbackAddress(0);
+    auto cpus = std::max(1u, std::thread::hardware_concurrency());
+
+    ShardedAcceptor unpinned({.workers = cpus, .pinWorkers = false, .cpuSteering = true},
+        [](std::size_t, Reactor&, BasicSocket) {});
+    ASSERT_EQ(unpinned.Start(reinterpret_cast<sockaddr*>(&address), sizeof(address)).GetError(), EINVAL);
+
+    ShardedAcceptor extra({.workers = cpus + 1, .pinWorkers = true, .cpuSteering = true},
+        [](std::size_t, Reactor&, BasicSocket) {});
+    ASSERT_EQ(extra.Start(reinterpret_cast<sockaddr*>(&address), sizeof(address)).GetError(), EINVAL);
+}
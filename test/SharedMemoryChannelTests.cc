@@ -0,0 +1,269 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <EagleNetwork/SharedMemoryChannel.hh>
+#include <EagleNetwork/Socket.hh>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace Eagle;
+
+namespace
+{
+    std::pair<Core::BasicSocket, Core::BasicSocket> MakeControlPair()
+    {
+        auto pair = Core::BasicSocket::MakePair({.domain = AF_UNIX, .type = SOCK_STREAM, .protocol = 0});
+        EXPECT_TRUE(pair.HasResult());
+        return std::move(pair).GetResult();
+    }
+
+    std::vector<std::byte> MakePattern(std::size_t size, std::size_t seed = 0)
+    {
+        std::vector<std::byte> pattern(size);
+        for(std::size_t i = 0; i < size; ++i) pattern[i] = static_cast<std::byte>((i + seed) * 31);
+        return pattern;
+    }
+
+    void WriteAll(Core::SharedMemoryChannel& channel, std::span<const std::byte> buffer)
+    {
+        while(!buffer.empty())
+        {
+            auto written = channel.Write(buffer);
+            if(written.HasResult())
+            {
+                buffer = buffer.subspan(written.GetResult());
+            } else {
+                ASSERT_EQ(written.GetError(), EAGAIN);
+                ASSERT_TRUE(channel.WaitWritable(5000));
+            }
+        }
+    }
+
+    std::vector<std::byte> ReadToEnd(Core::SharedMemoryChannel& channel)
+    {
+        std::vector<std::byte> received;
+        std::array<std::byte, 1500> buffer;
+        while(true)
+        {
+            auto read = channel.Read(buffer);
+            if(read.HasResult())
+            {
+                if(read.GetResult() == 0) return received;
+                received.insert(received.end(), buffer.begin(), buffer.begin() + read.GetResult());
+            } else {
+                EXPECT_EQ(read.GetError(), EAGAIN);
+                if(!channel.WaitReadable(5000)) return received;
+            }
+        }
+    }
+}
+
+TEST(SharedMemoryChannel, Negotiate) {
+    auto [left, right] = MakeControlPair();
+    auto creator = Core::SharedMemoryChannel::Create(left, {.capacity = 5000});
+    ASSERT_TRUE(creator.HasResult());
+    ASSERT_EQ(creator.GetResult().GetCapacity(), 8192);
+
+    auto attacher = Core::SharedMemoryChannel::Attach(right);
+    ASSERT_TRUE(attacher.HasResult());
+    ASSERT_EQ(attacher.GetResult().GetCapacity(), 8192);
+
+    auto message = MakePattern(100);
+    ASSERT_EQ(creator.GetResult().Write(message).GetResult(), 100);
+    std::array<std::byte, 256> buffer{};
+    ASSERT_EQ(attacher.GetResult().Read(buffer).GetResult(), 100);
+    ASSERT_TRUE(std::equal(message.begin(), message.end(), buffer.begin()));
+
+    ASSERT_EQ(attacher.GetResult().Write(std::span(message).first(7)).GetResult(), 7);
+    ASSERT_EQ(creator.GetResult().Read(buffer).GetResult(), 7);
+    ASSERT_EQ(creator.GetResult().Read(buffer).GetError(), EAGAIN);
+}
+
+TEST(SharedMemoryChannel, AttachRejectsMalformedOffer) {
+    auto [left, right] = MakeControlPair();
+    right.SetNonBlocking(true);
+    ASSERT_EQ(Core::SharedMemoryChannel::Attach(right).GetError(), EAGAIN);
+
+    std::array<std::byte, 16> garbage{};
+    ASSERT_EQ(left.Write(garbage).GetResult(), garbage.size());
+    ASSERT_EQ(Core::SharedMemoryChannel::Attach(right).GetError(), EPROTO);
+}
+
+TEST(SharedMemoryChannel, FullRingWrapsAround) {
+    auto [left, right] = MakeControlPair();
+    auto creator = std::move(Core::SharedMemoryChannel::Create(left, {.capacity = 4096})).GetResult();
+    auto attacher = std::move(Core::SharedMemoryChannel::Attach(right)).GetResult();
+
+    auto first = MakePattern(3000);
+    auto second = MakePattern(3000, 7);
+    ASSERT_EQ(creator.Write(first).GetResult(), 3000);
+    ASSERT_EQ(creator.Write(second).GetResult(), 1096);
+    ASSERT_EQ(creator.Write(second).GetError(), EAGAIN);
+
+    std::vector<std::byte> buffer(3000);
+    ASSERT_EQ(attacher.Read(buffer).GetResult(), 3000);
+    ASSERT_EQ(buffer, first);
+
+    // The space freed by the read wakes the blocked writer through its eventfd.
+    ASSERT_TRUE(creator.WaitWritable(0));
+    ASSERT_EQ(creator.Write(std::span(second).subspan(1096)).GetResult(), 1904);
+    ASSERT_EQ(attacher.Read(buffer).GetResult(), 3000);
+    ASSERT_EQ(buffer, second);
+}
+
+TEST(SharedMemoryChannel, NotifierSignalsOnlyWaitingReader) {
+    auto [left, right] = MakeControlPair();
+    auto creator = std::move(Core::SharedMemoryChannel::Create(left)).GetResult();
+    auto attacher = std::move(Core::SharedMemoryChannel::Attach(right)).GetResult();
+    std::array<std::byte, 16> buffer{};
+    auto notifier = attacher.GetNotifier().GetSocketResource();
+
+    // Nobody is waiting, the write stays in user space.
+    ASSERT_EQ(creator.Write(std::span(buffer).first(4)).GetResult(), 4);
+    pollfd descriptor{notifier, POLLIN, 0};
+    ASSERT_EQ(::poll(&descriptor, 1, 0), 0);
+
+    ASSERT_EQ(attacher.Read(buffer).GetResult(), 4);
+    ASSERT_EQ(attacher.Read(buffer).GetError(), EAGAIN);
+    ASSERT_EQ(creator.Write(std::span(buffer).first(4)).GetResult(), 4);
+    ASSERT_EQ(::poll(&descriptor, 1, 0), 1);
+}
+
+TEST(SharedMemoryChannel, ShutdownAndClose) {
+    auto [left, right] = MakeControlPair();
+    auto creator = std::move(Core::SharedMemoryChannel::Create(left)).GetResult();
+    auto attacher = std::move(Core::SharedMemoryChannel::Attach(right)).GetResult();
+    std::array<std::byte, 16> buffer{};
+
+    ASSERT_EQ(creator.Write(std::span(buffer).first(5)).GetResult(), 5);
+    creator.ShutdownWrite();
+    ASSERT_EQ(creator.Write(buffer).GetError(), EPIPE);
+    ASSERT_TRUE(attacher.WaitReadable(0));
+    ASSERT_EQ(attacher.Read(buffer).GetResult(), 5);
+    ASSERT_EQ(attacher.Read(buffer).GetResult(), 0);
+
+    {
+        auto gone = std::move(creator);
+    }
+    ASSERT_EQ(attacher.Write(buffer).GetError(), EPIPE);
+}
+
+TEST(SharedMemoryChannel, CorruptedIndicesBreakChannel) {
+    // Relay the offer through the test so it keeps its own view of the rings.
+    auto [left, middle] = MakeControlPair();
+    auto [relay, right] = MakeControlPair();
+    auto creator = std::move(Core::SharedMemoryChannel::Create(left, {.capacity = 4096})).GetResult();
+
+    std::array<std::byte, 16> offer{};
+    std::array<int, 3> descriptors{};
+    std::size_t descriptorCount = 0;
+    ASSERT_EQ(middle.ReadDescriptors(offer, descriptors, descriptorCount).GetResult(), offer.size());
+    ASSERT_EQ(descriptorCount, descriptors.size());
+    ASSERT_EQ(relay.WriteDescriptors(offer, descriptors).GetResult(), offer.size());
+    auto attacher = std::move(Core::SharedMemoryChannel::Attach(right)).GetResult();
+
+    // Header layout: magic and capacity on the first cache line, then per ring
+    // the head, the tail and the flags on a cache line each.
+    auto* mapping = static_cast<std::byte*>(::mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED,
+        descriptors[0], 0));
+    ASSERT_NE(mapping, MAP_FAILED);
+    for(auto descriptor : descriptors) ::close(descriptor);
+    auto index = [mapping](std::size_t ring, std::size_t field) {
+        return reinterpret_cast<std::uint64_t*>(mapping + 64 + ring * 192 + field * 64);
+    };
+
+    std::array<std::byte, 64> buffer{};
+    ASSERT_EQ(creator.Write(std::span(buffer).first(8)).GetResult(), 8);
+    *index(0, 0) = 8 + 4096 + 1;
+    ASSERT_EQ(attacher.Read(buffer).GetError(), EPROTO);
+    *index(0, 0) = 8;
+    ASSERT_EQ(attacher.Read(buffer).GetError(), EPROTO);
+    ASSERT_TRUE(attacher.WaitReadable(0));
+
+    // A tail ahead of the head would make the free space wrap around.
+    *index(0, 1) = 100;
+    ASSERT_TRUE(creator.WaitWritable(0));
+    ASSERT_EQ(creator.Write(buffer).GetError(), EPROTO);
+    ASSERT_EQ(creator.Read(buffer).GetError(), EPROTO);
+
+    // The ring size is validated once and never read back from the header.
+    reinterpret_cast<std::uint64_t*>(mapping)[1] = std::uint64_t{1} << 30;
+    ASSERT_EQ(creator.GetCapacity(), 4096);
+    ASSERT_EQ(attacher.GetCapacity(), 4096);
+    ::munmap(mapping, 4096);
+}
+
+TEST(SharedMemoryChannel, StreamsAcrossThreads) {
+    for(std::uint32_t spins : {0u, 1000u})
+    {
+        auto [left, right] = MakeControlPair();
+        auto creator = std::move(Core::SharedMemoryChannel::Create(left, {.capacity = 4096, .busyPollSpins = spins}))
+            .GetResult();
+        auto attacher = std::move(Core::SharedMemoryChannel::Attach(right, {.busyPollSpins = spins})).GetResult();
+
+        auto payload = MakePattern(1 << 20, spins);
+        std::thread writer([&] {
+            WriteAll(creator, payload);
+            creator.ShutdownWrite();
+        });
+        auto received = ReadToEnd(attacher);
+        writer.join();
+        ASSERT_EQ(received, payload);
+    }
+}
+
+TEST(SharedMemoryChannel, EchoAcrossProcesses) {
+    auto [parentControl, childControl] = MakeControlPair();
+    auto child = ::fork();
+    ASSERT_NE(child, -1);
+    if(child == 0)
+    {
+        parentControl.CloseSocket();
+        auto channel = Core::SharedMemoryChannel::Attach(childControl);
+        if(!channel.HasResult()) ::_exit(1);
+        auto received = ReadToEnd(channel.GetResult());
+        WriteAll(channel.GetResult(), received);
+        channel.GetResult().ShutdownWrite();
+        ::_exit(0);
+    }
+
+    childControl.CloseSocket();
+    auto channel = std::move(Core::SharedMemoryChannel::Create(parentControl, {.capacity = 4096})).GetResult();
+    auto payload = MakePattern(100000);
+    WriteAll(channel, payload);
+    channel.ShutdownWrite();
+    ASSERT_EQ(ReadToEnd(channel), payload);
+
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+}
@@ -25,10 +25,211 @@
 #include "EagleNetwork/Result.hh"
 #include <gtest/gtest.h>
 #include <EagleNetwork/Socket.hh>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <memory>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <vector>
+#include <span>
 #include <sys/socket.h>
 
 using namespace Eagle;
 
 
 TEST(BasicSocket, Socket) {
+    Core::Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0};
+    Core::BasicSocket socket;
+
+    ASSERT_FALSE(socket.IsOpen());
+    ASSERT_TRUE(socket.OpenSocket(deps));
+    ASSERT_TRUE(socket.IsOpen());
+    ASSERT_FALSE(socket.OpenSocket(deps));
+
+    Core::BasicSocket moved(std::move(socket));
+    ASSERT_FALSE(socket.IsOpen());
+    ASSERT_TRUE(moved.IsOpen());
+
+    ASSERT_TRUE(moved.CloseSocket());
+    ASSERT_FALSE(moved.CloseSocket());
+}
+
+TEST(BasicSocket, InlineInitializer) {
+    Core::BasicSocket socket(Core::BasicSocket::MakeInitializer({.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0}));
+    ASSERT_TRUE(socket.IsOpen());
+
+    ASSERT_THROW(Core::BasicSocket(Core::BasicSocket::MakeInitializer({.domain = -1, .type = SOCK_STREAM, .protocol = 0})),
+        Core::BasicSocketInvalidDependencies);
+}
+
+TEST(BasicSocket, ReadWrite) {
+    int pair[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+    Core::BasicSocket first(pair[0]);
+    Core::BasicSocket second(pair[1]);
+
+    const char message[] = "eagle";
+    auto written = first.Write(std::as_bytes(std::span(message)));
+    ASSERT_TRUE(written.HasResult());
+    ASSERT_EQ(written.GetResult(), sizeof(message));
+
+    char received[sizeof(message)]{};
+    auto read = second.Read(std::as_writable_bytes(std::span(received)));
+    ASSERT_TRUE(read.HasResult());
+    ASSERT_EQ(read.GetResult(), sizeof(message));
+    ASSERT_STREQ(received, message);
+
+    ASSERT_TRUE(second.SetNonBlocking(true));
+    read = second.Read(std::as_writable_bytes(std::span(received)));
+    ASSERT_FALSE(read.HasResult());
+    ASSERT_EQ(read.GetError(), EAGAIN);
+}
+
+namespace {
+    // Connect a TCP client to a loopback listener and return both ends.
+    void MakeTcpPair(Core::BasicSocket& client, Core::BasicSocket& server)
+    {
+        Core::Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0};
+        Core::BasicSocket listener;
+        ASSERT_TRUE(listener.OpenSocket(deps));
+        ASSERT_TRUE(client.OpenSocket(deps));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        ASSERT_EQ(::bind(listener.GetSocketResource(), reinterpret_cast<sockaddr*>(&address), length), 0);
+        ASSERT_EQ(::listen(listener.GetSocketResource(), 1), 0);
+        ASSERT_EQ(::getsockname(listener.GetSocketResource(), reinterpret_cast<sockaddr*>(&address), &length), 0);
+        ASSERT_EQ(::connect(client.GetSocketResource(), reinterpret_cast<sockaddr*>(&address), length), 0);
+        server = ::accept(listener.GetSocketResource(), nullptr, nullptr);
+        ASSERT_TRUE(server.IsOpen());
+    }
+}
+
+TEST(BasicSocket, WriteZeroCopy) {
+    Core::BasicSocket client, server;
+    MakeTcpPair(client, server);
+    if(!client.EnableZeroCopy())
+    {
+        GTEST_SKIP() << "SO_ZEROCOPY unavailable";
+    }
+
+    auto payload = std::make_shared<std::vector<std::byte>>(4096, std::byte{'z'});
+    std::weak_ptr<std::vector<std::byte>> watcher = payload;
+
+    auto sent = client.WriteZeroCopy(*payload, payload);
+    ASSERT_TRUE(sent.HasResult());
+    ASSERT_EQ(client.GetPendingZeroCopyCount(), 1);
+    payload.reset();
+    ASSERT_FALSE(watcher.expired());
+
+    std::vector<std::byte> received(4096);
+    std::size_t total = 0;
+    while(total < received.size())
+    {
+        total += server.Read(std::span(received).subspan(total)).GetResult();
+    }
+
+    pollfd descriptor{client.GetSocketResource(), 0, 0};
+    ::poll(&descriptor, 1, 1000);
+    auto released = client.ProcessZeroCopyCompletions();
+    ASSERT_TRUE(released.HasResult());
+    ASSERT_EQ(released.GetResult(), 1);
+    ASSERT_EQ(client.GetPendingZeroCopyCount(), 0);
+    ASSERT_TRUE(watcher.expired());
+}
+
+TEST(BasicSocket, WriteZeroCopyRequiresEnable) {
+    Core::BasicSocket client, server;
+    MakeTcpPair(client, server);
+
+    auto payload = std::make_shared<std::vector<std::byte>>(16, std::byte{'z'});
+    std::weak_ptr<std::vector<std::byte>> watcher = payload;
+    ASSERT_EQ(client.WriteZeroCopy(*payload, payload).GetError(), EINVAL);
+    payload.reset();
+    ASSERT_TRUE(watcher.expired());
+    ASSERT_EQ(client.GetPendingZeroCopyCount(), 0);
+}
+
+TEST(BasicSocket, SendFile) {
+    Core::BasicSocket client, server;
+    MakeTcpPair(client, server);
+
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    std::fputs("file-backed data", file);
+    std::fflush(file);
+
+    off_t offset = 5;
+    auto sent = client.SendFile(::fileno(file), offset, 11);
+    std::fclose(file);
+    ASSERT_TRUE(sent.HasResult());
+    ASSERT_EQ(sent.GetResult(), 11);
+    ASSERT_EQ(offset, 16);
+
+    char received[16]{};
+    auto read = server.Read(std::as_writable_bytes(std::span(received)));
+    ASSERT_EQ(std::string(received, read.GetResult()), "backed data");
+}
+
+TEST(BasicSocket, CreationOptions)
+{
+    Core::Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0,
+        .options = {.nonBlocking = true, .closeOnExec = true, .noDelay = true, .receiveBufferSize = 1 << 16,
+            .notSentLowWatermark = 16384}};
+    Core::BasicSocket listener;
+    ASSERT_TRUE(listener.OpenSocket(deps));
+
+    auto resource = listener.GetSocketResource();
+    ASSERT_TRUE(::fcntl(resource, F_GETFL) & O_NONBLOCK);
+    ASSERT_TRUE(::fcntl(resource, F_GETFD) & FD_CLOEXEC);
+
+    auto getOption = [](int socket, int level, int name) {
+        int value = 0;
+        socklen_t length = sizeof(value);
+        ::getsockopt(socket, level, name, &value, &length);
+        return value;
+    };
+    ASSERT_EQ(getOption(resource, IPPROTO_TCP, TCP_NODELAY), 1);
+    ASSERT_EQ(getOption(resource, IPPROTO_TCP, TCP_NOTSENT_LOWAT), 16384);
+    // The kernel doubles the requested size for its bookkeeping.
+    ASSERT_GE(getOption(resource, SOL_SOCKET, SO_RCVBUF), 1 << 16);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_TRUE(listener.Bind(reinterpret_cast<sockaddr*>(&address), sizeof(address)).HasResult());
+    ASSERT_TRUE(listener.Listen().HasResult());
+    sockaddr_storage local{};
+    socklen_t length;
+    listener.GetLocalAddress(local, length);
+
+    Core::BasicSocket client(Core::BasicSocket::MakeInitializer(
+        {.domain = AF_INET, .type = SOCK_STREAM, .protocol = 0, .options = {.closeOnExec = true, .noDelay = true}}));
+    ASSERT_TRUE(::fcntl(client.GetSocketResource(), F_GETFD) & FD_CLOEXEC);
+    ASSERT_TRUE(client.Connect(reinterpret_cast<sockaddr*>(&local), length).HasResult());
+
+    auto accepted = listener.Accept();
+    ASSERT_TRUE(accepted.HasResult());
+    auto connection = accepted.GetResult().GetSocketResource();
+    ASSERT_EQ(getOption(connection, IPPROTO_TCP, TCP_NODELAY), 1);
+    ASSERT_TRUE(::fcntl(connection, F_GETFD) & FD_CLOEXEC);
+}
+
+TEST(BasicSocket, CreationOptionFailureClosesResource)
+{
+    // TCP options don't apply to datagram sockets.
+    Core::Detail::SocketResourceDependencies deps{.domain = AF_INET, .type = SOCK_DGRAM, .protocol = 0,
+        .options = {.noDelay = true}};
+    auto opened = Core::BasicSocket::OpenResource(deps);
+    ASSERT_FALSE(opened.HasResult());
+    ASSERT_NE(opened.GetError(), 0);
+
+    Core::BasicSocket socket;
+    ASSERT_FALSE(socket.OpenSocket(deps));
+    ASSERT_FALSE(socket.IsOpen());
 }
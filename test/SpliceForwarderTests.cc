@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/SpliceForwarder.hh>
+#include <EagleNetwork/Socket.hh>
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <span>
+#include <string>
+#include <sys/socket.h>
+
+using namespace Eagle::Core;
+
+namespace {
+    void MakePair(BasicSocket& first, BasicSocket& second)
+    {
+        int pair[2];
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+        first = pair[0];
+        second = pair[1];
+        first.SetNonBlocking(true);
+        second.SetNonBlocking(true);
+    }
+}
+
+TEST(SpliceForwarder, ForwardsBetweenSockets)
+{
+    BasicSocket client, upstreamIn, upstreamOut, server;
+    MakePair(client, upstreamIn);
+    MakePair(upstreamOut, server);
+
+    SpliceForwarder forwarder;
+    auto nothing = forwarder.Forward(upstreamIn, upstreamOut, 1024);
+    ASSERT_FALSE(nothing.HasResult());
+    ASSERT_EQ(nothing.GetError(), EAGAIN);
+
+    const std::string message = "proxied payload";
+    client.Write(std::as_bytes(std::span(message)));
+
+    auto forwarded = forwarder.Forward(upstreamIn, upstreamOut, 1024);
+    ASSERT_TRUE(forwarded.HasResult());
+    ASSERT_EQ(forwarded.GetResult(), message.size());
+    ASSERT_EQ(forwarder.GetBufferedCount(), 0);
+
+    char received[64]{};
+    auto read = server.Read(std::as_writable_bytes(std::span(received)));
+    ASSERT_EQ(std::string(received, read.GetResult()), message);
+
+    client.CloseSocket();
+    forwarded = forwarder.Forward(upstreamIn, upstreamOut, 1024);
+    ASSERT_EQ(forwarded.GetResult(), 0);
+    ASSERT_TRUE(forwarder.IsSourceClosed());
+}
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <EagleNetwork/TimerWheel.hh>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Eagle::Core;
+using namespace std::chrono_literals;
+
+namespace {
+    const TimerWheel::Clock::time_point Origin{};
+
+    struct RecordingHandler : ITimerHandler
+    {
+        std::vector<Timer*> expired;
+
+        void OnTimerExpired(Timer& timer) override
+        {
+            expired.push_back(&timer);
+        }
+    };
+
+    struct PeriodicHandler : ITimerHandler
+    {
+        TimerWheel* wheel{nullptr};
+        int count{0};
+
+        void OnTimerExpired(Timer& timer) override
+        {
+            ++count;
+            wheel->Arm(timer, 10ms);
+        }
+    };
+}
+
+TEST(TimerWheel, ExpiresAtDeadline)
+{
+    TimerWheel wheel(1ms, Origin);
+    RecordingHandler handler;
+    Timer timer(handler);
+
+    ASSERT_EQ(wheel.GetNextTimeout(Origin), -1);
+    wheel.Arm(timer, 5ms);
+    ASSERT_TRUE(timer.IsArmed());
+    ASSERT_EQ(wheel.GetArmedCount(), 1);
+    ASSERT_GT(wheel.GetNextTimeout(Origin), 0);
+    ASSERT_LE(wheel.GetNextTimeout(Origin), 5);
+
+    ASSERT_EQ(wheel.Advance(Origin + 4ms), 0);
+    ASSERT_EQ(wheel.Advance(Origin + 5ms), 1);
+    ASSERT_EQ(handler.expired.size(), 1);
+    ASSERT_FALSE(timer.IsArmed());
+    ASSERT_EQ(wheel.GetArmedCount(), 0);
+}
+
+TEST(TimerWheel, CancelAndDestroy)
+{
+    TimerWheel wheel(1ms, Origin);
+    RecordingHandler handler;
+    Timer timer(handler);
+
+    wheel.Arm(timer, 5ms);
+    wheel.Cancel(timer);
+    ASSERT_FALSE(timer.IsArmed());
+    {
+        Timer scoped(handler);
+        wheel.Arm(scoped, 5ms);
+        ASSERT_EQ(wheel.GetArmedCount(), 1);
+    }
+    ASSERT_EQ(wheel.GetArmedCount(), 0);
+    ASSERT_EQ(wheel.Advance(Origin + 10ms), 0);
+    ASSERT_TRUE(handler.expired.empty());
+}
+
+TEST(TimerWheel, Rearm)
+{
+    TimerWheel wheel(1ms, Origin);
+    RecordingHandler handler;
+    Timer idle(handler);
+    Timer shortened(handler);
+
+    // Idle timeout refreshed on activity moves its deadline back.
+    wheel.Arm(idle, 10ms);
+    wheel.Advance(Origin + 5ms);
+    wheel.Arm(idle, 10ms);
+    ASSERT_EQ(wheel.Advance(Origin + 10ms), 0);
+    ASSERT_EQ(wheel.Advance(Origin + 15ms), 1);
+
+    wheel.Arm(shortened, 1000ms);
+    wheel.Arm(shortened, 2ms);
+    ASSERT_EQ(wheel.Advance(Origin + 17ms), 1);
+    ASSERT_EQ(handler.expired.back(), &shortened);
+}
+
+TEST(TimerWheel, HandlerRearms)
+{
+    TimerWheel wheel(1ms, Origin);
+    PeriodicHandler handler;
+    handler.wheel = &wheel;
+    Timer timer(handler);
+
+    wheel.Arm(timer, 10ms);
+    for(int i = 1; i <= 100; ++i)
+    {
+        wheel.Advance(Origin + std::chrono::milliseconds(i));
+    }
+    ASSERT_EQ(handler.count, 10);
+    ASSERT_TRUE(timer.IsArmed());
+}
+
+namespace {
+    struct DeadlineHandler : ITimerHandler
+    {
+        std::int64_t deadline{0};
+        std::int64_t firedAt{-1};
+        const std::int64_t* now{nullptr};
+        const std::int64_t* previous{nullptr};
+
+        void OnTimerExpired(Timer&) override
+        {
+            // Fired by the first Advance reaching its deadline.
+            EXPECT_GE(*now, deadline);
+            EXPECT_LT(*previous, deadline);
+            firedAt = *now;
+        }
+    };
+
+    void CheckRandomDeadlines(std::int64_t maxTimeout, std::int64_t maxStep)
+    {
+        TimerWheel wheel(1ms, Origin);
+        std::mt19937_64 random(42);
+        std::uniform_int_distribution<std::int64_t> timeouts(1, maxTimeout);
+        std::uniform_int_distribution<std::int64_t> steps(1, maxStep);
+
+        std::int64_t now = 0;
+        std::int64_t previous = 0;
+        std::vector<std::unique_ptr<DeadlineHandler>> handlers;
+        std::vector<std::unique_ptr<Timer>> timers;
+        for(int i = 0; i < 2000; ++i)
+        {
+            auto handler = std::make_unique<DeadlineHandler>();
+            handler->deadline = timeouts(random);
+            handler->now = &now;
+            handler->previous = &previous;
+            timers.push_back(std::make_unique<Timer>(*handler));
+            wheel.Arm(*timers.back(), std::chrono::milliseconds(handler->deadline));
+            handlers.push_back(std::move(handler));
+        }
+
+        while(wheel.GetArmedCount() > 0)
+        {
+            previous = now;
+            now += steps(random);
+            wheel.Advance(Origin + std::chrono::milliseconds(now));
+        }
+
+        for(auto& handler : handlers)
+        {
+            ASSERT_GE(handler->firedAt, handler->deadline);
+        }
+    }
+}
+
+TEST(TimerWheel, CascadesLongTimeouts)
+{
+    CheckRandomDeadlines(2'000'000, 40);
+    CheckRandomDeadlines(100'000'000, 200'000);
+}
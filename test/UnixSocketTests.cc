@@ -0,0 +1,227 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <EagleNetwork/Socket.hh>
+#include <EagleNetwork/UnixAddress.hh>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Eagle;
+
+namespace
+{
+    std::span<const std::byte> AsBytes(std::string_view text)
+    {
+        return std::as_bytes(std::span(text.data(), text.size()));
+    }
+
+    std::string_view AsText(std::span<const std::byte> bytes)
+    {
+        return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    }
+
+    Core::BasicSocket OpenUnixSocket(int type)
+    {
+        Core::Detail::SocketResourceDependencies deps{.domain = AF_UNIX, .type = type, .protocol = 0};
+        Core::BasicSocket socket;
+        EXPECT_TRUE(socket.OpenSocket(deps));
+        return socket;
+    }
+}
+
+TEST(UnixAddress, Path) {
+    auto address = Core::UnixAddress::FromPath("/tmp/eagle.sock");
+    ASSERT_TRUE(address.HasResult());
+    ASSERT_FALSE(address.GetResult().IsAbstract());
+    ASSERT_EQ(address.GetResult().GetName(), "/tmp/eagle.sock");
+
+    ASSERT_EQ(Core::UnixAddress::FromPath("").GetError(), EINVAL);
+    ASSERT_EQ(Core::UnixAddress::FromPath(std::string(sizeof(sockaddr_un::sun_path), 'a')).GetError(), ENAMETOOLONG);
+}
+
+TEST(UnixAddress, Abstract) {
+    auto address = Core::UnixAddress::FromAbstractName(std::string_view("eagle\0net", 9));
+    ASSERT_TRUE(address.HasResult());
+    ASSERT_TRUE(address.GetResult().IsAbstract());
+    ASSERT_EQ(address.GetResult().GetName(), std::string_view("eagle\0net", 9));
+    ASSERT_EQ(Core::UnixAddress::FromAbstractName(std::string(sizeof(sockaddr_un::sun_path), 'a')).GetError(),
+        ENAMETOOLONG);
+}
+
+TEST(UnixSocket, PathStream) {
+    char directory[] = "/tmp/eagle-unix-XXXXXX";
+    ASSERT_NE(::mkdtemp(directory), nullptr);
+    std::string path = std::string(directory) + "/stream.sock";
+    auto address = Core::UnixAddress::FromPath(path).GetResult();
+
+    auto listener = OpenUnixSocket(SOCK_STREAM);
+    ASSERT_TRUE(listener.Bind(address.GetAddress(), address.GetLength()).HasResult());
+    ASSERT_TRUE(listener.Listen().HasResult());
+
+    auto client = OpenUnixSocket(SOCK_STREAM);
+    ASSERT_TRUE(client.Connect(address.GetAddress(), address.GetLength()).HasResult());
+    auto accepted = listener.Accept(false);
+    ASSERT_TRUE(accepted.HasResult());
+    auto server = std::move(accepted).GetResult();
+
+    ASSERT_EQ(client.Write(AsBytes("ping")).GetResult(), 4);
+    std::array<std::byte, 16> buffer{};
+    auto read = server.Read(buffer);
+    ASSERT_EQ(AsText(std::span(buffer).first(read.GetResult())), "ping");
+
+    ::unlink(path.c_str());
+    ::rmdir(directory);
+}
+
+TEST(UnixSocket, AbstractSeqPacketKeepsBoundaries) {
+    auto name = "eagle-test-" + std::to_string(::getpid());
+    auto address = Core::UnixAddress::FromAbstractName(name).GetResult();
+
+    auto listener = OpenUnixSocket(SOCK_SEQPACKET);
+    ASSERT_TRUE(listener.Bind(address.GetAddress(), address.GetLength()).HasResult());
+    ASSERT_TRUE(listener.Listen().HasResult());
+
+    auto client = OpenUnixSocket(SOCK_SEQPACKET);
+    ASSERT_TRUE(client.Connect(address.GetAddress(), address.GetLength()).HasResult());
+    auto server = std::move(listener.Accept(false)).GetResult();
+
+    ASSERT_EQ(client.Write(AsBytes("first")).GetResult(), 5);
+    ASSERT_EQ(client.Write(AsBytes("second")).GetResult(), 6);
+
+    std::array<std::byte, 64> buffer{};
+    ASSERT_EQ(AsText(std::span(buffer).first(server.Read(buffer).GetResult())), "first");
+    ASSERT_EQ(AsText(std::span(buffer).first(server.Read(buffer).GetResult())), "second");
+}
+
+TEST(UnixSocket, MakePair) {
+    auto pair = Core::BasicSocket::MakePair({.domain = AF_UNIX, .type = SOCK_SEQPACKET, .protocol = 0,
+        .options = {.nonBlocking = true, .closeOnExec = true}});
+    ASSERT_TRUE(pair.HasResult());
+    auto& [first, second] = pair.GetResult();
+    ASSERT_TRUE(::fcntl(first.GetSocketResource(), F_GETFL) & O_NONBLOCK);
+    ASSERT_TRUE(::fcntl(second.GetSocketResource(), F_GETFD) & FD_CLOEXEC);
+
+    std::array<std::byte, 8> buffer{};
+    ASSERT_EQ(second.Read(buffer).GetError(), EAGAIN);
+    ASSERT_EQ(first.Write(AsBytes("x")).GetResult(), 1);
+    ASSERT_EQ(second.Read(buffer).GetResult(), 1);
+}
+
+TEST(UnixSocket, PassDescriptors) {
+    auto pair = Core::BasicSocket::MakePair({.domain = AF_UNIX, .type = SOCK_STREAM, .protocol = 0});
+    ASSERT_TRUE(pair.HasResult());
+    auto& [sender, receiver] = pair.GetResult();
+
+    int pipe[2];
+    ASSERT_EQ(::pipe(pipe), 0);
+    auto extra = Core::BasicSocket::MakePair({.domain = AF_UNIX, .type = SOCK_DGRAM, .protocol = 0});
+    ASSERT_TRUE(extra.HasResult());
+
+    std::array<int, 2> sent{pipe[1], extra.GetResult().first.GetSocketResource()};
+    ASSERT_EQ(sender.WriteDescriptors(AsBytes("fds"), sent).GetResult(), 3);
+    ::close(pipe[1]);
+
+    std::array<std::byte, 8> buffer{};
+    std::array<int, 2> received{-1, -1};
+    std::size_t count = 0;
+    ASSERT_EQ(receiver.ReadDescriptors(buffer, received, count).GetResult(), 3);
+    ASSERT_EQ(count, 2);
+    ASSERT_TRUE(::fcntl(received[0], F_GETFD) & FD_CLOEXEC);
+
+    // The duplicated pipe end and socket both still reach their peers.
+    ASSERT_EQ(::write(received[0], "p", 1), 1);
+    char byte = 0;
+    ASSERT_EQ(::read(pipe[0], &byte, 1), 1);
+    ASSERT_EQ(byte, 'p');
+
+    ASSERT_EQ(::send(received[1], "s", 1, 0), 1);
+    ASSERT_EQ(extra.GetResult().second.Read(std::span(buffer).first(1)).GetResult(), 1);
+
+    ::close(received[0]);
+    ::close(received[1]);
+    ::close(pipe[0]);
+}
+
+TEST(UnixSocket, ExcessDescriptorsAreClosed) {
+    auto pair = Core::BasicSocket::MakePair({.domain = AF_UNIX, .type = SOCK_STREAM, .protocol = 0});
+    auto& [sender, receiver] = pair.GetResult();
+
+    int pipe[2];
+    ASSERT_EQ(::pipe(pipe), 0);
+    std::array<int, 2> sent{pipe[0], pipe[1]};
+    ASSERT_EQ(sender.WriteDescriptors(AsBytes("x"), sent).GetResult(), 1);
+    ::close(pipe[1]);
+
+    std::array<std::byte, 1> buffer{};
+    std::array<int, 1> received{-1};
+    std::size_t count = 0;
+    ASSERT_EQ(receiver.ReadDescriptors(buffer, received, count).GetResult(), 1);
+    ASSERT_EQ(count, 1);
+
+    // Every write end is gone, so the received read end sees end of file.
+    char byte;
+    ASSERT_EQ(::read(received[0], &byte, 1), 0);
+    ::close(received[0]);
+    ::close(pipe[0]);
+}
+
+TEST(UnixSocket, TruncatedDescriptorsAreReported) {
+    auto pair = Core::BasicSocket::MakePair({.domain = AF_UNIX, .type = SOCK_STREAM, .protocol = 0});
+    auto& [sender, receiver] = pair.GetResult();
+
+    // The credentials take control space, so the largest descriptor set no longer fits.
+    ASSERT_TRUE(receiver.SetOption(SOL_SOCKET, SO_PASSCRED, 1));
+    int pipe[2];
+    ASSERT_EQ(::pipe(pipe), 0);
+    std::vector<int> sent(Core::BasicSocket::MaxPassedDescriptors, pipe[1]);
+    ASSERT_EQ(sender.WriteDescriptors(AsBytes("x"), sent).GetResult(), 1);
+    ::close(pipe[1]);
+
+    std::array<std::byte, 1> buffer{};
+    std::vector<int> received(Core::BasicSocket::MaxPassedDescriptors, -1);
+    std::size_t count = 1;
+    ASSERT_EQ(receiver.ReadDescriptors(buffer, received, count).GetError(), EMSGSIZE);
+    ASSERT_EQ(count, 0);
+
+    // No copy of the write end survived.
+    char byte;
+    ASSERT_EQ(::read(pipe[0], &byte, 1), 0);
+    ::close(pipe[0]);
+}
+
+TEST(UnixSocket, RejectsInvalidDescriptorMessages) {
+    auto pair = Core::BasicSocket::MakePair({.domain = AF_UNIX, .type = SOCK_STREAM, .protocol = 0});
+    auto& [sender, receiver] = pair.GetResult();
+
+    std::array<int, 1> descriptors{0};
+    ASSERT_EQ(sender.WriteDescriptors({}, descriptors).GetError(), EINVAL);
+    std::vector<int> tooMany(Core::BasicSocket::MaxPassedDescriptors + 1, 0);
+    ASSERT_EQ(sender.WriteDescriptors(AsBytes("x"), tooMany).GetError(), EINVAL);
+}
@@ -0,0 +1,365 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ToolSupport.hh"
+#include <EagleNetwork/Datagram.hh>
+#include <EagleNetwork/OutboundQueue.hh>
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/ShardedAcceptor.hh>
+#include <EagleNetwork/Socket.hh>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace Eagle;
+using namespace Eagle::Core;
+
+namespace
+{
+    constexpr std::size_t ReadChunkSize = 16 * 1024;
+
+    /**
+     * Datagrams moved per recvmmsg/sendmmsg.
+     */
+    constexpr std::size_t DatagramBatchSize = 16;
+    constexpr std::size_t MaximumDatagramSize = 64 * 1024;
+
+    std::atomic<bool> stopRequested{false};
+
+    void RequestStop(int)
+    {
+        stopRequested.store(true, std::memory_order_relaxed);
+    }
+
+    class EchoConnection;
+
+    /**
+     * The connections of one reactor, only touched from its thread.
+     */
+    using ConnectionSet = std::unordered_map<EchoConnection*, std::unique_ptr<EchoConnection>>;
+
+    /**
+     * Echoes a stream connection through an OutboundQueue, pausing reads while
+     * the peer doesn't keep up with its own echo.
+     */
+    class EchoConnection final : private IReactorHandler, private IOutboundQueueHandler, private IReactorDeferred
+    {
+    public:
+        static void Start(ConnectionSet& connections, Reactor& reactor, BasicSocket socket)
+        {
+            socket.SetNonBlocking(true);
+            auto connection = std::unique_ptr<EchoConnection>(new EchoConnection(connections, reactor,
+                std::move(socket)));
+            if(!reactor.Register(connection->socket, *connection, ReactorEvent::Read | ReactorEvent::Write)) return;
+            connections.emplace(connection.get(), std::move(connection));
+        }
+
+        /**
+         * Closes every connection of the set, they are erased by the reactor's deferred work.
+         */
+        static void CloseAll(ConnectionSet& connections)
+        {
+            for(auto& [connection, owned] : connections) connection->Close();
+        }
+
+    private:
+        EchoConnection(ConnectionSet& connections, Reactor& reactor, BasicSocket&& socket)
+            : connections(connections), reactor(reactor), socket(std::move(socket)),
+              queue(reactor, this->socket, this, {.highWatermark = 256 * 1024, .lowWatermark = 64 * 1024})
+        {
+        }
+
+        void OnReadable(BasicSocket&) override
+        {
+            std::byte buffer[ReadChunkSize];
+            while(!paused && !closed)
+            {
+                auto read = socket.Read(buffer);
+                if(read.HasError())
+                {
+                    if(read.GetError() != EAGAIN && read.GetError() != EWOULDBLOCK) Close();
+                    return;
+                }
+                if(read.GetResult() == 0)
+                {
+                    Close();
+                    return;
+                }
+                queue.Enqueue(std::span(buffer).first(read.GetResult()));
+            }
+        }
+
+        void OnWritable(BasicSocket&) override
+        {
+            queue.OnWritable();
+        }
+
+        void OnError(BasicSocket&, Detail::SocketPlatformErrorType::Type) override
+        {
+            Close();
+        }
+
+        void OnHighWatermark(OutboundQueue&) override
+        {
+            paused = true;
+        }
+
+        void OnLowWatermark(OutboundQueue&) override
+        {
+            // Edge-triggered readiness won't repeat, catch up on what arrived while paused.
+            paused = false;
+            OnReadable(socket);
+        }
+
+        void OnWriteError(OutboundQueue&, Detail::SocketPlatformErrorType::Type) override
+        {
+            Close();
+        }
+
+        void Close()
+        {
+            if(closed) return;
+            closed = true;
+            reactor.Unregister(socket);
+            reactor.Defer(*this);
+        }
+
+        void OnDeferred(Reactor&) override
+        {
+            connections.erase(this);
+        }
+
+        ConnectionSet& connections;
+        Reactor& reactor;
+        BasicSocket socket;
+        OutboundQueue queue;
+        bool paused{false};
+        bool closed{false};
+    };
+
+    /**
+     * Accepts Unix stream connections into the main reactor.
+     */
+    struct StreamListener final : IReactorHandler
+    {
+        ConnectionSet* connections;
+        Reactor* reactor;
+        BasicSocket socket;
+
+        void OnReadable(BasicSocket&) override
+        {
+            while(true)
+            {
+                auto connection = socket.Accept();
+                if(connection.HasError())
+                {
+                    if(connection.GetError() == ECONNABORTED) continue;
+                    return;
+                }
+                EchoConnection::Start(*connections, *reactor, std::move(connection).GetResult());
+            }
+        }
+    };
+
+    /**
+     * Sends every datagram back to where it came from, a batch per recvmmsg and sendmmsg.
+     */
+    class DatagramEcho final : public IReactorHandler
+    {
+    public:
+        using Buffer = std::byte[MaximumDatagramSize];
+
+        explicit DatagramEcho(BasicSocket&& socket)
+            : socket(std::move(socket)), batch(DatagramBatchSize), inputs(DatagramBatchSize),
+              outputs(DatagramBatchSize)
+        {
+        }
+
+        BasicSocket& GetSocket()
+        {
+            return socket;
+        }
+
+    private:
+        void OnReadable(BasicSocket&) override
+        {
+            Detail::IO::IOSocketMultiOperationDep<Detail::IO::InputSocketOperationDep, Buffer> receive{
+                socket.GetSocketResource(), inputs, MaximumDatagramSize};
+            Detail::IO::IOSocketMultiOperationDep<Detail::IO::OutputSocketOperationDep, Buffer> reply{
+                socket.GetSocketResource(), outputs, MaximumDatagramSize};
+            while(true)
+            {
+                auto received = batch.Receive(receive);
+                if(received.HasError()) return;
+                for(std::size_t i = 0; i < received.GetResult(); ++i)
+                {
+                    outputs[i].outputNumberBytes = inputs[i].inputNumberBytes;
+                    std::memcpy(outputs[i].buffer, inputs[i].buffer, inputs[i].inputNumberBytes);
+                }
+                // Like a router, drop what the socket buffer can't take rather than wait.
+                batch.Reply(reply);
+            }
+        }
+
+        BasicSocket socket;
+        DatagramBatch batch;
+        std::vector<Detail::IO::InputSocketOperationDep<Buffer>> inputs;
+        std::vector<Detail::IO::OutputSocketOperationDep<Buffer>> outputs;
+    };
+
+    int Usage(const std::string& error)
+    {
+        if(!error.empty()) std::fprintf(stderr, "eagle-echo: %s\n", error.c_str());
+        std::fprintf(stderr,
+            "usage: eagle-echo [--tcp [HOST:]PORT] [--udp [HOST:]PORT] [--unix PATH] [--abstract NAME]\n"
+            "                  [--workers N] [--pin]\n"
+            "  Echo every byte received on each endpoint until SIGINT or SIGTERM.\n"
+            "  --workers  TCP worker threads sharing the port with SO_REUSEPORT (default 1)\n"
+            "  --pin      pin TCP workers to CPUs\n");
+        return 2;
+    }
+
+    BasicSocket OpenListener(const Tools::Endpoint& endpoint, const char*& failure)
+    {
+        BasicSocket socket;
+        Detail::SocketResourceDependencies deps{.domain = endpoint.domain, .type = endpoint.type, .protocol = 0,
+            .options = {.nonBlocking = true, .closeOnExec = true}};
+        if(!socket.OpenSocket(deps))
+        {
+            failure = "socket";
+        } else if(!socket.Bind(endpoint.GetAddress(), endpoint.length).HasResult()) {
+            failure = "bind";
+        } else if(endpoint.type == SOCK_STREAM && !socket.Listen().HasResult()) {
+            failure = "listen";
+        }
+        return socket;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Tools::Arguments arguments(argc, argv, {"pin", "help"}, {"tcp", "udp", "unix", "abstract", "workers"});
+    auto workerCount = arguments.GetNumber<std::size_t>("workers", 1);
+    if(!arguments.error.empty() || arguments.Has("help")) return Usage(arguments.error);
+
+    std::vector<std::pair<Tools::Endpoint, std::string>> endpoints;
+    for(const auto& [name, value] : arguments.GetValues())
+    {
+        if(!Tools::IsEndpointKind(name)) continue;
+        auto endpoint = Tools::ParseEndpoint(name, value, "0.0.0.0");
+        if(!endpoint) return Usage("invalid --" + name + " " + value);
+        endpoints.emplace_back(*endpoint, name + " " + value);
+    }
+    if(endpoints.empty()) return Usage("no endpoint to listen on");
+
+    std::signal(SIGINT, RequestStop);
+    std::signal(SIGTERM, RequestStop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Reactor reactor;
+    ConnectionSet connections;
+    std::vector<std::unique_ptr<StreamListener>> listeners;
+    std::vector<std::unique_ptr<DatagramEcho>> datagrams;
+    std::vector<std::unique_ptr<ShardedAcceptor>> acceptors;
+    std::vector<std::unique_ptr<std::vector<ConnectionSet>>> workerConnections;
+
+    for(const auto& [endpoint, description] : endpoints)
+    {
+        if(endpoint.kind == "tcp")
+        {
+            auto sets = std::make_unique<std::vector<ConnectionSet>>();
+            auto acceptor = std::make_unique<ShardedAcceptor>(
+                ShardedAcceptorOptions{.workers = workerCount, .pinWorkers = arguments.Has("pin"),
+                    .socketOptions = {.noDelay = true}},
+                [sets = sets.get()](std::size_t worker, Reactor& workerReactor, BasicSocket connection) {
+                    EchoConnection::Start((*sets)[worker], workerReactor, std::move(connection));
+                },
+                [sets = sets.get()](std::size_t worker, Reactor&) {
+                    EchoConnection::CloseAll((*sets)[worker]);
+                });
+            sets->resize(acceptor->GetWorkerCount());
+            if(auto started = acceptor->Start(endpoint.GetAddress(), endpoint.length); started.HasError())
+            {
+                std::fprintf(stderr, "eagle-echo: %s: %s\n", description.c_str(), std::strerror(started.GetError()));
+                return 1;
+            }
+            std::printf("eagle-echo: %s, %zu workers, port %u\n", description.c_str(), acceptor->GetWorkerCount(),
+                acceptor->GetPort());
+            acceptors.push_back(std::move(acceptor));
+            workerConnections.push_back(std::move(sets));
+            continue;
+        }
+
+        const char* failure = nullptr;
+        auto socket = OpenListener(endpoint, failure);
+        if(failure)
+        {
+            std::fprintf(stderr, "eagle-echo: %s: %s: %s\n", description.c_str(), failure, std::strerror(errno));
+            return 1;
+        }
+
+        bool registered;
+        if(endpoint.type == SOCK_DGRAM)
+        {
+            auto echo = std::make_unique<DatagramEcho>(std::move(socket));
+            registered = reactor.Register(echo->GetSocket(), *echo, ReactorEvent::Read);
+            datagrams.push_back(std::move(echo));
+        } else {
+            auto listener = std::make_unique<StreamListener>();
+            listener->connections = &connections;
+            listener->reactor = &reactor;
+            listener->socket = std::move(socket);
+            registered = reactor.Register(listener->socket, *listener, ReactorEvent::Read);
+            listeners.push_back(std::move(listener));
+        }
+        if(!registered)
+        {
+            std::fprintf(stderr, "eagle-echo: %s: can't register in the reactor\n", description.c_str());
+            return 1;
+        }
+        std::printf("eagle-echo: %s\n", description.c_str());
+    }
+    std::fflush(stdout);
+
+    while(!stopRequested.load(std::memory_order_relaxed))
+    {
+        reactor.RunOnce(100);
+    }
+
+    // Each worker closes its connections on its own thread before its reactor goes.
+    for(auto& acceptor : acceptors) acceptor->Stop();
+    workerConnections.clear();
+
+    for(const auto& [endpoint, description] : endpoints)
+    {
+        if(endpoint.kind == "unix")
+        {
+            ::unlink(reinterpret_cast<const sockaddr_un*>(&endpoint.address)->sun_path);
+        }
+    }
+    return 0;
+}
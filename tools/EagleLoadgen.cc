@@ -0,0 +1,463 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ToolSupport.hh"
+#include <EagleNetwork/LatencyHistogram.hh>
+#include <EagleNetwork/OutboundQueue.hh>
+#include <EagleNetwork/Reactor.hh>
+#include <EagleNetwork/Socket.hh>
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Eagle;
+using namespace Eagle::Core;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Bytes at the start of each message carrying the time it was meant to be sent.
+     */
+    constexpr std::size_t TimestampSize = sizeof(std::int64_t);
+
+    /**
+     * Time without any echo after which in-flight datagrams are counted as lost.
+     */
+    constexpr auto DatagramLossTimeout = std::chrono::seconds(1);
+
+    std::atomic<bool> stopRequested{false};
+
+    void RequestStop(int)
+    {
+        stopRequested.store(true, std::memory_order_relaxed);
+    }
+
+    struct LoadOptions
+    {
+        Tools::Endpoint endpoint;
+        std::size_t connections{1};
+        std::size_t messageSize{64};
+        std::size_t pipeline{1};
+        std::size_t threads{1};
+        double rate{0};
+        std::chrono::nanoseconds duration{std::chrono::seconds(10)};
+    };
+
+    struct LoadStatistics
+    {
+        std::uint64_t sent{0};
+        std::uint64_t received{0};
+        std::uint64_t lost{0};
+        std::uint64_t errors{0};
+        LatencyHistogram latency;
+
+        void Merge(const LoadStatistics& other)
+        {
+            sent += other.sent;
+            received += other.received;
+            lost += other.lost;
+            errors += other.errors;
+            latency.Merge(other.latency);
+        }
+    };
+
+    /**
+     * One connection of the generator. Closed loop keeps the pipeline full and
+     * sends the next message as soon as an echo returns. Open loop sends on a
+     * fixed schedule and stamps each message with its scheduled time rather
+     * than the time it left, so a stalled server is charged for the whole
+     * backlog it causes instead of hiding it (coordinated omission).
+     */
+    class LoadConnection final : private IReactorHandler
+    {
+    public:
+        LoadConnection(const LoadOptions& options, LoadStatistics& statistics, Reactor& reactor, BasicSocket&& socket,
+            Clock::time_point start, std::chrono::nanoseconds interval)
+            : options(options), statistics(statistics), reactor(reactor), socket(std::move(socket)),
+              queue(reactor, this->socket), message(options.messageSize, std::byte{0x5a}),
+              interval(interval), nextSend(start), lastProgress(start)
+        {
+        }
+
+        bool Start()
+        {
+            return reactor.Register(socket, *this, ReactorEvent::Read | ReactorEvent::Write);
+        }
+
+        /**
+         * @brief Send what is due by now.
+         *
+         * @return When the next send is due, time_point::max() for closed loop.
+         */
+        Clock::time_point Pump(Clock::time_point now, bool sending)
+        {
+            if(closed) return Clock::time_point::max();
+            if(IsDatagram() && inFlight > 0 && now - lastProgress > DatagramLossTimeout)
+            {
+                statistics.lost += inFlight;
+                inFlight = 0;
+                lastProgress = now;
+            }
+            if(!sending) return Clock::time_point::max();
+
+            if(interval.count() == 0)
+            {
+                while(inFlight < options.pipeline && Send(now)) {}
+                return Clock::time_point::max();
+            }
+            while(nextSend <= now && inFlight < options.pipeline)
+            {
+                if(!Send(nextSend)) break;
+                nextSend += interval;
+            }
+            return nextSend;
+        }
+
+        bool IsIdle() const
+        {
+            return closed || inFlight == 0;
+        }
+
+        void Close()
+        {
+            if(closed) return;
+            closed = true;
+            reactor.Unregister(socket);
+        }
+
+    private:
+        bool IsDatagram() const
+        {
+            return options.endpoint.type == SOCK_DGRAM;
+        }
+
+        bool Send(Clock::time_point intended)
+        {
+            auto stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(intended.time_since_epoch()).count();
+            std::memcpy(message.data(), &stamp, TimestampSize);
+            if(IsDatagram())
+            {
+                auto written = socket.Write(message);
+                if(written.HasError())
+                {
+                    if(written.GetError() != EAGAIN && written.GetError() != EWOULDBLOCK) ++statistics.errors;
+                    return false;
+                }
+            } else {
+                queue.Enqueue(message);
+            }
+            ++statistics.sent;
+            ++inFlight;
+            return true;
+        }
+
+        void Complete(Clock::time_point now)
+        {
+            std::int64_t stamp;
+            std::memcpy(&stamp, header, TimestampSize);
+            statistics.latency.Record(now - Clock::time_point(std::chrono::nanoseconds(stamp)));
+            ++statistics.received;
+            if(inFlight > 0) --inFlight;
+            lastProgress = now;
+        }
+
+        void OnReadable(BasicSocket&) override
+        {
+            std::byte buffer[64 * 1024];
+            while(!closed)
+            {
+                auto read = socket.Read(buffer);
+                if(read.HasError())
+                {
+                    if(read.GetError() != EAGAIN && read.GetError() != EWOULDBLOCK) Fail();
+                    return;
+                }
+                if(read.GetResult() == 0)
+                {
+                    Fail();
+                    return;
+                }
+                auto now = Clock::now();
+                auto bytes = std::span<const std::byte>(buffer).first(read.GetResult());
+                if(IsDatagram())
+                {
+                    if(bytes.size() < TimestampSize) continue;
+                    std::memcpy(header, bytes.data(), TimestampSize);
+                    Complete(now);
+                    continue;
+                }
+
+                // Echoes come back as a stream, slice it into messages again.
+                while(!bytes.empty())
+                {
+                    auto take = std::min(bytes.size(), options.messageSize - received);
+                    if(received < TimestampSize)
+                    {
+                        auto headerBytes = std::min(take, TimestampSize - received);
+                        std::memcpy(header + received, bytes.data(), headerBytes);
+                    }
+                    received += take;
+                    bytes = bytes.subspan(take);
+                    if(received == options.messageSize)
+                    {
+                        received = 0;
+                        Complete(now);
+                    }
+                }
+            }
+        }
+
+        void OnWritable(BasicSocket&) override
+        {
+            queue.OnWritable();
+        }
+
+        void OnError(BasicSocket&, Detail::SocketPlatformErrorType::Type) override
+        {
+            Fail();
+        }
+
+        void Fail()
+        {
+            ++statistics.errors;
+            Close();
+        }
+
+        const LoadOptions& options;
+        LoadStatistics& statistics;
+        Reactor& reactor;
+        BasicSocket socket;
+        OutboundQueue queue;
+        std::vector<std::byte> message;
+        std::byte header[TimestampSize]{};
+        std::size_t received{0};
+        std::size_t inFlight{0};
+        std::chrono::nanoseconds interval;
+        Clock::time_point nextSend;
+        Clock::time_point lastProgress;
+        bool closed{false};
+    };
+
+    bool Connect(const Tools::Endpoint& endpoint, BasicSocket& socket)
+    {
+        Detail::SocketResourceDependencies deps{.domain = endpoint.domain, .type = endpoint.type, .protocol = 0,
+            .options = {.closeOnExec = true, .noDelay = endpoint.kind == "tcp"}};
+        if(!socket.OpenSocket(deps)) return false;
+        // Connect blocking so every connection is established before measuring.
+        if(!socket.Connect(endpoint.GetAddress(), endpoint.length).HasResult()) return false;
+        return socket.SetNonBlocking(true);
+    }
+
+    /**
+     * Run by the last thread reaching the barrier: the schedule starts once every
+     * connection is established, so connect time isn't charged as latency.
+     */
+    struct ScheduleStart
+    {
+        Clock::time_point* start;
+
+        void operator()() noexcept
+        {
+            *start = Clock::now();
+        }
+    };
+
+    using StartBarrier = std::barrier<ScheduleStart>;
+
+    void RunThread(const LoadOptions& options, std::size_t connectionCount, std::size_t totalConnections,
+        LoadStatistics& statistics, StartBarrier& barrier, const Clock::time_point& scheduleStart)
+    {
+        Reactor reactor;
+        std::chrono::nanoseconds interval{0};
+        if(options.rate > 0)
+        {
+            interval = std::chrono::nanoseconds(static_cast<std::int64_t>(1e9 * totalConnections / options.rate));
+            interval = std::max(interval, std::chrono::nanoseconds(1));
+        }
+
+        std::vector<BasicSocket> sockets;
+        for(std::size_t i = 0; i < connectionCount; ++i)
+        {
+            BasicSocket socket;
+            if(!Connect(options.endpoint, socket))
+            {
+                ++statistics.errors;
+                continue;
+            }
+            sockets.push_back(std::move(socket));
+        }
+
+        barrier.arrive_and_wait();
+        auto start = scheduleStart;
+        std::vector<std::unique_ptr<LoadConnection>> connections;
+        for(std::size_t i = 0; i < sockets.size(); ++i)
+        {
+            // Spread the schedules so open-loop connections don't send in bursts.
+            auto offset = interval * static_cast<std::int64_t>(i) / static_cast<std::int64_t>(connectionCount);
+            auto connection = std::make_unique<LoadConnection>(options, statistics, reactor, std::move(sockets[i]),
+                start + offset, interval);
+            if(!connection->Start())
+            {
+                ++statistics.errors;
+                continue;
+            }
+            connections.push_back(std::move(connection));
+        }
+
+        auto end = start + options.duration;
+        // Echoes still in flight at the end get a short grace period to return.
+        auto drainEnd = end + DatagramLossTimeout;
+        while(true)
+        {
+            auto now = Clock::now();
+            bool sending = now < end && !stopRequested.load(std::memory_order_relaxed);
+            auto next = Clock::time_point::max();
+            for(auto& connection : connections)
+            {
+                next = std::min(next, connection->Pump(now, sending));
+            }
+            if(!sending
+                && (now >= drainEnd || std::all_of(connections.begin(), connections.end(),
+                    [](const auto& connection) { return connection->IsIdle(); })))
+            {
+                break;
+            }
+
+            int timeout = 100;
+            if(next != Clock::time_point::max())
+            {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count();
+                timeout = static_cast<int>(std::clamp<std::int64_t>(wait, 0, 100));
+            }
+            reactor.RunOnce(timeout);
+        }
+        for(auto& connection : connections)
+        {
+            connection->Close();
+        }
+    }
+
+    int Usage(const std::string& error)
+    {
+        if(!error.empty()) std::fprintf(stderr, "eagle-loadgen: %s\n", error.c_str());
+        std::fprintf(stderr,
+            "usage: eagle-loadgen (--tcp [HOST:]PORT | --udp [HOST:]PORT | --unix PATH | --abstract NAME)\n"
+            "                     [--connections N] [--size BYTES] [--pipeline N] [--rate MSG/S]\n"
+            "                     [--duration SECONDS] [--threads N]\n"
+            "  --connections  connections across all threads (default 1)\n"
+            "  --size         message size, at least 8 bytes for the timestamp (default 64)\n"
+            "  --pipeline     messages in flight per connection (default 1)\n"
+            "  --rate         total messages per second on a fixed schedule, 0 for closed loop (default 0)\n"
+            "  --duration     seconds to send for (default 10)\n"
+            "  --threads      threads, each with its own reactor (default 1)\n");
+        return 2;
+    }
+
+    void Report(const LoadOptions& options, const LoadStatistics& total, std::chrono::nanoseconds elapsed)
+    {
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+        auto rate = seconds > 0 ? total.received / seconds : 0.0;
+        auto microseconds = [](std::uint64_t nanoseconds) { return nanoseconds / 1000.0; };
+        std::printf("connections %zu, size %zu, pipeline %zu, %s\n", options.connections, options.messageSize,
+            options.pipeline, options.rate > 0 ? "open loop" : "closed loop");
+        std::printf("sent %llu, received %llu, lost %llu, errors %llu in %.2f s\n",
+            static_cast<unsigned long long>(total.sent), static_cast<unsigned long long>(total.received),
+            static_cast<unsigned long long>(total.lost), static_cast<unsigned long long>(total.errors), seconds);
+        std::printf("throughput %.0f msg/s, %.2f MB/s\n", rate, rate * options.messageSize / 1e6);
+        std::printf("latency us p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f max %.1f mean %.1f\n",
+            microseconds(total.latency.GetValueAtPercentile(50)),
+            microseconds(total.latency.GetValueAtPercentile(90)),
+            microseconds(total.latency.GetValueAtPercentile(99)),
+            microseconds(total.latency.GetValueAtPercentile(99.9)),
+            microseconds(total.latency.GetMax()), total.latency.GetMean() / 1000.0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Tools::Arguments arguments(argc, argv, {"help"},
+        {"tcp", "udp", "unix", "abstract", "connections", "size", "pipeline", "threads", "rate", "duration"});
+    LoadOptions options;
+    options.connections = arguments.GetNumber<std::size_t>("connections", 1);
+    options.messageSize = arguments.GetNumber<std::size_t>("size", 64);
+    options.pipeline = arguments.GetNumber<std::size_t>("pipeline", 1);
+    options.threads = arguments.GetNumber<std::size_t>("threads", 1);
+    options.rate = arguments.GetNumber<double>("rate", 0);
+    options.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(arguments.GetNumber<double>("duration", 10)));
+    if(!arguments.error.empty() || arguments.Has("help")) return Usage(arguments.error);
+
+    std::size_t endpointCount = 0;
+    for(const auto& [name, value] : arguments.GetValues())
+    {
+        if(!Tools::IsEndpointKind(name)) continue;
+        auto endpoint = Tools::ParseEndpoint(name, value, "127.0.0.1");
+        if(!endpoint) return Usage("invalid --" + name + " " + value);
+        options.endpoint = *endpoint;
+        ++endpointCount;
+    }
+    if(endpointCount != 1) return Usage("exactly one endpoint is required");
+    if(options.messageSize < TimestampSize) return Usage("--size must be at least 8");
+    if(options.endpoint.type == SOCK_DGRAM && options.messageSize > 65507) return Usage("--size too large for UDP");
+    if(options.connections == 0 || options.pipeline == 0 || options.threads == 0 || options.rate < 0)
+    {
+        return Usage("--connections, --pipeline and --threads must be positive");
+    }
+    options.threads = std::min(options.threads, options.connections);
+
+    std::signal(SIGINT, RequestStop);
+    std::signal(SIGTERM, RequestStop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::vector<LoadStatistics> statistics(options.threads);
+    std::vector<std::thread> threads;
+    Clock::time_point start;
+    StartBarrier barrier(static_cast<std::ptrdiff_t>(options.threads), ScheduleStart{&start});
+    for(std::size_t i = 0; i < options.threads; ++i)
+    {
+        auto connectionCount = options.connections / options.threads + (i < options.connections % options.threads);
+        threads.emplace_back(RunThread, std::cref(options), connectionCount, options.connections,
+            std::ref(statistics[i]), std::ref(barrier), std::cref(start));
+    }
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+    auto elapsed = std::min<std::chrono::nanoseconds>(Clock::now() - start, options.duration);
+
+    LoadStatistics total;
+    for(const auto& threadStatistics : statistics)
+    {
+        total.Merge(threadStatistics);
+    }
+    Report(options, total, elapsed);
+    return total.errors == 0 ? 0 : 1;
+}
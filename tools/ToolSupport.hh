@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2023 JumpToSkyFree
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EAGLE_NETWORK_TOOLS_TOOL_SUPPORT_HH
+#define EAGLE_NETWORK_TOOLS_TOOL_SUPPORT_HH
+
+#include <EagleNetwork/UnixAddress.hh>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <map>
+#include <netinet/in.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+
+/**
+ * Command line and address handling shared by eagle-echo and eagle-loadgen.
+ */
+namespace Eagle::Tools
+{
+    /**
+     * Where to listen or connect: --tcp and --udp take [HOST:]PORT (IPv6 hosts
+     * in brackets), --unix a path and --abstract an abstract socket name.
+     */
+    struct Endpoint
+    {
+        std::string kind;
+        int domain{AF_UNSPEC};
+        int type{0};
+        sockaddr_storage address{};
+        socklen_t length{0};
+
+        const sockaddr* GetAddress() const
+        {
+            return reinterpret_cast<const sockaddr*>(&address);
+        }
+
+    };
+
+    inline bool IsEndpointKind(std::string_view kind)
+    {
+        return kind == "tcp" || kind == "udp" || kind == "unix" || kind == "abstract";
+    }
+
+    template <typename T>
+    std::optional<T> ParseNumber(std::string_view text)
+    {
+        T value{};
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if(error != std::errc() || end != text.data() + text.size()) return std::nullopt;
+        return value;
+    }
+
+    /**
+     * @param defaultHost Host used when value is only a port.
+     */
+    inline std::optional<Endpoint> ParseEndpoint(std::string_view kind, std::string_view value,
+        std::string_view defaultHost)
+    {
+        Endpoint endpoint;
+        endpoint.kind = kind;
+
+        if(kind == "unix" || kind == "abstract")
+        {
+            auto address = kind == "unix" ? Core::UnixAddress::FromPath(value) :
+                Core::UnixAddress::FromAbstractName(value);
+            if(!address.HasResult()) return std::nullopt;
+            endpoint.domain = AF_UNIX;
+            endpoint.type = SOCK_STREAM;
+            endpoint.length = address.GetResult().GetLength();
+            std::memcpy(&endpoint.address, address.GetResult().GetAddress(), endpoint.length);
+            return endpoint;
+        }
+
+        if(kind != "tcp" && kind != "udp") return std::nullopt;
+        endpoint.type = kind == "tcp" ? SOCK_STREAM : SOCK_DGRAM;
+
+        std::string host(defaultHost);
+        auto portText = value;
+        if(auto colon = value.rfind(':'); colon != std::string_view::npos)
+        {
+            host = value.substr(0, colon);
+            portText = value.substr(colon + 1);
+            if(host.size() >= 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+        }
+
+        auto port = ParseNumber<std::uint16_t>(portText);
+        if(!port) return std::nullopt;
+
+        auto* ipv4 = reinterpret_cast<sockaddr_in*>(&endpoint.address);
+        auto* ipv6 = reinterpret_cast<sockaddr_in6*>(&endpoint.address);
+        if(::inet_pton(AF_INET, host.c_str(), &ipv4->sin_addr) == 1)
+        {
+            ipv4->sin_family = AF_INET;
+            ipv4->sin_port = htons(*port);
+            endpoint.length = sizeof(sockaddr_in);
+        } else if(::inet_pton(AF_INET6, host.c_str(), &ipv6->sin6_addr) == 1) {
+            ipv6->sin6_family = AF_INET6;
+            ipv6->sin6_port = htons(*port);
+            endpoint.length = sizeof(sockaddr_in6);
+        } else {
+            return std::nullopt;
+        }
+        endpoint.domain = endpoint.address.ss_family;
+        return endpoint;
+    }
+
+    /**
+     * "--name value" pairs and "--flag" switches; repeated names keep every value.
+     * A name that is neither a switch nor an option is reported in error.
+     */
+    class Arguments
+    {
+    public:
+        Arguments(int argc, char** argv, std::initializer_list<std::string_view> switches,
+            std::initializer_list<std::string_view> options)
+        {
+            for(int i = 1; i < argc; ++i)
+            {
+                std::string_view argument = argv[i];
+                if(!argument.starts_with("--"))
+                {
+                    error = "unexpected argument " + std::string(argument);
+                    return;
+                }
+                auto name = std::string(argument.substr(2));
+                if(std::find(switches.begin(), switches.end(), name) != switches.end())
+                {
+                    values.emplace(name, "");
+                } else if(std::find(options.begin(), options.end(), name) == options.end()) {
+                    error = "unknown option " + std::string(argument);
+                    return;
+                } else if(i + 1 < argc) {
+                    values.emplace(name, argv[++i]);
+                } else {
+                    error = "missing value for " + std::string(argument);
+                    return;
+                }
+            }
+        }
+
+        bool Has(const std::string& name) const
+        {
+            return values.contains(name);
+        }
+
+        std::string_view Get(const std::string& name, std::string_view fallback = {}) const
+        {
+            auto found = values.find(name);
+            return found == values.end() ? fallback : std::string_view(found->second);
+        }
+
+        template <typename T>
+        T GetNumber(const std::string& name, T fallback)
+        {
+            auto found = values.find(name);
+            if(found == values.end()) return fallback;
+            auto value = ParseNumber<T>(found->second);
+            if(!value) error = "invalid number for --" + name;
+            return value.value_or(fallback);
+        }
+
+        const std::multimap<std::string, std::string>& GetValues() const
+        {
+            return values;
+        }
+
+        std::string error;
+
+    private:
+        std::multimap<std::string, std::string> values;
+    };
+}
+
+#endif // EAGLE_NETWORK_TOOLS_TOOL_SUPPORT_HH